@@ -0,0 +1,851 @@
+// StreamVio/core/bench/core_bench.cpp
+//
+// Banco de pruebas reproducible del núcleo. Genera entradas sintéticas con
+// las fuentes de prueba de libavfilter (testsrc2 + sine) en varias
+// resoluciones y codecs y mide las rutas que usa el servidor:
+//
+//   - análisis (latencia de un archivo y caudal por lotes)
+//   - remux sin recodificar (MB/s)
+//   - miniatura y trickplay (segundos por hora de contenido)
+//   - transcodificación por calidad de la escalera HLS (fps y factor de tiempo real)
+//   - HLS bajo demanda: tiempo hasta el primer segmento y tras un salto
+//
+// De cada caso se guardan además el pico de memoria residente y las
+// reservas de memoria de C++ (operator new) por frame. El resultado es un
+// JSON de una línea; con --compare se contrasta con uno anterior y el
+// programa termina con código 1 si alguna métrica empeora más del umbral.
+//
+//   streamvio_bench --inputs=720p:h264,1080p:h264,1080p:hevc --output=base.json
+//   streamvio_bench --compare=base.json --threshold=10
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/utsname.h>
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavutil/avutil.h>
+#include <libavutil/channel_layout.h>
+}
+
+#include "analyzer/frame_kernels.h"
+#include "transcoder/hls_ladder.h"
+#include "transcoder/jit_segmenter.h"
+#include "transcoder/transcoder.h"
+#include "transcoder/video_encoder.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/json_reader.h"
+#include "utils/json_writer.h"
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+
+void* countedAllocation(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+} // namespace
+
+// Se sustituyen los operadores globales del ejecutable: también los usa
+// libstreamvio_core. Las reservas de FFmpeg (av_malloc) no pasan por aquí.
+void* operator new(std::size_t size) {
+    if (void* pointer = countedAllocation(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocation(size);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using StreamVio::JsonWriter;
+
+constexpr int kFrameRate = 30;
+constexpr int kProbeIterations = 15;
+constexpr int kProbeBatchFiles = 64;
+
+struct InputSpec {
+    std::string label;          // "1080p_h264"
+    int width = 0;
+    int height = 0;
+    std::string codec;          // Codificador de FFmpeg
+    std::string extension;
+    std::string path;
+    int64_t bytes = 0;
+};
+
+struct BenchConfig {
+    std::vector<InputSpec> inputs;
+    int durationSeconds = 20;
+    int threads = 0;
+    std::vector<std::string> only;
+    std::string workDir;
+    bool keep = false;
+    std::string outputPath;
+    std::string comparePath;
+    double thresholdPercent = 10.0;
+};
+
+struct Metric {
+    std::string name;
+    double value = 0;
+    std::string unit;
+    bool higherIsBetter = true;
+};
+
+struct CaseCost {
+    double seconds = 0;
+    int64_t peakRssKb = -1;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+std::string getOptionValue(const std::vector<std::string>& args, const std::string& option, const std::string& defaultValue = "") {
+    for (const auto& arg : args) {
+        if (arg.find(option + "=") == 0) {
+            return arg.substr(option.length() + 1);
+        }
+    }
+    return defaultValue;
+}
+
+bool hasOption(const std::vector<std::string>& args, const std::string& option) {
+    return std::find(args.begin(), args.end(), option) != args.end();
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// "1080p:h264" -> 1920x1080 H.264 en MP4. Anchos 16:9 redondeados a par.
+InputSpec parseInputSpec(const std::string& text) {
+    size_t colon = text.find(':');
+    std::string resolution = text.substr(0, colon);
+    std::string codec = colon == std::string::npos ? "h264" : text.substr(colon + 1);
+    if (resolution.empty() || resolution.back() != 'p') {
+        throw std::runtime_error("Resolución no válida: " + text);
+    }
+
+    InputSpec spec;
+    spec.height = std::stoi(resolution.substr(0, resolution.size() - 1));
+    spec.width = (spec.height * 16 / 9 + 1) & ~1;
+    spec.label = resolution + "_" + codec;
+    spec.extension = "mp4";
+    if (codec == "h264") {
+        spec.codec = "libx264";
+    } else if (codec == "hevc" || codec == "h265") {
+        spec.codec = "libx265";
+    } else if (codec == "vp9") {
+        spec.codec = "libvpx-vp9";
+        spec.extension = "mkv";
+    } else {
+        spec.codec = codec;
+    }
+    return spec;
+}
+
+bool selected(const BenchConfig& config, const std::string& group) {
+    return config.only.empty() ||
+           std::find(config.only.begin(), config.only.end(), group) != config.only.end();
+}
+
+// Pico de memoria residente desde el último resetPeakRss()
+int64_t peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::atoll(line.c_str() + 6);
+        }
+    }
+    return -1;
+}
+
+void resetPeakRss() {
+    // Linux >= 4.0: "5" reinicia VmHWM al RSS actual
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+CaseCost measure(const std::function<void()>& body) {
+    resetPeakRss();
+    uint64_t allocationsBefore = allocationCount.load();
+    uint64_t bytesBefore = allocatedBytes.load();
+    Clock::time_point start = Clock::now();
+    body();
+    CaseCost cost;
+    cost.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    cost.peakRssKb = peakRssKb();
+    cost.allocations = allocationCount.load() - allocationsBefore;
+    cost.bytes = allocatedBytes.load() - bytesBefore;
+    return cost;
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+// Codifica testsrc2 + sine en `spec.path`: GOP de 2 s como un archivo
+// típico de la biblioteca
+void generateInput(InputSpec& spec, int durationSeconds) {
+    StreamVio::OutputFormatPtr output = StreamVio::createOutput(spec.path);
+    bool globalHeader = output->oformat->flags & AVFMT_GLOBALHEADER;
+
+    StreamVio::FilterGraphPtr graph(avfilter_graph_alloc());
+    AVFilterContext* videoSink = nullptr;
+    AVFilterContext* audioSink = nullptr;
+    if (!graph ||
+        avfilter_graph_create_filter(&videoSink, avfilter_get_by_name("buffersink"), "video", nullptr, nullptr, graph.get()) < 0 ||
+        avfilter_graph_create_filter(&audioSink, avfilter_get_by_name("abuffersink"), "audio", nullptr, nullptr, graph.get()) < 0) {
+        throw std::runtime_error("No se pudo crear el grafo de fuentes de prueba");
+    }
+
+    std::string description =
+        "testsrc2=size=" + std::to_string(spec.width) + "x" + std::to_string(spec.height) +
+        ":rate=" + std::to_string(kFrameRate) + ":duration=" + std::to_string(durationSeconds) +
+        ",format=yuv420p[v];"
+        "sine=frequency=440:beep_factor=4:sample_rate=48000:duration=" + std::to_string(durationSeconds) +
+        ",aformat=sample_fmts=fltp:channel_layouts=stereo[a]";
+
+    AVFilterInOut* sinks = avfilter_inout_alloc();
+    AVFilterInOut* audioPad = avfilter_inout_alloc();
+    if (!sinks || !audioPad) {
+        avfilter_inout_free(&sinks);
+        avfilter_inout_free(&audioPad);
+        throw std::runtime_error("No se pudo reservar memoria para el grafo");
+    }
+    sinks->name = av_strdup("v");
+    sinks->filter_ctx = videoSink;
+    sinks->next = audioPad;
+    audioPad->name = av_strdup("a");
+    audioPad->filter_ctx = audioSink;
+    int ret = avfilter_graph_parse_ptr(graph.get(), description.c_str(), &sinks, nullptr, nullptr);
+    avfilter_inout_free(&sinks);
+    if (ret < 0 || (ret = avfilter_graph_config(graph.get(), nullptr)) < 0) {
+        throw std::runtime_error("Grafo de fuentes de prueba no válido: " + StreamVio::avErrorToString(ret));
+    }
+
+    StreamVio::VideoEncoderConfig videoConfig;
+    videoConfig.codecName = spec.codec;
+    videoConfig.width = spec.width;
+    videoConfig.height = spec.height;
+    videoConfig.timeBase = AVRational{1, kFrameRate};
+    videoConfig.frameRate = AVRational{kFrameRate, 1};
+    videoConfig.gopSize = kFrameRate * 2;
+    videoConfig.preset = "veryfast";
+    videoConfig.globalHeader = globalHeader;
+    StreamVio::CodecContextPtr videoEncoder = StreamVio::openVideoEncoder(videoConfig);
+
+    const AVCodec* aac = avcodec_find_encoder(AV_CODEC_ID_AAC);
+    StreamVio::CodecContextPtr audioEncoder(aac ? avcodec_alloc_context3(aac) : nullptr);
+    if (!audioEncoder) {
+        throw std::runtime_error("Codificador AAC no disponible");
+    }
+    audioEncoder->sample_fmt = AV_SAMPLE_FMT_FLTP;
+    audioEncoder->sample_rate = 48000;
+    audioEncoder->time_base = AVRational{1, 48000};
+    audioEncoder->bit_rate = 128000;
+    av_channel_layout_default(&audioEncoder->ch_layout, 2);
+    if (globalHeader) {
+        audioEncoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if ((ret = avcodec_open2(audioEncoder.get(), aac, nullptr)) < 0) {
+        throw std::runtime_error("No se pudo abrir AAC: " + StreamVio::avErrorToString(ret));
+    }
+    av_buffersink_set_frame_size(audioSink, audioEncoder->frame_size);
+
+    AVCodecContext* encoders[2] = {videoEncoder.get(), audioEncoder.get()};
+    AVFilterContext* sinksByStream[2] = {videoSink, audioSink};
+    for (AVCodecContext* encoder : encoders) {
+        AVStream* stream = avformat_new_stream(output.get(), nullptr);
+        if (!stream || avcodec_parameters_from_context(stream->codecpar, encoder) < 0) {
+            throw std::runtime_error("No se pudo crear el stream de salida");
+        }
+        stream->time_base = encoder->time_base;
+    }
+    if (!(output->oformat->flags & AVFMT_NOFILE) &&
+        (ret = avio_open(&output->pb, spec.path.c_str(), AVIO_FLAG_WRITE)) < 0) {
+        throw std::runtime_error("No se pudo crear " + spec.path + ": " + StreamVio::avErrorToString(ret));
+    }
+    if ((ret = avformat_write_header(output.get(), nullptr)) < 0) {
+        throw std::runtime_error("No se pudo escribir la cabecera: " + StreamVio::avErrorToString(ret));
+    }
+
+    StreamVio::FramePtr frame(av_frame_alloc());
+    StreamVio::PacketPtr packet(av_packet_alloc());
+    auto drain = [&](int index, const AVFrame* input) {
+        AVCodecContext* encoder = encoders[index];
+        int sent = avcodec_send_frame(encoder, input);
+        if (sent < 0 && sent != AVERROR_EOF) {
+            throw std::runtime_error("Error al codificar la entrada sintética: " + StreamVio::avErrorToString(sent));
+        }
+        int received;
+        while ((received = avcodec_receive_packet(encoder, packet.get())) >= 0) {
+            packet->stream_index = index;
+            av_packet_rescale_ts(packet.get(), encoder->time_base, output->streams[index]->time_base);
+            // Una entrada truncada daría cifras engañosas: mejor fallar
+            int written = av_interleaved_write_frame(output.get(), packet.get());
+            if (written < 0) {
+                throw std::runtime_error("Error al escribir " + spec.path + ": " + StreamVio::avErrorToString(written));
+            }
+        }
+        if (received != AVERROR(EAGAIN) && received != AVERROR_EOF) {
+            throw std::runtime_error("Error al codificar la entrada sintética: " + StreamVio::avErrorToString(received));
+        }
+    };
+
+    // Se tira del stream más retrasado para que el muxer no acumule paquetes
+    bool finished[2] = {false, false};
+    double position[2] = {0, 0};
+    while (!finished[0] || !finished[1]) {
+        int index = finished[0] || (!finished[1] && position[1] < position[0]) ? 1 : 0;
+        ret = av_buffersink_get_frame(sinksByStream[index], frame.get());
+        if (ret == AVERROR_EOF) {
+            finished[index] = true;
+            drain(index, nullptr);
+            continue;
+        }
+        if (ret < 0) {
+            throw std::runtime_error("Error en las fuentes de prueba: " + StreamVio::avErrorToString(ret));
+        }
+        AVRational sinkTimeBase = av_buffersink_get_time_base(sinksByStream[index]);
+        frame->pts = av_rescale_q(frame->pts, sinkTimeBase, encoders[index]->time_base);
+        frame->pict_type = AV_PICTURE_TYPE_NONE;
+        position[index] = static_cast<double>(frame->pts) * av_q2d(encoders[index]->time_base);
+        drain(index, frame.get());
+        av_frame_unref(frame.get());
+    }
+
+    if ((ret = av_write_trailer(output.get())) < 0) {
+        throw std::runtime_error("No se pudo cerrar " + spec.path + ": " + StreamVio::avErrorToString(ret));
+    }
+}
+
+class Bench {
+public:
+    explicit Bench(BenchConfig config) : config(std::move(config)) {}
+
+    void run() {
+        transcoder.initialize();
+        for (auto& input : config.inputs) {
+            prepareInput(input);
+        }
+        if (selected(config, "probe")) {
+            guarded("probe", [this] { benchProbe(); });
+        }
+        for (const auto& input : config.inputs) {
+            if (input.bytes <= 0) {
+                continue;
+            }
+            if (selected(config, "remux")) {
+                guarded("remux." + input.label, [&] { benchRemux(input); });
+            }
+            if (selected(config, "trickplay")) {
+                guarded("trickplay." + input.label, [&] { benchTrickplay(input); });
+            }
+            if (selected(config, "transcode")) {
+                guarded("transcode." + input.label, [&] { benchTranscode(input); });
+            }
+            if (selected(config, "jit")) {
+                guarded("jit." + input.label, [&] { benchJit(input); });
+            }
+        }
+    }
+
+    const std::vector<Metric>& results() const { return metrics; }
+    const std::vector<std::string>& failures() const { return errors; }
+
+private:
+    void add(const std::string& name, double value, const std::string& unit, bool higherIsBetter) {
+        metrics.push_back(Metric{name, value, unit, higherIsBetter});
+        std::cerr << "  " << name << " = " << value << " " << unit << std::endl;
+    }
+
+    void addCost(const std::string& prefix, const CaseCost& cost, int64_t frames) {
+        if (cost.peakRssKb >= 0) {
+            add(prefix + ".peak_rss", static_cast<double>(cost.peakRssKb) / 1024.0, "MiB", false);
+        }
+        if (frames > 0) {
+            add(prefix + ".allocs_per_frame", static_cast<double>(cost.allocations) / static_cast<double>(frames),
+                "allocs", false);
+        }
+    }
+
+    void guarded(const std::string& name, const std::function<void()>& body) {
+        std::cerr << "[" << name << "]" << std::endl;
+        try {
+            body();
+        } catch (const std::exception& e) {
+            errors.push_back(name + ": " + e.what());
+            std::cerr << "  Error: " << e.what() << std::endl;
+        }
+    }
+
+    std::string scratchPath(const std::string& name) const {
+        return (std::filesystem::path(config.workDir) / "out" / name).string();
+    }
+
+    int64_t contentFrames() const {
+        return static_cast<int64_t>(config.durationSeconds) * kFrameRate;
+    }
+
+    double contentHours() const {
+        return config.durationSeconds / 3600.0;
+    }
+
+    void prepareInput(InputSpec& input) {
+        input.path = (std::filesystem::path(config.workDir) /
+                      (input.label + "_" + std::to_string(config.durationSeconds) + "s." + input.extension)).string();
+        std::error_code ec;
+        // Las entradas se reutilizan entre ejecuciones con el mismo --work-dir
+        if (!std::filesystem::exists(input.path, ec)) {
+            guarded("input." + input.label, [&] {
+                InputSpec temporary = input;
+                temporary.path = input.path + ".tmp." + input.extension;
+                try {
+                    generateInput(temporary, config.durationSeconds);
+                } catch (...) {
+                    std::filesystem::remove(temporary.path, ec);
+                    throw;
+                }
+                std::filesystem::rename(temporary.path, input.path);
+            });
+        }
+        input.bytes = static_cast<int64_t>(std::filesystem::file_size(input.path, ec));
+        if (ec) {
+            input.bytes = 0;
+        }
+    }
+
+    void benchProbe() {
+        StreamVio::ProbeOptions probeOptions;
+        std::string batch;
+        std::vector<std::string> paths;
+        for (const auto& input : config.inputs) {
+            if (input.bytes > 0) {
+                paths.push_back(input.path);
+            }
+        }
+        if (paths.empty()) {
+            return;
+        }
+
+        for (const auto& input : config.inputs) {
+            if (input.bytes <= 0) {
+                continue;
+            }
+            std::vector<double> latencies;
+            for (int i = 0; i < kProbeIterations; ++i) {
+                CaseCost cost = measure([&] { transcoder.getMediaInfo(input.path, probeOptions); });
+                latencies.push_back(cost.seconds * 1000.0);
+            }
+            add("probe." + input.label + ".p50", percentile(latencies, 0.5), "ms", false);
+            add("probe." + input.label + ".p95", percentile(latencies, 0.95), "ms", false);
+        }
+
+        for (int i = 0; i < kProbeBatchFiles; ++i) {
+            batch += paths[static_cast<size_t>(i) % paths.size()] + "\n";
+        }
+        std::istringstream requests(batch);
+        std::ostringstream results;
+        size_t failed = 0;
+        CaseCost cost = measure([&] {
+            failed = transcoder.probeMany(requests, results, static_cast<size_t>(std::max(config.threads, 0)),
+                                          probeOptions);
+        });
+        if (failed > 0) {
+            throw std::runtime_error(std::to_string(failed) + " análisis fallidos en el lote");
+        }
+        add("probe.batch.files_per_s", kProbeBatchFiles / cost.seconds, "files/s", true);
+        addCost("probe.batch", cost, 0);
+    }
+
+    void benchRemux(const InputSpec& input) {
+        StreamVio::TranscodeOptions options;
+        options.outputFormat = "mkv";
+        options.threads = config.threads;
+        std::string output = scratchPath(input.label + "_remux.mkv");
+        bool ok = false;
+        CaseCost cost = measure([&] { ok = transcoder.startTranscode(input.path, output, options, [](int) {}); });
+        if (!ok) {
+            throw std::runtime_error("El remux falló");
+        }
+        add("remux." + input.label + ".mb_per_s", static_cast<double>(input.bytes) / 1e6 / cost.seconds, "MB/s", true);
+        addCost("remux." + input.label, cost, contentFrames());
+    }
+
+    void benchTrickplay(const InputSpec& input) {
+        std::string prefix = "trickplay." + input.label;
+        CaseCost thumbnail = measure([&] {
+            if (!transcoder.generateThumbnail(input.path, scratchPath(input.label + "_thumb.jpg"),
+                                              config.durationSeconds * 500)) {
+                throw std::runtime_error("La miniatura falló");
+            }
+        });
+        add("thumbnail." + input.label + ".ms", thumbnail.seconds * 1000.0, "ms", false);
+
+        StreamVio::TrickplayOptions options;
+        options.intervalSeconds = 2;
+        options.decoderThreads = config.threads;
+        std::string directory = scratchPath(input.label + "_trickplay");
+        CaseCost cost = measure([&] {
+            if (!transcoder.generateTrickplay(input.path, directory, options)) {
+                throw std::runtime_error("El trickplay falló");
+            }
+        });
+        add(prefix + ".s_per_hour", cost.seconds / contentHours(), "s/h", false);
+        addCost(prefix, cost, contentFrames());
+    }
+
+    void benchTranscode(const InputSpec& input) {
+        std::vector<StreamVio::HlsRendition> ladder =
+            StreamVio::buildHlsLadder(input.width, input.height, 1080, 8000);
+        for (const auto& rung : ladder) {
+            StreamVio::TranscodeOptions options;
+            options.outputFormat = "mp4";
+            options.videoCodec = "libx264";
+            options.width = rung.width;
+            options.height = rung.height;
+            options.videoBitrate = rung.bitrateKbps;
+            options.threads = config.threads;
+            options.enableHardwareAcceleration = false;
+
+            std::string rungName = std::to_string(rung.height) + "p";
+            std::string output = scratchPath(input.label + "_" + rungName + ".mp4");
+            bool ok = false;
+            CaseCost cost = measure([&] { ok = transcoder.startTranscode(input.path, output, options, [](int) {}); });
+            if (!ok) {
+                throw std::runtime_error("La transcodificación a " + rungName + " falló");
+            }
+            std::string prefix = "transcode." + input.label + "." + rungName;
+            add(prefix + ".fps", static_cast<double>(contentFrames()) / cost.seconds, "fps", true);
+            add(prefix + ".realtime", config.durationSeconds / cost.seconds, "x", true);
+            addCost(prefix, cost, contentFrames());
+        }
+
+        // Toda la escalera con una sola decodificación, como createHlsStream
+        StreamVio::HlsLadderOptions hlsOptions;
+        hlsOptions.threads = config.threads;
+        std::string directory = scratchPath(input.label + "_hls");
+        bool ok = false;
+        CaseCost cost = measure([&] {
+            ok = transcoder.createHlsStream(input.path, directory, hlsOptions, [](int) {});
+        });
+        if (!ok) {
+            throw std::runtime_error("La escalera HLS falló");
+        }
+        add("hls_ladder." + input.label + ".realtime", config.durationSeconds / cost.seconds, "x", true);
+        addCost("hls_ladder." + input.label, cost, contentFrames());
+    }
+
+    void benchJit(const InputSpec& input) {
+        StreamVio::JitHlsOptions options;
+        options.segmentDuration = 2;
+        options.prefetchSegments = 1;
+        options.threads = config.threads;
+        std::string directory = scratchPath(input.label + "_jit");
+        std::filesystem::remove_all(directory);
+
+        std::unique_ptr<StreamVio::JitHlsSegmenter> segmenter;
+        CaseCost first = measure([&] {
+            segmenter.reset(new StreamVio::JitHlsSegmenter(input.path, directory, options));
+            segmenter->writePlaylist();
+            segmenter->requestSegment(0);
+        });
+        add("jit." + input.label + ".first_segment_ms", first.seconds * 1000.0, "ms", false);
+
+        // Un salto fuera de la ventana de precarga: sesión nueva y búsqueda
+        int target = segmenter->segmentCount() * 2 / 3;
+        if (target > options.prefetchSegments + 1) {
+            CaseCost seek = measure([&] { segmenter->requestSegment(target); });
+            add("jit." + input.label + ".seek_segment_ms", seek.seconds * 1000.0, "ms", false);
+        }
+        segmenter.reset();
+    }
+
+    BenchConfig config;
+    StreamVio::Transcoder transcoder;
+    std::vector<Metric> metrics;
+    std::vector<std::string> errors;
+};
+
+std::string metricsToJson(const std::vector<Metric>& metrics) {
+    std::string json = "[";
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        JsonWriter metric;
+        metric.field("name", metrics[i].name)
+            .field("value", metrics[i].value)
+            .field("unit", metrics[i].unit)
+            .field("better", metrics[i].higherIsBetter ? "higher" : "lower");
+        json += (i > 0 ? "," : "") + metric.str();
+    }
+    return json + "]";
+}
+
+std::string stringsToJson(const std::vector<std::string>& values) {
+    std::string json = "[";
+    for (size_t i = 0; i < values.size(); ++i) {
+        json += (i > 0 ? ",\"" : "\"") + StreamVio::jsonEscape(values[i]) + "\"";
+    }
+    return json + "]";
+}
+
+// Lee las métricas de un resultado anterior. Cada métrica es un objeto
+// plano dentro del array "metrics", así que basta con parseFlatJsonObject.
+std::vector<Metric> loadBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("No se pudo leer " + path);
+    }
+    std::string document((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t position = document.find("\"metrics\":[");
+    if (position == std::string::npos) {
+        throw std::runtime_error("Sin métricas en " + path);
+    }
+
+    std::vector<Metric> metrics;
+    position += std::strlen("\"metrics\":[");
+    while (position < document.size() && document[position] == '{') {
+        size_t end = document.find('}', position);
+        if (end == std::string::npos) {
+            throw std::runtime_error("Métrica incompleta en " + path);
+        }
+        auto fields = StreamVio::parseFlatJsonObject(document.substr(position, end - position + 1));
+        Metric metric;
+        metric.name = fields["name"];
+        metric.value = std::atof(fields["value"].c_str());
+        metric.unit = fields["unit"];
+        metric.higherIsBetter = fields["better"] != "lower";
+        metrics.push_back(metric);
+        position = end + 1;
+        if (position < document.size() && document[position] == ',') {
+            ++position;
+        }
+    }
+    return metrics;
+}
+
+// Devuelve el array JSON de la comparación y cuenta las regresiones
+std::string compareWithBaseline(const std::vector<Metric>& current, const std::vector<Metric>& baseline,
+                                double thresholdPercent, int& regressions) {
+    std::map<std::string, const Metric*> byName;
+    for (const auto& metric : baseline) {
+        byName[metric.name] = &metric;
+    }
+
+    std::string json = "[";
+    bool firstEntry = true;
+    regressions = 0;
+    for (const auto& metric : current) {
+        auto it = byName.find(metric.name);
+        if (it == byName.end() || it->second->value == 0) {
+            continue;
+        }
+        double before = it->second->value;
+        double change = (metric.value - before) / before * 100.0;
+        bool regression = metric.higherIsBetter ? change < -thresholdPercent : change > thresholdPercent;
+        regressions += regression ? 1 : 0;
+
+        std::cerr << (regression ? "PEOR   " : "       ") << metric.name << ": " << before << " -> "
+                  << metric.value << " " << metric.unit << " (" << (change >= 0 ? "+" : "") << change << "%)"
+                  << std::endl;
+
+        JsonWriter entry;
+        entry.field("name", metric.name)
+            .field("baseline", before)
+            .field("value", metric.value)
+            .field("changePercent", change)
+            .field("regression", regression);
+        json += (firstEntry ? "" : ",") + entry.str();
+        firstEntry = false;
+    }
+    return json + "]";
+}
+
+std::string hostToJson(const BenchConfig& config) {
+    utsname system{};
+    ::uname(&system);
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::vector<std::string> inputs;
+    for (const auto& input : config.inputs) {
+        inputs.push_back(input.label);
+    }
+
+    JsonWriter json;
+    json.field("timestamp", timestamp)
+        .field("machine", system.machine)
+        .field("kernel", system.release)
+        .field("cpus", static_cast<int>(std::thread::hardware_concurrency()))
+        .field("simd", StreamVio::frameKernels().name)
+        .field("ffmpeg", av_version_info())
+        .field("durationSeconds", config.durationSeconds)
+        .field("threads", config.threads)
+        .raw("inputs", stringsToJson(inputs));
+    return json.str();
+}
+
+void printUsage() {
+    std::cout << "Uso: streamvio_bench [opciones]" << std::endl;
+    std::cout << "  --inputs=<lista>          - Entradas sintéticas (por defecto 480p:h264,1080p:h264,1080p:hevc)" << std::endl;
+    std::cout << "  --duration=<segundos>     - Duración de cada entrada (por defecto 20)" << std::endl;
+    std::cout << "  --threads=<n>             - Hilos de decodificación/codificación (0 = automático)" << std::endl;
+    std::cout << "  --only=<lista>            - Grupos a medir: probe,remux,trickplay,transcode,jit" << std::endl;
+    std::cout << "  --work-dir=<dir>          - Directorio de trabajo; las entradas se reutilizan" << std::endl;
+    std::cout << "  --keep                    - No borrar el directorio temporal ni las salidas al terminar" << std::endl;
+    std::cout << "  --output=<archivo>        - Guardar el JSON en un archivo (por defecto stdout)" << std::endl;
+    std::cout << "  --compare=<archivo>       - Comparar con un resultado anterior" << std::endl;
+    std::cout << "  --threshold=<porcentaje>  - Empeoramiento tolerado en la comparación (por defecto 10)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (hasOption(args, "--help") || hasOption(args, "-h")) {
+        printUsage();
+        return 0;
+    }
+
+    BenchConfig config;
+    try {
+        for (const auto& item : splitList(getOptionValue(args, "--inputs", "480p:h264,1080p:h264,1080p:hevc"))) {
+            config.inputs.push_back(parseInputSpec(item));
+        }
+        config.durationSeconds = std::stoi(getOptionValue(args, "--duration", "20"));
+        config.threads = std::stoi(getOptionValue(args, "--threads", "0"));
+        config.thresholdPercent = std::stod(getOptionValue(args, "--threshold", "10"));
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Opción no válida: " << e.what() << std::endl;
+        return 1;
+    }
+    if (config.inputs.empty() || config.durationSeconds <= 0) {
+        std::cerr << "Error: Se necesita al menos una entrada con duración positiva" << std::endl;
+        return 1;
+    }
+    config.only = splitList(getOptionValue(args, "--only"));
+    config.outputPath = getOptionValue(args, "--output");
+    config.comparePath = getOptionValue(args, "--compare");
+    config.workDir = getOptionValue(args, "--work-dir");
+    config.keep = hasOption(args, "--keep");
+
+    bool temporaryDir = config.workDir.empty();
+    if (temporaryDir) {
+        char pattern[] = "/tmp/streamvio-bench-XXXXXX";
+        if (!::mkdtemp(pattern)) {
+            std::cerr << "Error: No se pudo crear el directorio de trabajo" << std::endl;
+            return 1;
+        }
+        config.workDir = pattern;
+    }
+    std::filesystem::create_directories(std::filesystem::path(config.workDir) / "out");
+    // Los índices y análisis de una ejecución anterior cambiarían los tiempos
+    std::string indexDir = (std::filesystem::path(config.workDir) / "out" / "index").string();
+    ::setenv("STREAMVIO_INDEX_DIR", indexDir.c_str(), 1);
+
+    Bench bench(config);
+    bench.run();
+
+    JsonWriter json;
+    json.field("version", 1)
+        .raw("host", hostToJson(config))
+        .raw("metrics", metricsToJson(bench.results()))
+        .raw("errors", stringsToJson(bench.failures()));
+
+    int regressions = 0;
+    if (!config.comparePath.empty()) {
+        try {
+            std::vector<Metric> baseline = loadBaseline(config.comparePath);
+            json.field("baseline", config.comparePath)
+                .field("thresholdPercent", config.thresholdPercent)
+                .raw("comparison", compareWithBaseline(bench.results(), baseline, config.thresholdPercent, regressions));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (config.outputPath.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream out(config.outputPath, std::ios::trunc);
+        out << json.str() << std::endl;
+        if (!out) {
+            std::cerr << "Error: No se pudo escribir " << config.outputPath << std::endl;
+            return 1;
+        }
+    }
+
+    // Con --keep se conserva todo, también las salidas y los índices
+    if (!config.keep) {
+        std::error_code ec;
+        if (temporaryDir) {
+            std::filesystem::remove_all(config.workDir, ec);
+        } else {
+            std::filesystem::remove_all(std::filesystem::path(config.workDir) / "out", ec);
+        }
+    }
+
+    if (!bench.failures().empty()) {
+        return 1;
+    }
+    if (regressions > 0) {
+        std::cerr << regressions << " métricas empeoran más de un " << config.thresholdPercent << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,386 @@
+// StreamVio/core/bench/http_bench.cpp
+//
+// Generador de carga para comparar el servidor de archivos nativo con la
+// ruta de streaming de Node. Abre N conexiones keep-alive que piden el mismo
+// archivo (entero o por rangos aleatorios, como un reproductor que salta) y
+// mide el caudal. Con --pid muestrea además el CPU del proceso servidor para
+// calcular núcleos por Gbps.
+//
+//   streamvio_http_bench 127.0.0.1:8090 /data-storage/transcoded/x_hls/segment_0_000.ts
+//       --connections=200 --duration=20 --token=$TOKEN --pid=$(pidof streamvio_fileserver)
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "utils/json_writer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    std::string host;
+    std::string port;
+    std::string path;
+    std::string token;
+    int connections = 50;
+    int durationSeconds = 10;
+    int64_t rangeBytes = 0;     // 0 = archivo completo en cada petición
+    int serverPid = 0;
+};
+
+struct Totals {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> latencyUs{0};
+};
+
+std::string getOptionValue(const std::vector<std::string>& args, const std::string& option, const std::string& defaultValue = "") {
+    for (const auto& arg : args) {
+        if (arg.find(option + "=") == 0) {
+            return arg.substr(option.length() + 1);
+        }
+    }
+    return defaultValue;
+}
+
+int connectTo(const BenchOptions& options) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (::getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &result) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* entry = result; entry; entry = entry->ai_next) {
+        fd = ::socket(entry->ai_family, entry->ai_socktype | SOCK_CLOEXEC, entry->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, entry->ai_addr, entry->ai_addrlen) == 0) {
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(result);
+    if (fd >= 0) {
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+struct Response {
+    int status = 0;
+    int64_t contentLength = -1;
+    int64_t totalSize = -1;     // De Content-Range
+    bool close = false;
+};
+
+std::string lowerCopy(std::string value) {
+    for (char& c : value) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return value;
+}
+
+// Lee cabeceras y cuerpo (descartándolo). `buffer` conserva lo leído de más.
+bool readResponse(int fd, std::vector<char>& scratch, std::string& buffer, Response& response, uint64_t& bodyBytes) {
+    size_t headEnd;
+    while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = ::recv(fd, scratch.data(), scratch.size(), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(scratch.data(), static_cast<size_t>(n));
+    }
+
+    std::istringstream head(buffer.substr(0, headEnd));
+    buffer.erase(0, headEnd + 4);
+    std::string line;
+    std::getline(head, line);
+    if (line.size() < 12) {
+        return false;
+    }
+    response.status = std::atoi(line.c_str() + 9);
+    while (std::getline(head, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = lowerCopy(line.substr(0, colon));
+        std::string value = line.substr(colon + 1);
+        if (name == "content-length") {
+            response.contentLength = std::atoll(value.c_str());
+        } else if (name == "content-range") {
+            size_t slash = value.find('/');
+            if (slash != std::string::npos && value[slash + 1] != '*') {
+                response.totalSize = std::atoll(value.c_str() + slash + 1);
+            }
+        } else if (name == "connection") {
+            response.close = lowerCopy(value).find("close") != std::string::npos;
+        }
+    }
+    if (response.contentLength < 0) {
+        // Sin longitud (Node sin Content-Length): hasta el cierre
+        response.close = true;
+    }
+
+    int64_t remaining = response.contentLength;
+    int64_t buffered = std::min<int64_t>(remaining < 0 ? static_cast<int64_t>(buffer.size()) : remaining,
+                                         static_cast<int64_t>(buffer.size()));
+    buffer.erase(0, static_cast<size_t>(buffered));
+    bodyBytes = static_cast<uint64_t>(buffered);
+    if (remaining >= 0) {
+        remaining -= buffered;
+    }
+    while (remaining != 0) {
+        size_t want = remaining < 0 ? scratch.size() : static_cast<size_t>(std::min<int64_t>(remaining, scratch.size()));
+        ssize_t n = ::recv(fd, scratch.data(), want, 0);
+        if (n <= 0) {
+            return remaining < 0;
+        }
+        bodyBytes += static_cast<uint64_t>(n);
+        if (remaining > 0) {
+            remaining -= n;
+        }
+    }
+    return true;
+}
+
+std::string buildRequest(const BenchOptions& options, int64_t start, int64_t length) {
+    std::string request = "GET " + options.path + " HTTP/1.1\r\nHost: " + options.host + "\r\n";
+    if (!options.token.empty()) {
+        request += "Authorization: Bearer " + options.token + "\r\n";
+    }
+    if (length > 0) {
+        request += "Range: bytes=" + std::to_string(start) + "-" + std::to_string(start + length - 1) + "\r\n";
+    }
+    return request + "Connection: keep-alive\r\n\r\n";
+}
+
+// Tamaño del archivo pidiendo su primer byte
+int64_t discoverSize(const BenchOptions& options) {
+    int fd = connectTo(options);
+    if (fd < 0) {
+        return -1;
+    }
+    std::vector<char> scratch(64 * 1024);
+    std::string buffer;
+    Response response;
+    uint64_t body = 0;
+    int64_t size = -1;
+    if (sendAll(fd, buildRequest(options, 0, 1)) && readResponse(fd, scratch, buffer, response, body)) {
+        if (response.status == 206) {
+            size = response.totalSize;
+        } else if (response.status == 200) {
+            size = response.contentLength;
+        } else {
+            std::cerr << "El servidor respondió " << response.status << std::endl;
+        }
+    }
+    ::close(fd);
+    return size;
+}
+
+void runConnection(const BenchOptions& options, int64_t fileSize, Clock::time_point deadline,
+                   Totals& totals, unsigned seed) {
+    std::mt19937_64 random(seed);
+    std::vector<char> scratch(256 * 1024);
+    std::string buffer;
+    int fd = -1;
+
+    while (Clock::now() < deadline) {
+        if (fd < 0) {
+            fd = connectTo(options);
+            if (fd < 0) {
+                totals.errors.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            buffer.clear();
+            totals.reconnects.fetch_add(1);
+        }
+
+        int64_t length = std::min(options.rangeBytes, fileSize);
+        int64_t start = 0;
+        if (length > 0 && fileSize > length) {
+            start = static_cast<int64_t>(random() % static_cast<uint64_t>(fileSize - length + 1));
+        }
+
+        Clock::time_point begin = Clock::now();
+        Response response;
+        uint64_t body = 0;
+        if (!sendAll(fd, buildRequest(options, start, length)) ||
+            !readResponse(fd, scratch, buffer, response, body) ||
+            (response.status != 200 && response.status != 206)) {
+            totals.errors.fetch_add(1);
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin);
+        totals.requests.fetch_add(1);
+        totals.bytes.fetch_add(body);
+        totals.latencyUs.fetch_add(static_cast<uint64_t>(elapsed.count()));
+        if (response.close) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+// Segundos de CPU (usuario + sistema) consumidos por un proceso, -1 si no existe
+double processCpuSeconds(int pid) {
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string content;
+    if (!std::getline(stat, content)) {
+        return -1.0;
+    }
+    // El nombre del proceso va entre paréntesis y puede contener espacios
+    size_t close = content.rfind(')');
+    if (close == std::string::npos) {
+        return -1.0;
+    }
+    std::istringstream fields(content.substr(close + 2));
+    std::string field;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    // Tras el nombre: state(3) ... utime(14) stime(15)
+    for (int index = 3; index <= 15 && fields >> field; ++index) {
+        if (index == 14) utime = std::stoull(field);
+        if (index == 15) stime = std::stoull(field);
+    }
+    return static_cast<double>(utime + stime) / static_cast<double>(::sysconf(_SC_CLK_TCK));
+}
+
+double ownCpuSeconds() {
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void printUsage() {
+    std::cout << "Uso: streamvio_http_bench <host:puerto> <ruta> [opciones]" << std::endl;
+    std::cout << "  --connections=<n>         - Conexiones simultáneas (por defecto 50)" << std::endl;
+    std::cout << "  --duration=<segundos>     - Duración de la prueba (por defecto 10)" << std::endl;
+    std::cout << "  --range=<bytes>           - Rangos aleatorios de ese tamaño (0 = archivo completo)" << std::endl;
+    std::cout << "  --token=<jwt>             - Token enviado en Authorization: Bearer" << std::endl;
+    std::cout << "  --pid=<pid>               - Proceso servidor cuyo CPU se mide" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+
+    BenchOptions options;
+    size_t colon = args[0].rfind(':');
+    if (colon == std::string::npos) {
+        std::cerr << "Error: Se esperaba host:puerto" << std::endl;
+        return 1;
+    }
+    options.host = args[0].substr(0, colon);
+    options.port = args[0].substr(colon + 1);
+    options.path = args[1];
+    options.token = getOptionValue(args, "--token");
+    try {
+        options.connections = std::stoi(getOptionValue(args, "--connections", "50"));
+        options.durationSeconds = std::stoi(getOptionValue(args, "--duration", "10"));
+        options.rangeBytes = std::stoll(getOptionValue(args, "--range", "0"));
+        options.serverPid = std::stoi(getOptionValue(args, "--pid", "0"));
+    } catch (...) {
+        std::cerr << "Error: Opción numérica no válida" << std::endl;
+        return 1;
+    }
+
+    int64_t fileSize = discoverSize(options);
+    if (fileSize <= 0) {
+        std::cerr << "Error: No se pudo obtener " << options.path << std::endl;
+        return 1;
+    }
+
+    Totals totals;
+    double serverCpuStart = options.serverPid > 0 ? processCpuSeconds(options.serverPid) : -1.0;
+    double clientCpuStart = ownCpuSeconds();
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::seconds(options.durationSeconds);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(runConnection, std::cref(options), fileSize, deadline, std::ref(totals),
+                             static_cast<unsigned>(i + 1));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    double serverCpu = serverCpuStart >= 0 ? processCpuSeconds(options.serverPid) - serverCpuStart : -1.0;
+    double clientCpu = ownCpuSeconds() - clientCpuStart;
+    uint64_t requests = totals.requests.load();
+    double gbps = static_cast<double>(totals.bytes.load()) * 8.0 / seconds / 1e9;
+
+    StreamVio::JsonWriter json;
+    json.field("path", options.path)
+        .field("fileSize", fileSize)
+        .field("connections", options.connections)
+        .field("rangeBytes", options.rangeBytes)
+        .field("seconds", seconds)
+        .field("requests", static_cast<int64_t>(requests))
+        .field("errors", static_cast<int64_t>(totals.errors.load()))
+        .field("connects", static_cast<int64_t>(totals.reconnects.load()))
+        .field("requestsPerSecond", static_cast<double>(requests) / seconds)
+        .field("gbps", gbps)
+        .field("meanLatencyMs", requests ? static_cast<double>(totals.latencyUs.load()) / requests / 1000.0 : 0.0)
+        .field("clientCpuSeconds", clientCpu);
+    if (serverCpu >= 0) {
+        // Núcleos ocupados en el servidor por cada Gbps servido
+        json.field("serverCpuSeconds", serverCpu)
+            .field("serverCoresPerGbps", gbps > 0 ? serverCpu / seconds / gbps : 0.0);
+    }
+    std::cout << json.str() << std::endl;
+    return totals.requests.load() > 0 ? 0 : 1;
+}
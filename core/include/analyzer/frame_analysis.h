@@ -0,0 +1,103 @@
+// StreamVio/core/include/analyzer/frame_analysis.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/ffmpeg_utils.h"
+
+namespace StreamVio {
+
+// Sidecar con el análisis de los keyframes decodificados durante el
+// trickplay. Little-endian, junto al índice de keyframes:
+//
+//   FrameAnalysisHeader
+//   FrameAnalysisEntry[frameCount]   (ordenadas por tiempo)
+//
+// Como el índice, guarda el tamaño y la fecha del origen para detectar que
+// ha cambiado. Cualquier cambio de estructura incrementa kFrameAnalysisVersion.
+const uint32_t kFrameAnalysisVersion = 1;
+
+enum FrameAnalysisFlags : uint8_t {
+    kFrameBlack = 1 << 0,       // Prácticamente todo por debajo del umbral de negro
+    kFrameFade = 1 << 1,        // Mayoría de píxeles oscuros: fundido o plano muy oscuro
+    kFrameFlat = 1 << 2,        // Casi sin contraste (cartón liso, logo sobre color)
+    kFrameSceneCut = 1 << 3,    // Histograma muy distinto del keyframe anterior
+};
+
+struct FrameAnalysisHeader {
+    char magic[8];              // "SVFRAME\0"
+    uint32_t version;
+    uint32_t frameCount;
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+    int64_t durationUs;
+    uint64_t titleHash;         // Voto por mayoría de los hashes de frames útiles
+    uint64_t reserved[2];
+};
+
+struct FrameAnalysisEntry {
+    int64_t timeUs;             // Desde el inicio del archivo
+    uint64_t perceptualHash;    // pHash de 64 bits (DCT 32x32, 8x8 frecuencias bajas)
+    float meanLuma;             // 0-255
+    float stddevLuma;
+    float histogramDelta;       // Frente al keyframe anterior: 0 (igual) a 1 (disjunto)
+    uint8_t flags;              // FrameAnalysisFlags
+    uint8_t darkPercent;        // % de píxeles por debajo del umbral de negro
+    uint16_t reserved;
+};
+
+static_assert(sizeof(FrameAnalysisHeader) == 64, "Cabecera del análisis con tamaño inesperado");
+static_assert(sizeof(FrameAnalysisEntry) == 32, "Entrada del análisis con tamaño inesperado");
+
+struct FrameAnalysis {
+    FrameAnalysisHeader header{};
+    std::vector<FrameAnalysisEntry> entries;
+};
+
+// Ruta del sidecar: la del índice de keyframes con extensión .svfa
+std::string frameAnalysisPath(const std::string& sourcePath);
+
+// False si no existe, está dañado o ya no corresponde al origen
+bool readFrameAnalysis(const std::string& sourcePath, FrameAnalysis& analysis);
+
+// Keyframe más adecuado como miniatura cerca de `requestedMs`: evita negros,
+// fundidos y planos sin contraste y, entre los válidos, pondera contraste y
+// cercanía. Devuelve `requestedMs` si ninguno sirve.
+int64_t chooseThumbnailTimeMs(const FrameAnalysis& analysis, int64_t requestedMs);
+
+int hammingDistance(uint64_t a, uint64_t b);
+
+// Analiza frames ya decodificados (cualquier formato de píxel) sin
+// decodificar nada por su cuenta. Trabaja sobre la luma con los núcleos de
+// frame_kernels.h; los formatos que no son YUV de 8 bits se convierten antes
+// a gris.
+class FrameAnalyzer {
+public:
+    // Devuelve la entrada del frame (válida hasta la siguiente llamada), o
+    // nullptr si no se pudo analizar
+    const FrameAnalysisEntry* addFrame(const AVFrame* frame, int64_t timeUs);
+
+    const std::vector<FrameAnalysisEntry>& entries() const { return frames; }
+    uint64_t titleHash() const;
+
+    // Escribe el sidecar de `sourcePath` de forma atómica. Lanza
+    // std::runtime_error si falla.
+    void write(const std::string& sourcePath, int64_t durationUs) const;
+
+private:
+    static constexpr int kHistogramBins = 64;
+    static constexpr int kHashSize = 32;
+
+    const uint8_t* lumaPlane(const AVFrame* frame, int& stride, bool& fullRange);
+
+    std::vector<FrameAnalysisEntry> frames;
+    uint32_t previousHistogram[kHistogramBins] = {};
+    uint64_t previousPixels = 0;
+    SwsContextPtr converter;
+    FramePtr gray;
+    std::vector<uint32_t> columnSums;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,36 @@
+// StreamVio/core/include/analyzer/frame_kernels.h
+#pragma once
+
+#include <cstdint>
+
+namespace StreamVio {
+
+// Acumuladores de un plano de luma de 8 bits
+struct LumaStats {
+    uint64_t sum = 0;
+    uint64_t sumSquares = 0;
+    uint64_t darkPixels = 0;        // Píxeles <= umbral de negro
+    uint64_t pixels = 0;
+};
+
+// Núcleos vectorizados que recorren una fila de luma. Trabajan por filas
+// para que el llamador gestione el stride y los bordes del plano.
+struct FrameKernels {
+    const char* name;               // "avx2", "sse2" o "scalar"
+
+    // Suma, suma de cuadrados y píxeles oscuros de `width` bytes
+    void (*lumaStats)(const uint8_t* row, int width, uint8_t darkThreshold, LumaStats& stats);
+
+    // acc[i] += row[i]: base de la reducción por bloques del hash perceptual
+    void (*accumulateRow)(const uint8_t* row, int width, uint32_t* acc);
+};
+
+// La mejor implementación que admite la CPU, elegida una vez en tiempo de
+// ejecución (el binario no necesita compilarse con -mavx2). La variable de
+// entorno STREAMVIO_SIMD=scalar|sse2 fuerza una inferior para comparar.
+const FrameKernels& frameKernels();
+
+// Implementación de referencia en C++ portable
+const FrameKernels& scalarFrameKernels();
+
+} // namespace StreamVio
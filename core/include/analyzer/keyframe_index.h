@@ -0,0 +1,136 @@
+// StreamVio/core/include/analyzer/keyframe_index.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct AVFormatContext;
+
+namespace StreamVio {
+
+// Índice binario de keyframes guardado junto al archivo (sidecar).
+//
+// El formato está pensado para mapearse en memoria y consultarse con
+// búsqueda binaria sin analizar nada. Todo es little-endian y los campos
+// están alineados a 8 bytes:
+//
+//   KeyframeIndexHeader
+//   KeyframeIndexStream[streamCount]
+//   KeyframeIndexEntry[...]   (las de cada stream contiguas, ordenadas por pts)
+//
+// La cabecera guarda el tamaño y la fecha de modificación del origen: si
+// alguno cambia el índice se considera obsoleto y se vuelve a generar.
+// Cualquier cambio de estructura incrementa kKeyframeIndexVersion.
+const uint32_t kKeyframeIndexVersion = 1;
+
+struct KeyframeIndexHeader {
+    char magic[8];              // "SVKFIDX\0"
+    uint32_t version;
+    uint32_t streamCount;
+    uint64_t sourceSize;        // Bytes del archivo de origen
+    int64_t sourceMtimeNs;      // Modificación del origen, ns desde epoch
+    uint64_t totalSize;         // Bytes del propio índice (detecta truncados)
+    int64_t startTimeUs;        // start_time del contenedor (0 si no tiene)
+    int64_t durationUs;
+    uint64_t reserved;
+};
+
+struct KeyframeIndexStream {
+    int32_t streamIndex;        // Índice del AVStream en el contenedor
+    int32_t mediaType;          // AVMediaType
+    int32_t timeBaseNum;
+    int32_t timeBaseDen;
+    uint64_t firstEntry;        // Posición en el array de entradas
+    uint64_t entryCount;
+};
+
+struct KeyframeIndexEntry {
+    int64_t pts;                // En la base de tiempo del stream
+    int64_t position;           // Offset del paquete en el archivo, -1 si se desconoce
+    uint32_t size;              // Bytes del paquete
+    uint32_t reserved;
+};
+
+static_assert(sizeof(KeyframeIndexHeader) == 64, "Cabecera del índice con tamaño inesperado");
+static_assert(sizeof(KeyframeIndexStream) == 32, "Stream del índice con tamaño inesperado");
+static_assert(sizeof(KeyframeIndexEntry) == 24, "Entrada del índice con tamaño inesperado");
+
+// Rango de bytes del origen [offset, offset + length)
+struct ByteRange {
+    int64_t offset = 0;
+    int64_t length = 0;
+};
+
+// Ruta del índice de un archivo: "<archivo>.svidx", o un nombre derivado de
+// la ruta dentro de $STREAMVIO_INDEX_DIR si está definida (bibliotecas en
+// volúmenes de solo lectura)
+std::string keyframeIndexPath(const std::string& sourcePath);
+
+// Recorre `input` (recién abierto y analizado) y escribe el índice en
+// `indexPath` de forma atómica. Se indexan los keyframes de los streams de
+// video y, en los de audio, un punto cada segundo. En contenedores MP4/MOV
+// sin reordenación de frames se usa la tabla de muestras del propio
+// contenedor sin leer paquetes. Lanza std::runtime_error si falla.
+void writeKeyframeIndex(AVFormatContext* input, const std::string& sourcePath, const std::string& indexPath);
+
+// Abre `sourcePath` y genera su índice en keyframeIndexPath(). Devuelve la ruta.
+std::string buildKeyframeIndex(const std::string& sourcePath);
+
+// Posiciona `input` en un keyframe obtenido del índice. En MPEG-TS, que no
+// tiene índice propio y donde buscar por tiempo es una búsqueda binaria
+// leyendo el archivo, salta directamente a su offset; en el resto pide su
+// pts exacto. Devuelve el resultado de avformat_seek_file.
+int seekToKeyframe(AVFormatContext* input, int streamIndex, const KeyframeIndexEntry& keyframe);
+
+// Vista de solo lectura de un índice mapeado en memoria
+class KeyframeIndex {
+public:
+    // nullptr si no existe, está dañado o ya no corresponde al origen
+    static std::unique_ptr<KeyframeIndex> open(const std::string& indexPath, const std::string& sourcePath);
+
+    ~KeyframeIndex();
+
+    KeyframeIndex(const KeyframeIndex&) = delete;
+    KeyframeIndex& operator=(const KeyframeIndex&) = delete;
+
+    const KeyframeIndexHeader& header() const { return *headerData; }
+
+    // Stream indexado con ese índice de AVStream, o nullptr
+    const KeyframeIndexStream* findStream(int streamIndex) const;
+    // El primer stream de video, o el primero indexado si no hay video
+    const KeyframeIndexStream* primaryStream() const;
+
+    const KeyframeIndexEntry* entries(const KeyframeIndexStream& stream) const {
+        return entryData + stream.firstEntry;
+    }
+
+    // Último keyframe con pts <= `pts`; nullptr si `pts` es anterior al primero
+    const KeyframeIndexEntry* keyframeAtOrBefore(const KeyframeIndexStream& stream, int64_t pts) const;
+    // Primer keyframe con pts >= `pts`; nullptr si no hay ninguno
+    const KeyframeIndexEntry* keyframeAtOrAfter(const KeyframeIndexStream& stream, int64_t pts) const;
+
+    // Bytes que hay que leer para reproducir [startPts, endPts): desde el
+    // keyframe anterior a startPts hasta el primer keyframe >= endPts (o el
+    // final del archivo). False si el stream no tiene posiciones.
+    bool byteRange(const KeyframeIndexStream& stream, int64_t startPts, int64_t endPts, ByteRange& range) const;
+
+    // Milisegundos desde el inicio del archivo <-> pts del stream
+    int64_t msToPts(const KeyframeIndexStream& stream, int64_t timeMs) const;
+    int64_t ptsToMs(const KeyframeIndexStream& stream, int64_t pts) const;
+
+    // False si el origen ha cambiado desde que se abrió el índice
+    bool matchesSource(const std::string& sourcePath) const;
+
+private:
+    KeyframeIndex(const void* data, size_t size);
+
+    const void* mapping;
+    size_t mappingSize;
+    const KeyframeIndexHeader* headerData;
+    const KeyframeIndexStream* streamData;
+    const KeyframeIndexEntry* entryData = nullptr;   // Se fija en open() tras validar
+};
+
+} // namespace StreamVio
@@ -0,0 +1,27 @@
+// StreamVio/core/include/analyzer/media_prober.h
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "transcoder/transcoder.h"
+
+namespace StreamVio {
+
+// Analiza un archivo en proceso con libavformat.
+// Lanza std::runtime_error si el archivo no se puede abrir o analizar.
+MediaInfo probeMedia(const std::string& inputPath, const ProbeOptions& options);
+
+// Serializa la información de un archivo como objeto JSON de una línea
+std::string mediaInfoToJson(const MediaInfo& info);
+
+// Lee rutas (una por línea) de `input`, las analiza en un pool de
+// `threads` hilos y escribe un objeto JSON por resultado en `output`
+// según van terminando. Devuelve el número de archivos que fallaron.
+size_t probeMany(std::istream& input,
+                 std::ostream& output,
+                 size_t threads,
+                 const ProbeOptions& options);
+
+} // namespace StreamVio
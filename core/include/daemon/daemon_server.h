@@ -0,0 +1,87 @@
+// StreamVio/core/include/daemon/daemon_server.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "daemon/job_manager.h"
+#include "transcoder/transcoder.h"
+
+namespace StreamVio {
+
+struct DaemonOptions {
+    std::string socketPath = "/tmp/streamvio-transcoder.sock";
+    int coreBudget = 0;     // 0 = núcleos disponibles
+    std::string metricsFile;        // Volcado periódico en formato Prometheus, vacío = ninguno
+    int metricsIntervalSeconds = 15;
+};
+
+// Servidor persistente sobre un socket Unix. Cada conexión envía objetos
+// JSON de una línea y recibe una respuesta JSON por línea:
+//
+//   {"id":1,"op":"submit","type":"transcode","input":"...","output":"...",
+//    "priority":"interactive","cores":2}     -> {"id":1,"ok":true,"job":7}
+//   {"op":"status","job":7}                  -> {"ok":true,"job":7,"state":"running","progress":42,...}
+//   {"op":"list"}                            -> {"ok":true,"jobs":[...]}
+//   {"op":"cancel","job":7} o {"op":"cancel","output":"..."}
+//   {"op":"probe","input":"...","fast":true} -> {"ok":true,"info":{...}}
+//   {"op":"thumbnail","input":"...","output":"...","time":5000}
+//   {"op":"metrics"}                         -> {"ok":true,"text":"# HELP ..."}  (Prometheus)
+//   {"op":"watch","job":7,"intervalMs":1000} -> {"event":"progress","job":7,...,"metrics":{...}}
+//                                               por línea hasta {"event":"done",...}
+//   {"op":"ping"}, {"op":"shutdown"}
+//
+// "status" y "watch" incluyen, en las transcodificaciones, fps, speed,
+// bytes, tiempo y latencia por etapa y el estado de las colas. Mientras
+// dura un "watch" la conexión no atiende otras peticiones.
+//
+// Tipos de trabajo: transcode, hls y trickplay. probe y thumbnail se
+// atienden en el momento sin pasar por la cola.
+class DaemonServer {
+public:
+    DaemonServer(Transcoder& transcoder, const DaemonOptions& options);
+    ~DaemonServer();
+
+    DaemonServer(const DaemonServer&) = delete;
+    DaemonServer& operator=(const DaemonServer&) = delete;
+
+    // Atiende conexiones hasta recibir "shutdown" o hasta stop().
+    // Lanza std::runtime_error si no se puede abrir el socket.
+    void run();
+    void stop();
+
+private:
+    void serveClient(int clientFd);
+    std::string handleRequest(const std::string& line);
+    // Emite eventos de progreso hasta que el trabajo termina; false si el
+    // cliente se ha desconectado
+    bool watchJob(int clientFd, const std::map<std::string, std::string>& request);
+    std::string prometheusMetrics();
+    void metricsLoop();
+    // Devuelve el id del trabajo. Lanza std::runtime_error si la petición no es válida.
+    int64_t submitJob(const std::map<std::string, std::string>& request);
+
+    Transcoder& transcoder;
+    DaemonOptions options;
+    JobManager jobs;
+
+    std::atomic<bool> stopping{false};
+    int listenFd = -1;
+
+    // Despierta las esperas periódicas (watch y volcado de métricas) al parar
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::thread metricsThread;
+
+    std::mutex clientsMutex;
+    std::condition_variable clientsFinished;
+    std::set<int> clientFds;
+    int activeClients = 0;
+};
+
+} // namespace StreamVio
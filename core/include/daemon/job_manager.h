@@ -0,0 +1,120 @@
+// StreamVio/core/include/daemon/job_manager.h
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/job_control.h"
+
+namespace StreamVio {
+
+// De mayor a menor prioridad
+enum class JobPriority {
+    Interactive,    // Reproducción en curso: un espectador está esperando
+    Normal,
+    Background      // Trabajo de biblioteca (HLS, miniaturas) sin prisa
+};
+
+enum class JobState {
+    Queued,
+    Running,
+    Paused,         // Desalojado por un trabajo de mayor prioridad
+    Completed,
+    Failed,
+    Cancelled
+};
+
+const char* toString(JobPriority priority);
+const char* toString(JobState state);
+// Devuelve false si el nombre no corresponde a ninguna prioridad
+bool parseJobPriority(const std::string& name, JobPriority& priority);
+
+struct JobStatus {
+    int64_t id = 0;
+    std::string type;
+    std::string target;         // Salida del trabajo (clave para cancelTranscode)
+    JobPriority priority = JobPriority::Normal;
+    JobState state = JobState::Queued;
+    int cores = 1;
+    int progress = 0;
+    std::string error;
+};
+
+// Planificador de trabajos con un presupuesto global de núcleos.
+//
+// Cada trabajo declara cuántos núcleos ocupa. Se arranca el trabajo en
+// espera de mayor prioridad (FIFO dentro de la misma prioridad) si cabe en
+// el presupuesto; si no cabe, se pausan trabajos en curso de prioridad
+// menor hasta hacerle sitio. Los trabajos pausados se reanudan antes que
+// los nuevos de su misma prioridad en cuanto vuelve a haber núcleos libres.
+class JobManager {
+public:
+    // La función recibe el control del trabajo y el callback de progreso.
+    // Devuelve false (o lanza) si el trabajo falla; el motivo se toma de
+    // JobControl::error() o de la excepción.
+    using JobFunction = std::function<bool(const std::shared_ptr<JobControl>&,
+                                           std::function<void(int)>)>;
+
+    // coreBudget = 0 usa el número de núcleos disponibles
+    explicit JobManager(int coreBudget = 0);
+    // Cancela todos los trabajos y espera a que terminen
+    ~JobManager();
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    // Ajusta un número de núcleos pedido al rango [1, presupuesto]
+    int clampCores(int cores) const;
+
+    int64_t submit(const std::string& type,
+                   const std::string& target,
+                   JobPriority priority,
+                   int cores,
+                   JobFunction work);
+
+    // Cancela un trabajo en espera, pausado o en curso
+    bool cancel(int64_t id);
+
+    std::optional<JobStatus> status(int64_t id) const;
+    std::vector<JobStatus> list() const;
+
+    int coreBudget() const { return budget; }
+    int coresInUse() const;
+
+private:
+    struct Job {
+        JobStatus status;
+        JobFunction work;
+        std::shared_ptr<JobControl> control;
+        uint64_t startOrder = 0;
+        bool holdsCores = false;
+    };
+
+    // Todas requieren `mutex` tomado
+    void schedule();
+    Job* nextCandidate();
+    void launch(Job& job);
+    void pruneFinished();
+
+    void runJob(Job& job);
+
+    int budget;
+    int usedCores = 0;
+    int64_t nextId = 1;
+    uint64_t nextStartOrder = 0;
+    int runningThreads = 0;
+    bool shuttingDown = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable threadsFinished;
+    std::map<int64_t, std::unique_ptr<Job>> jobs;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,80 @@
+// StreamVio/core/include/scanner/library_scanner.h
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace StreamVio {
+
+// Archivo multimedia tal como se guarda en el índice de la biblioteca
+struct LibraryIndexEntry {
+    std::string path;           // Relativa a la raíz de la biblioteca
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    int64_t size = 0;
+    int64_t mtimeNs = 0;
+    uint64_t partialHash = 0;   // Primeros y últimos 64 KiB + tamaño; 0 si no se pudo leer
+};
+
+// Índice persistente de una biblioteca (binario, ordenado por ruta). Se
+// reescribe entero de forma atómica en cada escaneo. Cualquier cambio de
+// estructura incrementa kLibraryIndexVersion.
+const uint32_t kLibraryIndexVersion = 1;
+
+// False si no existe, está dañado, es de otra versión o de otra raíz: el
+// llamador empieza entonces con un índice vacío
+bool loadLibraryIndex(const std::string& indexPath, const std::string& root,
+                      std::vector<LibraryIndexEntry>& entries);
+// Lanza std::runtime_error si no se puede escribir
+void saveLibraryIndex(const std::string& indexPath, const std::string& root,
+                      const std::vector<LibraryIndexEntry>& entries);
+
+struct ScanOptions {
+    std::string indexPath;      // Vacío = "<raíz>/.streamvio-scan.idx"
+    int threads = 0;            // 0 = dos por núcleo (el recorrido espera sobre todo a E/S)
+    int maxDepth = 10;          // Igual que DirectoryScanner
+    bool followSymlinks = false;
+    bool includeHidden = false;
+    bool dryRun = false;        // Informar de los cambios sin actualizar el índice
+    int duplicateDistance = -1; // >= 0: buscar duplicados con el análisis de frames (bits de pHash distintos)
+};
+
+struct ScanSummary {
+    int64_t directories = 0;
+    int64_t files = 0;          // Archivos multimedia encontrados
+    int64_t added = 0;
+    int64_t changed = 0;
+    int64_t moved = 0;
+    int64_t removed = 0;
+    int64_t unchanged = 0;
+    int64_t hashed = 0;         // Archivos leídos para calcular el hash parcial
+    int64_t failedDirectories = 0;
+    int64_t duplicates = 0;
+    int64_t elapsedMs = 0;
+};
+
+// Recorre `root` con varios hilos (getdents64 por lotes y statx sin
+// sincronizar con el servidor en montajes de red) y lo compara con el índice
+// del escaneo anterior. En `out` escribe un evento NDJSON por cada archivo
+// multimedia añadido, modificado (tamaño, fecha o inodo distintos), movido
+// o eliminado, y un evento "summary" al final:
+//
+//   {"event":"moved","path":"/lib/b.mkv","from":"/lib/a.mkv","type":"video",...}
+//   {"event":"changed","path":...}  {"event":"added","path":...}  {"event":"removed","path":...}
+//
+// Un movimiento se detecta por inodo (renombrado en el mismo volumen) o por
+// tamaño y hash parcial (copiado y borrado). Los archivos sin cambios no se
+// leen. Si un directorio no se puede leer, sus entradas anteriores se
+// conservan en lugar de darse por eliminadas.
+//
+// Con duplicateDistance >= 0 se comparan además los videos que ya tienen
+// análisis de frames (ver frame_analysis.h) y se emite
+// {"event":"duplicate","path":...,"other":...,"distance":N} para cada par
+// con duración parecida y hash de título a esa distancia o menos: el mismo
+// título en otra calidad, contenedor o edición. Lanza std::runtime_error si
+// la raíz no existe.
+ScanSummary scanLibrary(const std::string& root, const ScanOptions& options, std::ostream& out);
+
+} // namespace StreamVio
@@ -0,0 +1,80 @@
+// StreamVio/core/include/server/file_server.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "server/jwt_verifier.h"
+
+namespace StreamVio {
+
+// Prefijo de URL servido desde un directorio
+struct FileServerMount {
+    std::string urlPrefix;      // Por ejemplo "/data-storage/transcoded/"
+    std::string directory;
+};
+
+struct FileServerOptions {
+    std::string bindAddress = "0.0.0.0";
+    int port = 8090;
+    int workers = 0;                    // 0 = núcleos disponibles (máximo 8)
+    std::vector<FileServerMount> mounts;
+    std::string jwtSecret;
+    bool requireAuth = true;
+    int idleTimeoutSeconds = 30;        // Conexiones keep-alive inactivas
+    int maxConnectionsPerWorker = 4096;
+};
+
+// Contadores globales del servidor (se actualizan sin bloqueo)
+struct FileServerStats {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> activeConnections{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> unauthorized{0};
+    std::atomic<uint64_t> notFound{0};
+};
+
+// Servidor HTTP/1.1 mínimo de solo lectura para el tráfico pesado de bytes:
+// reproducción directa con Range y segmentos HLS ya generados. Node sigue
+// decidiendo quién puede ver qué y redirige (o hace de proxy) aquí con el
+// mismo token, que se acepta en "Authorization: Bearer", en los parámetros
+// ?auth= o ?token= o en la cookie streamvio_token.
+//
+// Cada worker tiene su propio socket de escucha (SO_REUSEPORT) y su bucle
+// epoll, sin estado compartido. El cuerpo de las respuestas se envía con
+// sendfile, sin copiar los datos del archivo a espacio de usuario, y las
+// conexiones keep-alive se reutilizan entre peticiones.
+//
+// Solo GET y HEAD, y un único rango por petición (con varios se responde
+// el archivo completo, como permite RFC 9110).
+class FileServer {
+public:
+    explicit FileServer(const FileServerOptions& options);
+    ~FileServer();
+
+    FileServer(const FileServer&) = delete;
+    FileServer& operator=(const FileServer&) = delete;
+
+    // Atiende conexiones hasta stop(). Lanza std::runtime_error si no se
+    // puede escuchar en el puerto o algún montaje no existe.
+    void run();
+    // Segura desde un manejador de señales
+    void stop();
+
+    const FileServerStats& stats() const { return counters; }
+
+private:
+    class Worker;
+
+    FileServerOptions options;
+    JwtVerifier verifier;
+    FileServerStats counters;
+    std::atomic<bool> stopping{false};
+    int stopFd = -1;            // eventfd que despierta a los workers
+};
+
+} // namespace StreamVio
@@ -0,0 +1,29 @@
+// StreamVio/core/include/server/http_parsing.h
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace StreamVio {
+
+// Piezas de análisis de peticiones HTTP del servidor de archivos
+
+// Decodifica %XX (y '+' como espacio si `plusIsSpace`, para consultas).
+// False si hay secuencias %XX mal formadas o bytes nulos
+bool percentDecode(const std::string& input, std::string& output, bool plusIsSpace);
+
+// Quita espacios y tabuladores de los extremos
+std::string trim(const std::string& value);
+
+enum class RangeResult { None, Satisfiable, Unsatisfiable };
+
+// Un único rango "bytes=a-b", "bytes=a-" o "bytes=-n" sobre un archivo de
+// `fileSize` bytes; deja en [start, end] los bytes a servir (inclusive).
+// Con varios rangos o una sintaxis desconocida devuelve None y se sirve
+// todo el archivo.
+RangeResult parseRange(const std::string& header, int64_t fileSize, int64_t& start, int64_t& end);
+
+// Ruta relativa a un montaje sin componentes vacíos, "." ni ".."
+bool isSafeRelativePath(const std::string& path);
+
+} // namespace StreamVio
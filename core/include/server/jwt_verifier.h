@@ -0,0 +1,29 @@
+// StreamVio/core/include/server/jwt_verifier.h
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace StreamVio {
+
+// Verificación de los tokens que emite el servidor Node (jsonwebtoken con
+// HS256 y JWT_SECRET). Solo se comprueban la firma y las fechas: que el
+// usuario siga existiendo es cosa de quien haya emitido la URL.
+class JwtVerifier {
+public:
+    explicit JwtVerifier(std::string secret) : secret(std::move(secret)) {}
+
+    // Devuelve true si el token es válido a fecha `nowSeconds` y deja en
+    // `claims` el payload (objeto plano, como en parseFlatJsonObject). Si no,
+    // deja en `error` el mismo código que usa authMiddleware.js:
+    // INVALID_TOKEN o TOKEN_EXPIRED.
+    bool verify(const std::string& token, int64_t nowSeconds,
+                std::map<std::string, std::string>& claims, std::string& error) const;
+
+private:
+    std::string secret;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,50 @@
+// StreamVio/core/include/transcoder/audio_encoder.h
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/ffmpeg_utils.h"
+
+namespace StreamVio {
+
+struct AudioEncoderConfig {
+    std::string codecName = "aac";
+    int bitrateKbps = 128;
+    int maxChannels = 2;          // Se mezcla a estéreo por compatibilidad
+    int maxSampleRate = 48000;
+    bool globalHeader = false;    // Necesario para mp4/mkv
+};
+
+// Decodifica un stream de audio, lo convierte al formato del codificador
+// (formato de muestra, canales, tamaño de frame) y lo vuelve a codificar.
+// Los constructores lanzan std::runtime_error si algo no está disponible.
+class AudioEncoder {
+public:
+    AudioEncoder(const AVStream* inputStream, const AudioEncoderConfig& config);
+
+    AudioEncoder(const AudioEncoder&) = delete;
+    AudioEncoder& operator=(const AudioEncoder&) = delete;
+
+    const AVCodecContext* codecContext() const { return encoder.get(); }
+
+    // Procesa un paquete del stream de entrada (nullptr vacía los buffers)
+    // y añade a `output` los paquetes codificados en la base de tiempo
+    // del codificador.
+    void encode(const AVPacket* packet, std::vector<PacketPtr>& output);
+
+private:
+    void buildFilterGraph(const AVStream* inputStream);
+    void drainFilter(std::vector<PacketPtr>& output, bool flushing);
+    void drainEncoder(std::vector<PacketPtr>& output);
+
+    CodecContextPtr decoder;
+    CodecContextPtr encoder;
+    FilterGraphPtr graph;
+    AVFilterContext* sourceCtx = nullptr;
+    AVFilterContext* sinkCtx = nullptr;
+    FramePtr decodedFrame;
+    FramePtr filteredFrame;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,40 @@
+// StreamVio/core/include/transcoder/chunked_transcoder.h
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "transcoder/transcode_metrics.h"
+#include "transcoder/transcoder.h"
+#include "utils/job_control.h"
+
+namespace StreamVio {
+
+// Transcodifica un único archivo largo repartiendo el video en trozos de
+// unos TranscodeOptions::chunkSeconds segundos, alineados a keyframes del
+// origen, que se codifican en paralelo con codificadores independientes.
+// El audio se procesa en una sola pasada (sin huecos entre trozos) y al
+// final todo se concatena sin recodificar en el contenedor pedido,
+// conservando las marcas de tiempo originales.
+//
+// Los trozos terminados se guardan en "<salida>.chunks/" junto con un
+// manifiesto: si el trabajo se interrumpe o se cancela, la siguiente
+// llamada con la misma entrada y las mismas opciones solo codifica los que
+// faltan. El directorio se borra al terminar con éxito.
+//
+// Con `metrics`, los trozos registran demux, decode, scale y encode (la
+// escritura del trozo intermedio cuenta como encode), la pasada de audio
+// demux y audio, y la concatenación el mux; los frames son los codificados
+// y los bytes de salida los del archivo final.
+//
+// Si el video no se transcodifica, la duración es desconocida o cabe en
+// un solo trozo, equivale a transcodeFile. Lanza std::runtime_error (o
+// JobCancelled) si falla.
+void transcodeFileChunked(const std::string& inputPath,
+                          const std::string& outputPath,
+                          const TranscodeOptions& options,
+                          std::function<void(int)> progressCallback,
+                          JobControl* control = nullptr,
+                          TranscodeMetrics* metrics = nullptr);
+
+} // namespace StreamVio
@@ -0,0 +1,91 @@
+// StreamVio/core/include/transcoder/file_transcoder.h
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "transcoder/audio_encoder.h"
+#include "transcoder/pipeline_stats.h"
+#include "transcoder/transcode_metrics.h"
+#include "transcoder/transcoder.h"
+#include "transcoder/video_encoder.h"
+#include "utils/job_control.h"
+
+namespace StreamVio {
+
+enum class StreamAction {
+    None,       // El stream no existe en la entrada
+    Copy,       // Se copian los paquetes sin decodificar
+    Transcode   // Se decodifica y se vuelve a codificar
+};
+
+// Contenedor de salida deducido de TranscodeOptions::outputFormat o de la extensión
+enum class OutputContainer {
+    Mp4,            // moov al principio (faststart)
+    FragmentedMp4,  // frag_keyframe+empty_moov, reproducible mientras se escribe
+    Hls,            // Segmentos .ts y playlist .m3u8
+    Other           // Formato deducido por libavformat
+};
+
+struct TranscodePlan {
+    OutputContainer container = OutputContainer::Other;
+    std::string muxerName;
+    int videoIndex = -1;
+    int audioIndex = -1;
+    StreamAction video = StreamAction::None;
+    StreamAction audio = StreamAction::None;
+    // Codificadores de los streams que se transcodifican, ya comprobados
+    // contra el muxer (vacío si el stream se copia)
+    std::string videoEncoder;
+    std::string audioEncoder;
+
+    bool isRemux() const {
+        return video != StreamAction::Transcode && audio != StreamAction::Transcode;
+    }
+};
+
+// Decide, para cada stream, si los codecs de origen ya cumplen lo pedido
+// (codec, resolución, bitrate y compatibilidad con el contenedor) y por
+// tanto basta con copiar los paquetes. Para los que se transcodifican elige
+// un codificador que el muxer admita; lanza std::runtime_error si el codec
+// pedido no cabe en el contenedor o no hay ninguno disponible.
+TranscodePlan planTranscode(AVFormatContext* input,
+                            const std::string& outputPath,
+                            const TranscodeOptions& options);
+
+// Transcodifica `inputPath` en `outputPath`. Los streams marcados como
+// copia no se decodifican: si ninguno se transcodifica la operación es un
+// remux a velocidad de E/S. Informa del progreso por PTS, o por bytes
+// leídos si la duración es desconocida. Si se indica `control`, se
+// consulta en cada paquete (pausa y cancelación cooperativas).
+//
+// Cuando el video se transcodifica, decodificación, escalado, codificación
+// y muxing corren en hilos separados (ver TranscodePipeline) y
+// `statsCallback` recibe el estado de sus colas con cada avance del
+// progreso y al terminar. Con `metrics`, cada etapa (demux, decode, scale,
+// encode, audio y mux) registra su tiempo y su latencia por elemento, junto
+// con frames, bytes leídos y escritos y la posición alcanzada.
+// Lanza std::runtime_error (o JobCancelled) si falla.
+void transcodeFile(const std::string& inputPath,
+                   const std::string& outputPath,
+                   const TranscodeOptions& options,
+                   std::function<void(int)> progressCallback,
+                   JobControl* control = nullptr,
+                   PipelineStatsCallback statsCallback = nullptr,
+                   TranscodeMetrics* metrics = nullptr);
+
+// Piezas de transcodeFile que comparte la codificación por trozos
+// (chunked_transcoder) para producir exactamente la misma salida.
+VideoEncoderConfig videoEncoderConfigFor(AVFormatContext* input,
+                                         AVStream* stream,
+                                         const AVCodecContext* decoder,
+                                         const TranscodePlan& plan,
+                                         const TranscodeOptions& options,
+                                         bool globalHeader);
+AudioEncoderConfig audioEncoderConfigFor(const TranscodePlan& plan, const TranscodeOptions& options,
+                                         bool globalHeader);
+// Abre la salida y escribe la cabecera con las opciones de cada contenedor
+// (faststart, fragmentos o segmentos HLS)
+void writeTranscodeHeader(AVFormatContext* output, const TranscodePlan& plan, const std::string& outputPath);
+
+} // namespace StreamVio
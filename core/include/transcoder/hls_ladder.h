@@ -0,0 +1,47 @@
+// StreamVio/core/include/transcoder/hls_ladder.h
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "utils/job_control.h"
+
+namespace StreamVio {
+
+struct HlsRendition {
+    int width = 0;
+    int height = 0;
+    int bitrateKbps = 0;
+    int maxBitrateKbps = 0;
+    int bufsizeKbps = 0;
+};
+
+struct HlsLadderOptions {
+    std::vector<HlsRendition> renditions;   // Vacío = generar con buildHlsLadder
+    int maxHeight = 1080;
+    int maxBitrateKbps = 8000;              // Límite por calidad (MAX_BITRATE del servidor)
+    int segmentDuration = 2;                // En segundos
+    int audioBitrateKbps = 128;
+    std::string videoCodec = "libx264";
+    std::string preset = "fast";
+    int threads = 0;                        // Hilos totales de codificación, 0 = núcleos disponibles
+};
+
+// Genera la escalera de calidades igual que generateHLSQualities en
+// transcoderInterface.js (360p, 480p, 720p, 1080p hasta maxHeight).
+std::vector<HlsRendition> buildHlsLadder(int sourceWidth, int sourceHeight,
+                                         int maxHeight, int maxBitrateKbps);
+
+// Decodifica la entrada una sola vez, escala cada frame a todas las
+// calidades y las codifica en paralelo, escribiendo en `outputDir`
+// los segmentos (segment_<n>_<i>.ts), las playlists (stream_<n>.m3u8)
+// y master.m3u8. Si se indica `control`, se consulta en cada paquete
+// leído. Lanza std::runtime_error (o JobCancelled) si falla.
+void encodeHlsLadder(const std::string& inputPath,
+                     const std::string& outputDir,
+                     const HlsLadderOptions& options,
+                     std::function<void(int)> progressCallback,
+                     JobControl* control = nullptr);
+
+} // namespace StreamVio
@@ -0,0 +1,113 @@
+// StreamVio/core/include/transcoder/jit_segmenter.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analyzer/keyframe_index.h"
+#include "transcoder/hls_ladder.h"
+
+namespace StreamVio {
+
+struct JitHlsOptions {
+    int segmentDuration = 4;        // En segundos
+    int prefetchSegments = 3;       // Segmentos a preparar por delante del último pedido
+    int maxHeight = 720;
+    int maxBitrateKbps = 8000;
+    int audioBitrateKbps = 128;
+    std::string videoCodec = "libx264";
+    std::string preset = "veryfast";
+    int threads = 0;                // 0 = automático
+};
+
+// Petición de segmento abandonada porque el espectador ya pidió otro fuera
+// de la sesión actual (un salto): solo la última petición puede reiniciarla
+class SegmentSuperseded : public std::runtime_error {
+public:
+    explicit SegmentSuperseded(int index)
+        : std::runtime_error("Segmento " + std::to_string(index) + " sustituido por una petición posterior") {}
+};
+
+// Segmentador HLS bajo demanda: publica la playlist VOD completa al
+// instante (a partir de la duración analizada) y transcodifica cada
+// segmento solo cuando se pide.
+//
+// Una sesión de transcodificación avanza desde el segmento pedido,
+// preparando hasta `prefetchSegments` segmentos por delante, y se pausa
+// cuando va demasiado adelantada. Si el espectador salta fuera de esa
+// ventana la sesión se cancela y se inicia otra en el nuevo punto,
+// buscando el keyframe anterior más cercano.
+class JitHlsSegmenter {
+public:
+    // Lanza std::runtime_error si la entrada no se puede analizar
+    JitHlsSegmenter(const std::string& inputPath,
+                    const std::string& outputDir,
+                    const JitHlsOptions& options);
+    ~JitHlsSegmenter();
+
+    JitHlsSegmenter(const JitHlsSegmenter&) = delete;
+    JitHlsSegmenter& operator=(const JitHlsSegmenter&) = delete;
+
+    // Escribe playlist.m3u8 con todos los segmentos y devuelve su ruta
+    std::string writePlaylist() const;
+
+    int segmentCount() const { return static_cast<int>(segmentReady.size()); }
+    std::string segmentPath(int index) const;
+
+    // Bloquea hasta que el segmento esté en disco y devuelve su ruta.
+    // Lanza SegmentSuperseded si el segmento queda fuera de la sesión y
+    // hay una petición más reciente, y std::runtime_error si el índice no
+    // existe o la sesión falla.
+    std::string requestSegment(int index);
+
+private:
+    struct Session {
+        int startSegment = 0;
+        int currentSegment = 0;
+        std::atomic<bool> cancelled{false};
+        bool finished = false;
+        std::string error;
+        std::thread thread;
+    };
+
+    void startSession(int startSegment);
+    void stopSession(std::unique_lock<std::mutex>& lock);
+    void runSession(Session& session);
+    bool sessionCovers(int index) const;
+
+    // Llamadas desde el hilo de la sesión
+    void markReady(Session& session, int index);
+    bool waitForDemand(Session& session, int nextIndex);
+
+    std::string inputPath;
+    std::string outputDir;
+    JitHlsOptions options;
+    HlsRendition rendition;
+    long durationMs = 0;
+    std::unique_ptr<KeyframeIndex> keyframes;   // Solo lectura, compartido por las sesiones
+
+    mutable std::mutex mutex;
+    std::condition_variable stateChanged;
+    std::vector<bool> segmentReady;
+    int lastRequested = 0;
+    std::unique_ptr<Session> session;
+};
+
+// Publica la playlist y atiende peticiones de segmentos leídas de
+// `requests` (un índice por línea), respondiendo en `events` con un
+// objeto JSON por línea ("segment", "superseded" o "error"). Lanza
+// std::runtime_error si la entrada no es válida.
+void serveJitHls(const std::string& inputPath,
+                 const std::string& outputDir,
+                 const JitHlsOptions& options,
+                 std::istream& requests,
+                 std::ostream& events);
+
+} // namespace StreamVio
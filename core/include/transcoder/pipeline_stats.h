@@ -0,0 +1,24 @@
+// StreamVio/core/include/transcoder/pipeline_stats.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace StreamVio {
+
+// Estado de un enlace entre dos etapas del pipeline de transcodificación
+struct PipelineQueueStats {
+    std::string name;               // "<productor>-><consumidor>"
+    size_t capacity = 0;            // Elementos que pueden estar en vuelo
+    size_t depth = 0;               // Elementos en vuelo ahora mismo
+    size_t maxDepth = 0;            // Máximo de elementos esperando en la cola
+    uint64_t producerWaits = 0;     // Contrapresión: el productor esperó por hueco
+    uint64_t consumerWaits = 0;     // El consumidor esperó por datos
+};
+
+using PipelineStatsCallback = std::function<void(const std::vector<PipelineQueueStats>&)>;
+
+} // namespace StreamVio
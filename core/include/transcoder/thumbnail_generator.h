@@ -0,0 +1,70 @@
+// StreamVio/core/include/transcoder/thumbnail_generator.h
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "utils/job_control.h"
+
+struct AVFrame;
+
+namespace StreamVio {
+
+struct TrickplayOptions {
+    bool poster = true;             // Generar poster.jpg
+    bool sprites = true;            // Generar sprites + thumbnails.vtt
+    int posterOffsetMs = -1;        // -1 = 10% de la duración
+    int posterWidth = 320;
+    int posterHeight = 0;           // 0 = mantener relación de aspecto
+    int intervalSeconds = 10;       // Separación entre miniaturas del sprite
+    int tileWidth = 160;
+    int tileHeight = 0;             // 0 = mantener relación de aspecto
+    int columns = 10;
+    int rows = 10;
+    int jpegQuality = 4;            // qscale de MJPEG: 2 (mejor) a 31 (peor)
+    int decoderThreads = 0;         // 0 = automático
+    bool analyze = true;            // Analizar los keyframes (negros, cortes, pHash); con sprites, guardar el sidecar .svfa
+};
+
+struct TrickplayResult {
+    std::string posterPath;
+    std::vector<std::string> spritePaths;
+    std::string vttPath;
+    int tiles = 0;
+};
+
+// Recorre el archivo una sola vez decodificando únicamente keyframes
+// (sin filtro de bucle) y genera el poster, las hojas de sprites y el
+// WebVTT que las describe. Con `analyze`, los keyframes cercanos al poster
+// se analizan para no usar un negro o un fundido; si se generan sprites se
+// analizan todos y el resultado se guarda en frameAnalysisPath() (sin
+// sprites la pasada no recorre el archivo entero y no se guarda nada). Si se
+// indica `control`, se consulta en cada keyframe. Lanza std::runtime_error (o JobCancelled) si falla.
+TrickplayResult generateTrickplay(const std::string& inputPath,
+                                  const std::string& outputDir,
+                                  const TrickplayOptions& options,
+                                  JobControl* control = nullptr);
+
+// Genera una imagen del keyframe más cercano a `timeOffsetMs` o, si hay
+// análisis de un trickplay anterior y ese keyframe es negro o plano, del
+// mejor keyframe cercano. Lanza std::runtime_error si falla.
+void generatePoster(const std::string& inputPath,
+                    const std::string& outputPath,
+                    int timeOffsetMs,
+                    int width,
+                    int height);
+
+// Procesa líneas "<entrada>\t<directorio>" en un pool de hilos y escribe
+// un resultado NDJSON por archivo. Devuelve el número de fallos.
+size_t generateTrickplayMany(std::istream& input,
+                             std::ostream& output,
+                             size_t threads,
+                             const TrickplayOptions& options);
+
+// Codifica un frame como JPEG (o PNG si la ruta termina en .png).
+// Lanza std::runtime_error si falla.
+void writeImageFile(const AVFrame* frame, const std::string& path, int jpegQuality);
+
+} // namespace StreamVio
@@ -0,0 +1,156 @@
+// StreamVio/core/include/transcoder/transcode_metrics.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "transcoder/pipeline_stats.h"
+
+namespace StreamVio {
+
+// Etapas instrumentadas de una transcodificación. Con el pipeline activo
+// decode, scale, encode y mux corren cada una en su hilo; demux y audio
+// van en el hilo que llama.
+enum class TranscodeStage {
+    Demux,      // av_read_frame
+    Decode,     // Envío y recepción en el decodificador de video
+    Scale,      // Conversión de tamaño y formato de píxel
+    Encode,     // Codificador de video (sin contar la espera por el muxer)
+    Audio,      // Decodificación, remuestreo y codificación de audio
+    Mux         // av_interleaved_write_frame
+};
+
+const size_t kTranscodeStageCount = 6;
+
+const char* toString(TranscodeStage stage);
+
+inline int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Histograma de latencias con cubetas de potencias de dos desde 1 µs; la
+// última (~8 s) recoge todo lo mayor. Se actualiza sin bloqueos desde
+// cualquier hilo.
+class LatencyHistogram {
+public:
+    static const size_t kBuckets = 24;
+
+    // Límite superior (inclusive) de la cubeta, en nanosegundos
+    static int64_t upperBoundNs(size_t bucket) { return int64_t(1000) << bucket; }
+
+    struct Snapshot {
+        uint64_t counts[kBuckets] = {};
+        uint64_t count = 0;
+        int64_t sumNs = 0;
+
+        // Límite superior de la cubeta que contiene el percentil (0-1)
+        int64_t percentileNs(double fraction) const;
+    };
+
+    void record(int64_t ns);
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<uint64_t> counts[kBuckets] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> sumNs{0};
+};
+
+struct StageMetrics {
+    std::string name;
+    double busySeconds = 0;     // Tiempo de trabajo acumulado (sin esperas en colas)
+    LatencyHistogram::Snapshot latency;  // Una muestra por paquete o frame
+};
+
+struct TranscodeMetricsSnapshot {
+    double elapsedSeconds = 0;
+    uint64_t frames = 0;        // Frames de video codificados (o copiados en un remux)
+    uint64_t bytesIn = 0;       // Bytes de paquetes demuxados
+    uint64_t bytesOut = 0;      // Bytes de paquetes escritos en la salida
+    int64_t mediaTimeUs = 0;    // Posición demuxada desde el inicio del archivo
+    double fps = 0;
+    double speed = 0;           // Segundos de contenido por segundo real
+    std::vector<StageMetrics> stages;
+    std::vector<PipelineQueueStats> queues;  // Vacío si no hay pipeline
+};
+
+// Contadores de un trabajo. Las etapas los actualizan desde sus hilos y
+// cualquier otro hilo puede tomar una instantánea. Si se indica `aggregate`,
+// cada registro se suma también ahí (totales del proceso).
+class TranscodeMetrics {
+public:
+    explicit TranscodeMetrics(TranscodeMetrics* aggregate = nullptr);
+
+    TranscodeMetrics(const TranscodeMetrics&) = delete;
+    TranscodeMetrics& operator=(const TranscodeMetrics&) = delete;
+
+    void recordStage(TranscodeStage stage, int64_t ns);
+    void addFrames(uint64_t frames);
+    void addBytesIn(uint64_t bytes);
+    void addBytesOut(uint64_t bytes);
+    // Solo del trabajo: no tiene sentido sumarlo entre trabajos
+    void setMediaTime(int64_t us);
+
+    TranscodeMetricsSnapshot snapshot() const;
+
+private:
+    struct Stage {
+        std::atomic<int64_t> busyNs{0};
+        LatencyHistogram latency;
+    };
+
+    TranscodeMetrics* aggregate;
+    std::chrono::steady_clock::time_point started;
+    Stage stages[kTranscodeStageCount];
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::atomic<int64_t> mediaTimeUs{0};
+};
+
+// Mide el bloque en el que vive y lo registra al salir. Sin métricas no
+// lee el reloj.
+class StageTimer {
+public:
+    StageTimer(TranscodeMetrics* metrics, TranscodeStage stage)
+        : metrics(metrics), stage(stage), start(metrics ? monotonicNs() : 0) {}
+    ~StageTimer() {
+        if (metrics) {
+            metrics->recordStage(stage, monotonicNs() - start);
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    TranscodeMetrics* metrics;
+    TranscodeStage stage;
+    int64_t start;
+};
+
+std::string pipelineStatsToJson(const std::vector<PipelineQueueStats>& stats);
+
+// Objeto JSON de una línea: fps, speed, bytes, etapas (ocupación, p50/p99)
+// y colas
+std::string transcodeMetricsToJson(const TranscodeMetricsSnapshot& snapshot);
+
+// Formato de texto de Prometheus: contadores e histogramas por etapa de
+// `totals` y, por cada trabajo de `jobs` (etiqueta "job"), sus gauges de
+// fps, speed y ocupación de colas
+std::string transcodeMetricsToPrometheus(
+    const TranscodeMetricsSnapshot& totals,
+    const std::vector<std::pair<std::string, TranscodeMetricsSnapshot>>& jobs);
+
+// Sustituye `path` de forma atómica para que quien lo recoja (node_exporter
+// con el textfile collector, por ejemplo) nunca lea un volcado a medias.
+// Lanza std::runtime_error si falla.
+void writeMetricsFile(const std::string& path, const std::string& text);
+
+} // namespace StreamVio
@@ -0,0 +1,114 @@
+// StreamVio/core/include/transcoder/transcode_pipeline.h
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "transcoder/pipeline_stats.h"
+#include "transcoder/transcode_metrics.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/media_pool.h"
+#include "utils/spsc_queue.h"
+
+namespace StreamVio {
+
+// Pipeline de video por etapas, cada una en su hilo:
+//
+//   demux (llamante) -> decode -> scale -> encode -> mux
+//   demux (llamante) ------------------------------> mux   (audio y copias)
+//
+// Las etapas se comunican con colas SPSC sin bloqueo y cada enlace tiene
+// un pool fijo de AVFrame/AVPacket, así que en régimen estacionario no se
+// reservan estructuras por frame. Un pool agotado bloquea a la etapa que
+// lo llena: la contrapresión se propaga hasta el demuxer.
+class TranscodePipeline {
+public:
+    struct Config {
+        // Paquetes comprimidos entre demux y decode. Junto con el retardo
+        // del codificador limita cuánto se adelanta el audio al video
+        // (el muxer entrelaza como mucho ~10 s).
+        size_t packetQueue = 64;
+        size_t frameQueue = 8;      // Frames sin comprimir en cada enlace
+        size_t muxQueue = 128;      // Paquetes hacia el muxer
+        // Si se indica, cada etapa registra su tiempo de trabajo (sin las
+        // esperas en colas y pools), los frames codificados y los bytes
+        // escritos
+        TranscodeMetrics* metrics = nullptr;
+    };
+
+    // Los contextos deben estar abiertos y la cabecera de salida escrita.
+    // El pipeline no es dueño de ninguno de ellos.
+    TranscodePipeline(AVFormatContext* output,
+                      AVCodecContext* decoder,
+                      AVCodecContext* encoder,
+                      int videoOutIndex,
+                      const Config& config);
+    // Si no se llamó a finish(), aborta y espera a los hilos
+    ~TranscodePipeline();
+
+    TranscodePipeline(const TranscodePipeline&) = delete;
+    TranscodePipeline& operator=(const TranscodePipeline&) = delete;
+
+    void start();
+
+    // Llamadas desde el hilo de demuxado. Toman la referencia del paquete
+    // (queda vacío) y bloquean si el pipeline va por detrás.
+    // Lanzan std::runtime_error si alguna etapa ha fallado.
+    void pushVideoPacket(AVPacket* packet);
+    void pushMuxPacket(AVPacket* packet, AVRational sourceTimeBase, int outputIndex);
+
+    // Fin de la entrada: vacía todas las etapas y espera a que terminen.
+    // Después se puede escribir el trailer. Lanza el error de la primera
+    // etapa que haya fallado.
+    void finish();
+
+    std::vector<PipelineQueueStats> stats() const;
+
+private:
+    void runStage(void (TranscodePipeline::*stage)());
+    void decodeStage();
+    // Devuelve los nanosegundos pasados dentro del decodificador
+    int64_t receiveDecodedFrames();
+    void scaleStage();
+    void encodeStage();
+    void muxStage();
+
+    void fail(const std::string& message);
+    void abort();
+    void throwIfFailed();
+    void joinThreads();
+
+    AVFormatContext* output;
+    AVCodecContext* decoder;
+    AVCodecContext* encoder;
+    int videoOutIndex;
+    TranscodeMetrics* metrics;
+
+    PacketPool packetPool;
+    SpscQueue<AVPacket*> packets;
+    FramePool decodedPool;
+    SpscQueue<AVFrame*> decodedFrames;
+    FramePool scaledPool;
+    SpscQueue<AVFrame*> scaledFrames;
+
+    // El muxer espera a la vez en las dos colas de entrada
+    Doorbell muxBell;
+    PacketPool encodedPool;
+    SpscQueue<AVPacket*> encodedPackets;
+    PacketPool auxPool;
+    SpscQueue<AVPacket*> auxPackets;
+
+    SwsContextPtr scaler;
+    FramePtr decoderScratch;
+    PacketPtr encoderScratch;
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> aborted{false};
+    std::mutex errorMutex;
+    std::string error;
+};
+
+} // namespace StreamVio
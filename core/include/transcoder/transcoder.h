@@ -1,10 +1,25 @@
 // StreamVio/core/include/transcoder/transcoder.h
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <list>
 #include <string>
 #include <vector>
 #include <map>
 #include <functional>
+#include <memory>
+#include <mutex>
+
+#include "analyzer/keyframe_index.h"
+#include "transcoder/hls_ladder.h"
+#include "transcoder/jit_segmenter.h"
+#include "transcoder/pipeline_stats.h"
+#include "transcoder/transcode_metrics.h"
+#include "transcoder/thumbnail_generator.h"
+#include "utils/job_control.h"
 
 namespace StreamVio {
 
@@ -17,21 +32,41 @@ struct TranscodeOptions {
     std::string videoCodec;   // Vacío = usar codec por defecto para el formato
     std::string audioCodec;   // Vacío = usar codec por defecto para el formato
     bool enableHardwareAcceleration = true;
+    int threads = 0;          // Hilos de decodificación/codificación, 0 = automático
+    int chunkSeconds = 0;     // >0 = codificar el video en trozos paralelos de ~N s
+    int chunkJobs = 0;        // Trozos simultáneos, 0 = según `threads` o los núcleos
+};
+
+struct ProbeOptions {
+    bool fastMode = false;              // Limita la lectura al analizar el archivo
+    int64_t probeSizeBytes = 1 << 20;   // Bytes máximos a leer en modo rápido
+    int analyzeDurationMs = 1000;       // Duración máxima a analizar en modo rápido
+    bool buildKeyframeIndex = false;    // Generar también el índice de keyframes
 };
 
 struct MediaInfo {
     std::string path;
     std::string format;
-    long duration;        // En milisegundos
-    int width;
-    int height;
+    long duration = 0;        // En milisegundos
+    int bitrate = 0;          // Bitrate global en kbps
+    int width = 0;
+    int height = 0;
+    double frameRate = 0.0;   // Fotogramas por segundo
     std::string videoCodec;
-    int videoBitrate;     // En kbps
+    int videoBitrate = 0;     // En kbps
     std::string audioCodec;
-    int audioBitrate;     // En kbps
-    int audioChannels;
-    int audioSampleRate;  // En Hz
+    int audioBitrate = 0;     // En kbps
+    int audioChannels = 0;
+    int audioSampleRate = 0;  // En Hz
     std::map<std::string, std::string> metadata;
+    std::string keyframeIndex;  // Ruta del índice de keyframes, si se pidió
+};
+
+// Keyframe encontrado en el índice
+struct KeyframeInfo {
+    int64_t timeMs = 0;       // Desde el inicio del archivo
+    int64_t position = -1;    // Offset en bytes, -1 si se desconoce
+    int64_t size = 0;         // Bytes del paquete
 };
 
 class Transcoder {
@@ -42,30 +77,131 @@ public:
     // Inicializa el transcodificador
     bool initialize();
     
-    // Obtiene información de un archivo multimedia
-    MediaInfo getMediaInfo(const std::string& inputPath);
+    // Obtiene información de un archivo multimedia.
+    // Lanza std::runtime_error si el archivo no se puede analizar.
+    MediaInfo getMediaInfo(const std::string& inputPath,
+                           const ProbeOptions& probeOptions = ProbeOptions());
     
-    // Inicia la transcodificación de forma asíncrona
+    // Analiza en paralelo las rutas leídas de `input` (una por línea) y
+    // escribe un resultado NDJSON por archivo. Devuelve el número de fallos.
+    size_t probeMany(std::istream& input,
+                     std::ostream& output,
+                     size_t threads = 0,
+                     const ProbeOptions& probeOptions = ProbeOptions());
+    
+    // Transcodifica en el hilo que llama. Mientras tanto, otros hilos pueden
+    // consultar el progreso o cancelarla con cancelTranscode(outputPath).
+    // `control` permite además pausarla (lo usa el planificador del daemon).
+    // Con options.chunkSeconds > 0 el video se codifica en trozos paralelos
+    // y un trabajo interrumpido se reanuda (ver transcodeFileChunked).
     bool startTranscode(const std::string& inputPath,
                        const std::string& outputPath,
                        const TranscodeOptions& options,
-                       std::function<void(int)> progressCallback);
+                       std::function<void(int)> progressCallback,
+                       std::shared_ptr<JobControl> control = nullptr);
+    
+    // Genera un stream HLS adaptativo (master.m3u8 + una playlist por calidad)
+    // decodificando la entrada una sola vez para todas las calidades.
+    // Se identifica por "<outputDir>/master.m3u8" para progreso y cancelación.
+    bool createHlsStream(const std::string& inputPath,
+                         const std::string& outputDir,
+                         const HlsLadderOptions& options,
+                         std::function<void(int)> progressCallback,
+                         std::shared_ptr<JobControl> control = nullptr);
     
-    // Cancela una transcodificación en curso
+    // Publica una playlist HLS completa al instante y genera cada segmento
+    // bajo demanda según las peticiones leídas de `requests`
+    bool serveHlsOnDemand(const std::string& inputPath,
+                          const std::string& outputDir,
+                          const JitHlsOptions& options,
+                          std::istream& requests,
+                          std::ostream& events);
+    
+    // Pide la cancelación cooperativa de un trabajo en curso.
+    // Devuelve false si no hay ningún trabajo activo con esa salida.
     bool cancelTranscode(const std::string& outputPath);
     
-    // Comprueba el estado de una transcodificación
+    // Comprueba el estado de una transcodificación (-1 si no existe). El de
+    // las completadas se conserva solo para las últimas kFinishedJobRetention.
     int getTranscodeProgress(const std::string& outputPath);
     
-    // Crea una miniatura a partir de un archivo de video
+    // Estado de las colas del pipeline de una transcodificación (vacío si
+    // no existe o si solo se copian paquetes)
+    std::vector<PipelineQueueStats> getPipelineStats(const std::string& outputPath);
+    
+    // Métricas por etapa de una transcodificación en curso o terminada con
+    // éxito (fps, speed, bytes, latencias y colas). False si no existe o si
+    // se hizo por trozos, que no está instrumentada. Como el progreso, las de
+    // las completadas se conservan solo para las últimas kFinishedJobRetention.
+    bool getTranscodeMetrics(const std::string& outputPath, TranscodeMetricsSnapshot& snapshot);
+    
+    // Totales del proceso y gauges de cada transcodificación en curso en
+    // formato de texto de Prometheus
+    std::string prometheusMetrics();
+    
+    // Crea una miniatura a partir del keyframe más cercano a timeOffsetMs
     bool generateThumbnail(const std::string& inputPath,
                           const std::string& outputPath,
                           int timeOffsetMs = 0,
                           int width = 320,
                           int height = 180);
+    
+    // Genera poster, sprites de trickplay y WebVTT en una sola pasada.
+    // Se identifica por `outputDir` para progreso y cancelación.
+    bool generateTrickplay(const std::string& inputPath,
+                           const std::string& outputDir,
+                           const TrickplayOptions& options = {},
+                           std::shared_ptr<JobControl> control = nullptr);
+    
+    // Genera trickplay para muchos archivos ("<entrada>\t<directorio>" por
+    // línea) en paralelo. Devuelve el número de fallos.
+    size_t generateTrickplayMany(std::istream& input,
+                                 std::ostream& output,
+                                 size_t threads = 0,
+                                 const TrickplayOptions& options = {});
+    
+    // Genera (o regenera si está obsoleto) el índice de keyframes del archivo
+    bool buildKeyframeIndex(const std::string& inputPath);
+    
+    // Keyframe más cercano anterior o igual a timeMs del stream de video
+    // (o del primero si no hay video). Usa el índice mapeado en memoria y
+    // lo genera si no existe. Devuelve false si no hay ninguno.
+    bool findKeyframe(const std::string& inputPath, int64_t timeMs, KeyframeInfo& keyframe);
+    
+    // Rango de bytes del archivo que contiene [startMs, endMs)
+    bool getByteRange(const std::string& inputPath, int64_t startMs, int64_t endMs, ByteRange& range);
 private:
+    // Registra un trabajo en curso; nullptr si ya hay otro con la misma clave
+    std::shared_ptr<JobControl> beginJob(const std::string& key, std::shared_ptr<JobControl> control);
+    void setProgress(const std::string& key, int progress);
+    void endJob(const std::string& key, bool succeeded);
+    // Olvida el progreso, las estadísticas y las métricas de un trabajo
+    // (stateMutex tomado)
+    void forgetJob(const std::string& key);
+    // Índice mapeado del archivo; lo genera si falta o está obsoleto
+    std::shared_ptr<const KeyframeIndex> keyframeIndexFor(const std::string& inputPath);
+
     bool initialized;
+    std::mutex stateMutex;
     std::map<std::string, int> progressMap;
+    std::map<std::string, std::vector<PipelineQueueStats>> pipelineStats;
+    std::map<std::string, std::shared_ptr<TranscodeMetrics>> jobMetrics;
+    TranscodeMetrics totalMetrics;
+    std::map<std::string, std::shared_ptr<JobControl>> activeJobs;
+    // Trabajos completados cuyo estado se conserva, del más antiguo al más
+    // reciente; a partir de kFinishedJobRetention se olvidan los primeros
+    static const size_t kFinishedJobRetention = 64;
+    std::deque<std::string> finishedJobs;
+    // Índices mapeados, del usado más recientemente al que menos. Cada uno
+    // retiene un mmap, así que se guardan como mucho kKeyframeIndexCacheSize
+    struct CachedKeyframeIndex {
+        std::string inputPath;
+        std::shared_ptr<const KeyframeIndex> index;
+        uint64_t indexInode = 0;        // Identidad del .svidx mapeado: si otro
+        int64_t indexMtimeNs = 0;       // proceso lo regenera, cambia
+    };
+    static const size_t kKeyframeIndexCacheSize = 32;
+    std::list<CachedKeyframeIndex> keyframeIndexes;
 };
 
 } // namespace StreamVio
\ No newline at end of file
@@ -0,0 +1,51 @@
+// StreamVio/core/include/transcoder/video_encoder.h
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include "utils/ffmpeg_utils.h"
+
+namespace StreamVio {
+
+struct VideoEncoderConfig {
+    std::string codecName = "libx264";   // Si no existe se usa cualquier codificador H.264
+    int width = 0;
+    int height = 0;
+    AVPixelFormat pixelFormat = AV_PIX_FMT_YUV420P;
+    AVRational timeBase{1, 25};
+    AVRational frameRate{25, 1};
+    AVRational sampleAspectRatio{0, 1};
+    int bitrateKbps = 0;                 // 0 = control de calidad del codificador
+    int maxBitrateKbps = 0;
+    int bufsizeKbps = 0;
+    int gopSize = 0;                     // 0 = valor por defecto del codificador
+    std::string profile = "main";
+    std::string preset = "fast";
+    int threads = 0;                     // 0 = automático
+    bool globalHeader = false;           // Necesario para mp4/mkv
+};
+
+// Abre un codificador de video con la configuración indicada.
+// Lanza std::runtime_error si el codificador no está disponible.
+CodecContextPtr openVideoEncoder(const VideoEncoderConfig& config);
+
+// Envía un frame (nullptr vacía el codificador) y entrega cada paquete
+// resultante a `onPacket`. Lanza std::runtime_error si falla.
+template <typename PacketHandler>
+void encodeVideoFrame(AVCodecContext* encoder, const AVFrame* frame, AVPacket* scratch,
+                      PacketHandler&& onPacket) {
+    int ret = avcodec_send_frame(encoder, frame);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al codificar video: " + avErrorToString(ret));
+    }
+    while ((ret = avcodec_receive_packet(encoder, scratch)) >= 0) {
+        onPacket(scratch);
+        av_packet_unref(scratch);
+    }
+    if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al recibir video codificado: " + avErrorToString(ret));
+    }
+}
+
+} // namespace StreamVio
@@ -0,0 +1,89 @@
+// StreamVio/core/include/utils/ffmpeg_utils.h
+#pragma once
+
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavfilter/avfilter.h>
+#include <libavformat/avformat.h>
+#include <libavutil/dict.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+namespace StreamVio {
+
+// Liberadores para usar las estructuras de FFmpeg con std::unique_ptr
+struct InputFormatDeleter {
+    void operator()(AVFormatContext* ctx) const { avformat_close_input(&ctx); }
+};
+
+struct OutputFormatDeleter {
+    void operator()(AVFormatContext* ctx) const {
+        if (ctx->oformat && !(ctx->oformat->flags & AVFMT_NOFILE)) {
+            avio_closep(&ctx->pb);
+        }
+        avformat_free_context(ctx);
+    }
+};
+
+struct CodecContextDeleter {
+    void operator()(AVCodecContext* ctx) const { avcodec_free_context(&ctx); }
+};
+
+struct FrameDeleter {
+    void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+};
+
+struct PacketDeleter {
+    void operator()(AVPacket* packet) const { av_packet_free(&packet); }
+};
+
+struct SwsContextDeleter {
+    void operator()(SwsContext* ctx) const { sws_freeContext(ctx); }
+};
+
+struct FilterGraphDeleter {
+    void operator()(AVFilterGraph* graph) const { avfilter_graph_free(&graph); }
+};
+
+struct DictionaryDeleter {
+    void operator()(AVDictionary* dict) const { av_dict_free(&dict); }
+};
+
+using InputFormatPtr = std::unique_ptr<AVFormatContext, InputFormatDeleter>;
+using OutputFormatPtr = std::unique_ptr<AVFormatContext, OutputFormatDeleter>;
+using CodecContextPtr = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+using PacketPtr = std::unique_ptr<AVPacket, PacketDeleter>;
+using SwsContextPtr = std::unique_ptr<SwsContext, SwsContextDeleter>;
+using FilterGraphPtr = std::unique_ptr<AVFilterGraph, FilterGraphDeleter>;
+
+// Convierte un código de error de FFmpeg en un mensaje legible
+std::string avErrorToString(int errorCode);
+
+// Configura el nivel de log de FFmpeg una sola vez por proceso
+void initializeFFmpeg();
+
+// Abre un archivo de entrada con las opciones indicadas.
+// Lanza std::runtime_error si no se puede abrir.
+InputFormatPtr openInput(const std::string& path, AVDictionary** options = nullptr);
+
+// Abre un decodificador para un stream de entrada.
+// Lanza std::runtime_error si el codec no está disponible.
+CodecContextPtr openDecoder(const AVStream* stream, int threads = 0);
+
+// Crea un contexto de salida para el formato indicado (o deducido de la ruta).
+// Lanza std::runtime_error si el formato no está disponible.
+OutputFormatPtr createOutput(const std::string& path, const std::string& formatName = "");
+
+// Abre el archivo de salida (si el formato lo necesita) y escribe la cabecera.
+// Lanza std::runtime_error si falla.
+void writeOutputHeader(AVFormatContext* ctx, const std::string& path, AVDictionary** options = nullptr);
+
+// Crea un frame con buffers propios del tamaño y formato indicados
+FramePtr allocVideoFrame(int width, int height, AVPixelFormat format);
+
+} // namespace StreamVio
@@ -0,0 +1,46 @@
+// StreamVio/core/include/utils/job_control.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace StreamVio {
+
+// Lanzada desde JobControl::checkpoint() cuando el trabajo se cancela
+class JobCancelled : public std::runtime_error {
+public:
+    JobCancelled() : std::runtime_error("Trabajo cancelado") {}
+};
+
+// Control cooperativo de un trabajo en curso. El bucle de trabajo llama a
+// checkpoint() en cada paquete; otro hilo puede pausar, reanudar o cancelar.
+class JobControl {
+public:
+    void cancel();
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // La pausa libera la CPU: el trabajo queda bloqueado en checkpoint()
+    void pause();
+    void resume();
+    bool isPaused() const { return paused.load(std::memory_order_relaxed); }
+
+    // Bloquea mientras el trabajo esté en pausa.
+    // Lanza JobCancelled si el trabajo se ha cancelado.
+    void checkpoint();
+
+    // Motivo del último fallo, para quien no recibe la excepción
+    void setError(const std::string& message);
+    std::string error() const;
+
+private:
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> paused{false};
+    mutable std::mutex mutex;
+    std::condition_variable stateChanged;
+    std::string errorMessage;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,15 @@
+// StreamVio/core/include/utils/json_reader.h
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace StreamVio {
+
+// Analiza un objeto JSON plano de una línea: {"clave": valor, ...}.
+// Las cadenas se devuelven sin comillas ni escapes; números, true, false
+// y null se devuelven como su texto literal. No admite objetos ni arrays
+// anidados. Lanza std::runtime_error si el documento no es válido.
+std::map<std::string, std::string> parseFlatJsonObject(const std::string& json);
+
+} // namespace StreamVio
@@ -0,0 +1,35 @@
+// StreamVio/core/include/utils/json_writer.h
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace StreamVio {
+
+// Escapa una cadena para incluirla en un documento JSON (sin comillas)
+std::string jsonEscape(const std::string& value);
+
+// Constructor mínimo de objetos JSON de una sola línea (NDJSON)
+class JsonWriter {
+public:
+    JsonWriter& field(const std::string& key, const std::string& value);
+    JsonWriter& field(const std::string& key, const char* value);
+    JsonWriter& field(const std::string& key, int64_t value);
+    JsonWriter& field(const std::string& key, int value);
+    JsonWriter& field(const std::string& key, double value);
+    JsonWriter& field(const std::string& key, bool value);
+    JsonWriter& field(const std::string& key, const std::map<std::string, std::string>& value);
+
+    // Inserta un valor JSON ya serializado (objeto, array...)
+    JsonWriter& raw(const std::string& key, const std::string& json);
+
+    std::string str() const;
+
+private:
+    void appendKey(const std::string& key);
+
+    std::string body;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,64 @@
+// StreamVio/core/include/utils/media_pool.h
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "utils/ffmpeg_utils.h"
+#include "utils/spsc_queue.h"
+
+namespace StreamVio {
+
+// Conjunto fijo de estructuras de FFmpeg reutilizables entre dos etapas de
+// un pipeline: una etapa las obtiene con acquire() y la siguiente las
+// devuelve con release(). Como solo hay un hilo en cada extremo, la lista
+// libre es una SpscQueue y en régimen estacionario no se reserva memoria.
+//
+// El tamaño del pool limita los elementos en vuelo: si se agota,
+// acquire() bloquea, y esa es la contrapresión sobre la etapa productora.
+template <typename T, typename Deleter>
+class MediaPool {
+public:
+    template <typename Factory>
+    MediaPool(size_t size, Factory factory) : freeItems(size) {
+        storage.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            storage.emplace_back(factory());
+            if (!storage.back()) {
+                throw std::bad_alloc();
+            }
+            freeItems.tryPush(storage.back().get());
+        }
+    }
+
+    // Bloquea hasta que haya un elemento libre; nullptr si el pool se cerró
+    T* acquire() {
+        T* item = nullptr;
+        return freeItems.pop(item) ? item : nullptr;
+    }
+
+    // El elemento debe devolverse ya limpio (sin referencias a buffers)
+    // salvo en pools de frames con buffers propios
+    void release(T* item) {
+        freeItems.tryPush(item);
+    }
+
+    // Despierta a quien espere en acquire(); los elementos siguen siendo del pool
+    void close() { freeItems.close(); }
+
+    size_t size() const { return storage.size(); }
+    size_t inUse() const { return storage.size() - freeItems.depth(); }
+    // Veces que acquire() tuvo que esperar porque no quedaba ninguno libre
+    uint64_t exhaustedWaits() const { return freeItems.emptyWaits(); }
+
+private:
+    std::vector<std::unique_ptr<T, Deleter>> storage;
+    SpscQueue<T*> freeItems;
+};
+
+using FramePool = MediaPool<AVFrame, FrameDeleter>;
+using PacketPool = MediaPool<AVPacket, PacketDeleter>;
+
+} // namespace StreamVio
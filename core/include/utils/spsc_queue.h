@@ -0,0 +1,185 @@
+// StreamVio/core/include/utils/spsc_queue.h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace StreamVio {
+
+// Aviso entre hilos para esperas bloqueantes sobre estructuras sin bloqueo.
+// ring() solo toma el mutex si hay alguien esperando, así que en régimen
+// estacionario (colas ni llenas ni vacías) no hay llamadas al sistema.
+class Doorbell {
+public:
+    void ring() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            bell.notify_all();
+        }
+    }
+
+    // Espera hasta que ready() sea true: primero cede el procesador unas
+    // cuantas veces y después se bloquea
+    template <typename Predicate>
+    void wait(Predicate ready) {
+        for (int spin = 0; spin < kSpinCount; ++spin) {
+            if (ready()) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ready()) {
+            bell.wait(lock);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kSpinCount = 64;
+
+    std::atomic<int> waiters{0};
+    std::mutex mutex;
+    std::condition_variable bell;
+};
+
+// Cola circular acotada sin bloqueo para exactamente un productor y un
+// consumidor. T debe ser trivialmente copiable (típicamente un puntero).
+//
+// push() bloquea cuando está llena (contrapresión sobre el productor) y
+// pop() cuando está vacía. Tras close() pop() entrega lo pendiente y luego
+// devuelve false. El consumidor puede compartir su Doorbell con otras colas
+// para esperar a la vez en varias con Doorbell::wait().
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue requiere tipos trivialmente copiables");
+
+public:
+    // La capacidad se redondea a la siguiente potencia de dos
+    explicit SpscQueue(size_t capacity, Doorbell* consumerBell = nullptr)
+        : slots(roundUpPowerOfTwo(capacity)), mask(slots.size() - 1),
+          dataBell(consumerBell ? consumerBell : &ownDataBell) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool tryPush(T item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= slots.size()) {
+            return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+
+        size_t depth = t + 1 - head.load(std::memory_order_relaxed);
+        if (depth > maxDepthSeen.load(std::memory_order_relaxed)) {
+            maxDepthSeen.store(depth, std::memory_order_relaxed);
+        }
+        dataBell->ring();
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        spaceBell.ring();
+        return true;
+    }
+
+    // Devuelve false si la cola se cerró antes de poder insertar
+    bool push(T item) {
+        if (tryPush(item)) {
+            return true;
+        }
+        fullWaitCount.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            spaceBell.wait([this] { return isClosed() || !full(); });
+            if (isClosed()) {
+                return false;
+            }
+            if (tryPush(item)) {
+                return true;
+            }
+        }
+    }
+
+    // Devuelve false cuando la cola está cerrada y vacía
+    bool pop(T& item) {
+        if (tryPop(item)) {
+            return true;
+        }
+        emptyWaitCount.fetch_add(1, std::memory_order_relaxed);
+        while (true) {
+            dataBell->wait([this] { return isClosed() || !empty(); });
+            if (tryPop(item)) {
+                return true;
+            }
+            if (drained()) {
+                return false;
+            }
+        }
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+        dataBell->ring();
+        spaceBell.ring();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+    bool empty() const { return depth() == 0; }
+    bool full() const { return depth() >= slots.size(); }
+    // Cerrada y sin elementos pendientes
+    bool drained() const { return isClosed() && empty(); }
+
+    size_t capacity() const { return slots.size(); }
+    size_t depth() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    size_t maxDepth() const { return maxDepthSeen.load(std::memory_order_relaxed); }
+    // Veces que el productor tuvo que esperar por falta de hueco
+    uint64_t fullWaits() const { return fullWaitCount.load(std::memory_order_relaxed); }
+    // Veces que el consumidor tuvo que esperar por falta de datos
+    uint64_t emptyWaits() const { return emptyWaitCount.load(std::memory_order_relaxed); }
+
+private:
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<T> slots;
+    size_t mask;
+
+    // Índices crecientes (no se reinician): depth = tail - head
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<bool> closed{false};
+
+    std::atomic<size_t> maxDepthSeen{0};
+    std::atomic<uint64_t> fullWaitCount{0};
+    std::atomic<uint64_t> emptyWaitCount{0};
+
+    Doorbell ownDataBell;
+    Doorbell* dataBell;
+    Doorbell spaceBell;
+};
+
+} // namespace StreamVio
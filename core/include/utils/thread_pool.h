@@ -0,0 +1,50 @@
+// StreamVio/core/include/utils/thread_pool.h
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace StreamVio {
+
+// Pool de hilos de tamaño fijo con cola acotada.
+// submit() bloquea cuando la cola está llena para aplicar contrapresión
+// sobre el productor (por ejemplo, al leer rutas de stdin).
+class ThreadPool {
+public:
+    // threads = 0 usa el número de núcleos disponibles
+    explicit ThreadPool(size_t threads = 0, size_t maxQueued = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Espera a que la cola esté vacía y no haya tareas en ejecución
+    void waitIdle();
+
+    size_t size() const { return workers.size(); }
+
+    static size_t defaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    size_t maxQueued;
+    size_t activeTasks = 0;
+    bool stopping = false;
+
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable spaceAvailable;
+    std::condition_variable idle;
+};
+
+} // namespace StreamVio
@@ -0,0 +1,436 @@
+// StreamVio/core/src/analyzer/frame_analysis.cpp
+#include "analyzer/frame_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+#include "analyzer/frame_kernels.h"
+#include "analyzer/keyframe_index.h"
+
+namespace StreamVio {
+
+namespace {
+
+const char kMagic[8] = {'S', 'V', 'F', 'R', 'A', 'M', 'E', '\0'};
+
+// Umbral de negro sobre la luma: algo por encima del negro nominal para
+// absorber ruido y compresión (16 en rango limitado, 0 en rango completo)
+constexpr uint8_t kDarkThresholdLimited = 38;
+constexpr uint8_t kDarkThresholdFull = 25;
+
+constexpr double kBlackRatio = 0.98;
+constexpr double kFadeRatio = 0.6;
+constexpr double kFlatStddev = 5.0;
+constexpr double kSceneCutDelta = 0.35;
+
+// Ventana alrededor del instante pedido en la que se busca una miniatura
+constexpr int64_t kThumbnailWindowBeforeUs = 10 * 1000000LL;
+constexpr int64_t kThumbnailWindowAfterUs = 60 * 1000000LL;
+
+bool statSource(const std::string& path, uint64_t& size, int64_t& mtimeNs) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+// Luma de 8 bits en su propio plano y con un byte por píxel: YUV planar,
+// NV12/NV21 y gris se leen sin copiar
+bool hasDirectLuma(AVPixelFormat format) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    if (!desc || desc->nb_components == 0) {
+        return false;
+    }
+    if (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL |
+                       AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_BE)) {
+        return false;
+    }
+    const AVComponentDescriptor& luma = desc->comp[0];
+    return luma.plane == 0 && luma.step == 1 && luma.depth == 8 && luma.shift == 0 && luma.offset == 0;
+}
+
+bool isFullRange(const AVFrame* frame) {
+    if (frame->color_range == AVCOL_RANGE_JPEG) {
+        return true;
+    }
+    switch (frame->format) {
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_YUVJ422P:
+        case AV_PIX_FMT_YUVJ444P:
+        case AV_PIX_FMT_YUVJ440P:
+        case AV_PIX_FMT_YUVJ411P:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Histograma de 64 niveles. Se queda en escalar a propósito: con cuatro
+// tablas parciales se evitan las dependencias entre incrementos seguidos
+// del mismo nivel, y una versión SIMD (gather/scatter) no sale más rápida
+void accumulateHistogram(const uint8_t* row, int width, uint32_t (*partial)[64]) {
+    int i = 0;
+    for (; i + 4 <= width; i += 4) {
+        partial[0][row[i] >> 2]++;
+        partial[1][row[i + 1] >> 2]++;
+        partial[2][row[i + 2] >> 2]++;
+        partial[3][row[i + 3] >> 2]++;
+    }
+    for (; i < width; ++i) {
+        partial[0][row[i] >> 2]++;
+    }
+}
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Coeficientes de la DCT-II de 32 puntos para las 8 frecuencias más bajas
+struct DctTable {
+    double coefficients[8][32];
+
+    DctTable() {
+        for (int u = 0; u < 8; ++u) {
+            for (int x = 0; x < 32; ++x) {
+                coefficients[u][x] = std::cos(kPi * (2 * x + 1) * u / 64.0);
+            }
+        }
+    }
+};
+
+// pHash: DCT de la imagen reducida a 32x32 y, de las 8x8 frecuencias más
+// bajas, un bit por coeficiente según quede por encima de la mediana. La
+// componente continua no entra en la mediana para que el brillo medio no
+// la desplace.
+uint64_t perceptualHash(const double (&block)[32][32]) {
+    static const DctTable table;
+
+    double rows[32][8];
+    for (int y = 0; y < 32; ++y) {
+        for (int u = 0; u < 8; ++u) {
+            double value = 0;
+            for (int x = 0; x < 32; ++x) {
+                value += table.coefficients[u][x] * block[y][x];
+            }
+            rows[y][u] = value;
+        }
+    }
+
+    double dct[64];
+    for (int v = 0; v < 8; ++v) {
+        for (int u = 0; u < 8; ++u) {
+            double value = 0;
+            for (int y = 0; y < 32; ++y) {
+                value += table.coefficients[v][y] * rows[y][u];
+            }
+            dct[v * 8 + u] = value;
+        }
+    }
+
+    double sorted[63];
+    std::copy(dct + 1, dct + 64, sorted);
+    std::nth_element(sorted, sorted + 31, sorted + 63);
+    double median = sorted[31];
+
+    uint64_t hash = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (dct[i] > median) {
+            hash |= 1ULL << i;
+        }
+    }
+    return hash;
+}
+
+bool usableForThumbnail(const FrameAnalysisEntry& entry) {
+    return !(entry.flags & (kFrameBlack | kFrameFade | kFrameFlat));
+}
+
+} // namespace
+
+std::string frameAnalysisPath(const std::string& sourcePath) {
+    std::string path = keyframeIndexPath(sourcePath);
+    return path.substr(0, path.size() - std::strlen(".svidx")) + ".svfa";
+}
+
+bool readFrameAnalysis(const std::string& sourcePath, FrameAnalysis& analysis) {
+    std::string path = frameAnalysisPath(sourcePath);
+    std::error_code ec;
+    uint64_t fileSize = std::filesystem::file_size(path, ec);
+    if (ec || fileSize < sizeof(FrameAnalysisHeader)) {
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    FrameAnalysisHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kFrameAnalysisVersion) {
+        return false;
+    }
+
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    if (!statSource(sourcePath, size, mtimeNs) ||
+        size != header.sourceSize || mtimeNs != header.sourceMtimeNs) {
+        return false;
+    }
+
+    // El número de entradas viene del disco: no reservar nada que el
+    // archivo no contenga de verdad
+    if (fileSize != sizeof(FrameAnalysisHeader) +
+                    static_cast<uint64_t>(header.frameCount) * sizeof(FrameAnalysisEntry)) {
+        return false;
+    }
+
+    std::vector<FrameAnalysisEntry> entries(header.frameCount);
+    if (!in.read(reinterpret_cast<char*>(entries.data()),
+                 static_cast<std::streamsize>(entries.size() * sizeof(FrameAnalysisEntry)))) {
+        return false;
+    }
+
+    analysis.header = header;
+    analysis.entries = std::move(entries);
+    return true;
+}
+
+int64_t chooseThumbnailTimeMs(const FrameAnalysis& analysis, int64_t requestedMs) {
+    const auto& entries = analysis.entries;
+    int64_t requestedUs = requestedMs * 1000;
+    auto first = std::lower_bound(entries.begin(), entries.end(), requestedUs,
+                                  [](const FrameAnalysisEntry& entry, int64_t us) {
+                                      return entry.timeUs < us;
+                                  });
+
+    // El keyframe que se usaría de todas formas, si sirve, respeta la petición
+    if (first != entries.end() && usableForThumbnail(*first)) {
+        return first->timeUs / 1000;
+    }
+
+    // Si no, el de más contraste de la ventana, penalizando la distancia
+    const FrameAnalysisEntry* best = nullptr;
+    double bestScore = 0;
+    for (const auto& entry : entries) {
+        int64_t distanceUs = entry.timeUs - requestedUs;
+        if (distanceUs < -kThumbnailWindowBeforeUs || distanceUs > kThumbnailWindowAfterUs ||
+            !usableForThumbnail(entry)) {
+            continue;
+        }
+        double score = entry.stddevLuma / (1.0 + std::abs(static_cast<double>(distanceUs)) / 10000000.0);
+        if (!best || score > bestScore) {
+            best = &entry;
+            bestScore = score;
+        }
+    }
+    return best ? best->timeUs / 1000 : requestedMs;
+}
+
+int hammingDistance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+const uint8_t* FrameAnalyzer::lumaPlane(const AVFrame* frame, int& stride, bool& fullRange) {
+    AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+    if (hasDirectLuma(format)) {
+        stride = frame->linesize[0];
+        fullRange = isFullRange(frame);
+        return frame->data[0];
+    }
+
+    // RGB, alta profundidad de bits, etc.: a gris (rango completo) primero
+    if (!gray || gray->width != frame->width || gray->height != frame->height) {
+        gray = allocVideoFrame(frame->width, frame->height, AV_PIX_FMT_GRAY8);
+    }
+    converter.reset(sws_getCachedContext(converter.release(), frame->width, frame->height, format,
+                                         frame->width, frame->height, AV_PIX_FMT_GRAY8,
+                                         SWS_POINT, nullptr, nullptr, nullptr));
+    if (!converter) {
+        return nullptr;
+    }
+    sws_scale(converter.get(), frame->data, frame->linesize, 0, frame->height,
+              gray->data, gray->linesize);
+    stride = gray->linesize[0];
+    fullRange = true;
+    return gray->data[0];
+}
+
+const FrameAnalysisEntry* FrameAnalyzer::addFrame(const AVFrame* frame, int64_t timeUs) {
+    int width = frame->width;
+    int height = frame->height;
+    int stride = 0;
+    bool fullRange = false;
+    const uint8_t* luma = width > 0 && height > 0 ? lumaPlane(frame, stride, fullRange) : nullptr;
+    if (!luma) {
+        return nullptr;
+    }
+
+    const FrameKernels& kernels = frameKernels();
+    uint8_t darkThreshold = fullRange ? kDarkThresholdFull : kDarkThresholdLimited;
+    LumaStats stats;
+    uint32_t partial[4][kHistogramBins] = {};
+
+    // Reducción a 32x32 para el hash: cada fila se suma sobre las columnas
+    // de su franja y, al terminar la franja, las columnas se agrupan en bloques
+    bool hashable = width >= kHashSize && height >= kHashSize;
+    double block[kHashSize][kHashSize] = {};
+    columnSums.assign(hashable ? width : 0, 0);
+    int band = 0;
+    int bandStart = 0;
+
+    auto flushBand = [&](int bandEnd) {
+        double rowsInBand = bandEnd - bandStart;
+        for (int bx = 0; bx < kHashSize; ++bx) {
+            int x0 = bx * width / kHashSize;
+            int x1 = (bx + 1) * width / kHashSize;
+            uint64_t total = 0;
+            for (int x = x0; x < x1; ++x) {
+                total += columnSums[x];
+            }
+            block[band][bx] = static_cast<double>(total) / (rowsInBand * (x1 - x0));
+        }
+        std::fill(columnSums.begin(), columnSums.end(), 0);
+    };
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = luma + static_cast<ptrdiff_t>(y) * stride;
+        kernels.lumaStats(row, width, darkThreshold, stats);
+        accumulateHistogram(row, width, partial);
+        if (hashable) {
+            kernels.accumulateRow(row, width, columnSums.data());
+            if (y + 1 == (band + 1) * height / kHashSize) {
+                flushBand(y + 1);
+                bandStart = y + 1;
+                band++;
+            }
+        }
+    }
+
+    FrameAnalysisEntry entry{};
+    entry.timeUs = timeUs;
+    entry.perceptualHash = hashable ? perceptualHash(block) : 0;
+
+    double pixels = static_cast<double>(stats.pixels);
+    double mean = stats.sum / pixels;
+    double variance = std::max(stats.sumSquares / pixels - mean * mean, 0.0);
+    double darkRatio = stats.darkPixels / pixels;
+    entry.meanLuma = static_cast<float>(mean);
+    entry.stddevLuma = static_cast<float>(std::sqrt(variance));
+    entry.darkPercent = static_cast<uint8_t>(darkRatio * 100.0 + 0.5);
+
+    uint32_t histogram[kHistogramBins];
+    for (int bin = 0; bin < kHistogramBins; ++bin) {
+        histogram[bin] = partial[0][bin] + partial[1][bin] + partial[2][bin] + partial[3][bin];
+    }
+    if (previousPixels > 0) {
+        // Mitad de la distancia L1 entre histogramas normalizados: 0 a 1
+        double delta = 0;
+        for (int bin = 0; bin < kHistogramBins; ++bin) {
+            delta += std::abs(histogram[bin] / pixels -
+                              previousHistogram[bin] / static_cast<double>(previousPixels));
+        }
+        entry.histogramDelta = static_cast<float>(delta / 2.0);
+    }
+    std::copy(histogram, histogram + kHistogramBins, previousHistogram);
+    previousPixels = stats.pixels;
+
+    if (darkRatio >= kBlackRatio) {
+        entry.flags |= kFrameBlack;
+    } else if (darkRatio >= kFadeRatio) {
+        entry.flags |= kFrameFade;
+    }
+    if (entry.stddevLuma < kFlatStddev) {
+        entry.flags |= kFrameFlat;
+    }
+    if (entry.histogramDelta >= kSceneCutDelta) {
+        entry.flags |= kFrameSceneCut;
+    }
+
+    // Con búsquedas hacia atrás (o B-frames) puede llegar algún keyframe
+    // desordenado: se mantiene el orden por tiempo
+    if (!frames.empty() && frames.back().timeUs >= timeUs) {
+        auto position = std::lower_bound(frames.begin(), frames.end(), timeUs,
+                                         [](const FrameAnalysisEntry& existing, int64_t us) {
+                                             return existing.timeUs < us;
+                                         });
+        if (position != frames.end() && position->timeUs == timeUs) {
+            *position = entry;
+            return &*position;
+        }
+        return &*frames.insert(position, entry);
+    }
+    frames.push_back(entry);
+    return &frames.back();
+}
+
+uint64_t FrameAnalyzer::titleHash() const {
+    // Voto por bit entre los frames con contenido; los negros y planos dan
+    // hashes casi iguales en cualquier título y solo añadirían ruido
+    int votes[64] = {};
+    int voters = 0;
+    for (const auto& entry : frames) {
+        if (!usableForThumbnail(entry) || entry.perceptualHash == 0) {
+            continue;
+        }
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += (entry.perceptualHash >> bit) & 1;
+        }
+        voters++;
+    }
+    if (voters == 0) {
+        return 0;
+    }
+
+    uint64_t hash = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] * 2 > voters) {
+            hash |= 1ULL << bit;
+        }
+    }
+    return hash;
+}
+
+void FrameAnalyzer::write(const std::string& sourcePath, int64_t durationUs) const {
+    FrameAnalysisHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFrameAnalysisVersion;
+    header.frameCount = static_cast<uint32_t>(frames.size());
+    header.durationUs = durationUs;
+    header.titleHash = titleHash();
+    if (!statSource(sourcePath, header.sourceSize, header.sourceMtimeNs)) {
+        throw std::runtime_error("No se pudo acceder a " + sourcePath);
+    }
+
+    std::string path = frameAnalysisPath(sourcePath);
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path());
+    }
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(frames.data()),
+                  static_cast<std::streamsize>(frames.size() * sizeof(FrameAnalysisEntry)));
+        if (!out) {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("No se pudo escribir el análisis " + path);
+        }
+    }
+    std::filesystem::rename(temporaryPath, path);
+}
+
+} // namespace StreamVio
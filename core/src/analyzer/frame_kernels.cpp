@@ -0,0 +1,197 @@
+// StreamVio/core/src/analyzer/frame_kernels.cpp
+#include "analyzer/frame_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STREAMVIO_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace StreamVio {
+
+namespace {
+
+void lumaStatsScalar(const uint8_t* row, int width, uint8_t darkThreshold, LumaStats& stats) {
+    uint64_t sum = 0;
+    uint64_t squares = 0;
+    uint64_t dark = 0;
+    for (int i = 0; i < width; ++i) {
+        uint32_t value = row[i];
+        sum += value;
+        squares += value * value;
+        dark += value <= darkThreshold;
+    }
+    stats.sum += sum;
+    stats.sumSquares += squares;
+    stats.darkPixels += dark;
+    stats.pixels += static_cast<uint64_t>(width);
+}
+
+void accumulateRowScalar(const uint8_t* row, int width, uint32_t* acc) {
+    for (int i = 0; i < width; ++i) {
+        acc[i] += row[i];
+    }
+}
+
+const FrameKernels kScalarKernels{"scalar", lumaStatsScalar, accumulateRowScalar};
+
+#ifdef STREAMVIO_X86_KERNELS
+
+// Los cuadrados se acumulan en carriles de 32 bits: cada iteración suma como
+// mucho 4 * 255² por carril, así que se vuelcan a 64 bits cada este número
+// de iteraciones para no desbordar
+constexpr int kSquareFlushIterations = 4096;
+
+__attribute__((target("sse2")))
+uint64_t sumLanes64(__m128i value) {
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), value);
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("sse2")))
+uint64_t sumLanes32(__m128i value) {
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), value);
+    return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("sse2")))
+void lumaStatsSse2(const uint8_t* row, int width, uint8_t darkThreshold, LumaStats& stats) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i threshold = _mm_set1_epi8(static_cast<char>(darkThreshold));
+    __m128i sum = zero;
+    __m128i dark = zero;
+    uint64_t squares = 0;
+
+    int i = 0;
+    while (i + 16 <= width) {
+        __m128i squareLanes = zero;
+        for (int n = 0; n < kSquareFlushIterations && i + 16 <= width; ++n, i += 16) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            // psadbw contra cero suma los 8 bytes de cada mitad
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(pixels, zero));
+            // p <= t  <=>  max(p - t, 0) == 0 con resta saturada
+            __m128i isDark = _mm_cmpeq_epi8(_mm_subs_epu8(pixels, threshold), zero);
+            dark = _mm_add_epi64(dark, _mm_sad_epu8(_mm_and_si128(isDark, ones), zero));
+            __m128i low = _mm_unpacklo_epi8(pixels, zero);
+            __m128i high = _mm_unpackhi_epi8(pixels, zero);
+            squareLanes = _mm_add_epi32(squareLanes, _mm_add_epi32(_mm_madd_epi16(low, low),
+                                                                   _mm_madd_epi16(high, high)));
+        }
+        squares += sumLanes32(squareLanes);
+    }
+
+    stats.sum += sumLanes64(sum);
+    stats.darkPixels += sumLanes64(dark);
+    stats.sumSquares += squares;
+    stats.pixels += static_cast<uint64_t>(i);
+    lumaStatsScalar(row + i, width - i, darkThreshold, stats);
+}
+
+__attribute__((target("sse2")))
+void accumulateRowSse2(const uint8_t* row, int width, uint32_t* acc) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i low = _mm_unpacklo_epi8(pixels, zero);
+        __m128i high = _mm_unpackhi_epi8(pixels, zero);
+        __m128i parts[4] = {
+            _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+            _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero),
+        };
+        for (int part = 0; part < 4; ++part) {
+            __m128i* target = reinterpret_cast<__m128i*>(acc + i + part * 4);
+            _mm_storeu_si128(target, _mm_add_epi32(_mm_loadu_si128(target), parts[part]));
+        }
+    }
+    accumulateRowScalar(row + i, width - i, acc + i);
+}
+
+__attribute__((target("avx2")))
+void lumaStatsAvx2(const uint8_t* row, int width, uint8_t darkThreshold, LumaStats& stats) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i threshold = _mm256_set1_epi8(static_cast<char>(darkThreshold));
+    __m256i sum = zero;
+    __m256i dark = zero;
+    uint64_t squares = 0;
+
+    int i = 0;
+    while (i + 32 <= width) {
+        __m256i squareLanes = zero;
+        for (int n = 0; n < kSquareFlushIterations && i + 32 <= width; ++n, i += 32) {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            sum = _mm256_add_epi64(sum, _mm256_sad_epu8(pixels, zero));
+            __m256i isDark = _mm256_cmpeq_epi8(_mm256_subs_epu8(pixels, threshold), zero);
+            dark = _mm256_add_epi64(dark, _mm256_sad_epu8(_mm256_and_si256(isDark, ones), zero));
+            // unpack trabaja por mitades de 128 bits; el orden da igual para sumar
+            __m256i low = _mm256_unpacklo_epi8(pixels, zero);
+            __m256i high = _mm256_unpackhi_epi8(pixels, zero);
+            squareLanes = _mm256_add_epi32(squareLanes, _mm256_add_epi32(_mm256_madd_epi16(low, low),
+                                                                         _mm256_madd_epi16(high, high)));
+        }
+        squares += sumLanes32(_mm_add_epi32(_mm256_castsi256_si128(squareLanes),
+                                            _mm256_extracti128_si256(squareLanes, 1)));
+    }
+
+    stats.sum += sumLanes64(_mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)));
+    stats.darkPixels += sumLanes64(_mm_add_epi64(_mm256_castsi256_si128(dark), _mm256_extracti128_si256(dark, 1)));
+    stats.sumSquares += squares;
+    stats.pixels += static_cast<uint64_t>(i);
+    lumaStatsSse2(row + i, width - i, darkThreshold, stats);
+}
+
+__attribute__((target("avx2")))
+void accumulateRowAvx2(const uint8_t* row, int width, uint32_t* acc) {
+    int i = 0;
+    for (; i + 16 <= width; i += 16) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m256i first = _mm256_cvtepu8_epi32(pixels);
+        __m256i second = _mm256_cvtepu8_epi32(_mm_srli_si128(pixels, 8));
+        __m256i* target = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(target, _mm256_add_epi32(_mm256_loadu_si256(target), first));
+        _mm256_storeu_si256(target + 1, _mm256_add_epi32(_mm256_loadu_si256(target + 1), second));
+    }
+    accumulateRowScalar(row + i, width - i, acc + i);
+}
+
+const FrameKernels kSse2Kernels{"sse2", lumaStatsSse2, accumulateRowSse2};
+const FrameKernels kAvx2Kernels{"avx2", lumaStatsAvx2, accumulateRowAvx2};
+
+#endif
+
+const FrameKernels& selectKernels() {
+    const char* forced = std::getenv("STREAMVIO_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) {
+        return kScalarKernels;
+    }
+#ifdef STREAMVIO_X86_KERNELS
+    __builtin_cpu_init();
+    bool onlySse2 = forced && std::strcmp(forced, "sse2") == 0;
+    if (!onlySse2 && __builtin_cpu_supports("avx2")) {
+        return kAvx2Kernels;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return kSse2Kernels;
+    }
+#endif
+    return kScalarKernels;
+}
+
+} // namespace
+
+const FrameKernels& frameKernels() {
+    static const FrameKernels& selected = selectKernels();
+    return selected;
+}
+
+const FrameKernels& scalarFrameKernels() {
+    return kScalarKernels;
+}
+
+} // namespace StreamVio
@@ -0,0 +1,386 @@
+// StreamVio/core/src/analyzer/keyframe_index.cpp
+#include "analyzer/keyframe_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/ffmpeg_utils.h"
+
+namespace StreamVio {
+
+namespace {
+
+const char kMagic[8] = {'S', 'V', 'K', 'F', 'I', 'D', 'X', '\0'};
+
+struct SourceStat {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+};
+
+bool statSource(const std::string& path, SourceStat& result) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    result.size = static_cast<uint64_t>(st.st_size);
+    result.mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+uint64_t fnv1a(const std::string& value) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool indexable(const AVStream* stream) {
+    AVMediaType type = stream->codecpar->codec_type;
+    if (type == AVMEDIA_TYPE_VIDEO) {
+        return !(stream->disposition & AV_DISPOSITION_ATTACHED_PIC);
+    }
+    return type == AVMEDIA_TYPE_AUDIO;
+}
+
+// Entradas de un stream mientras se construye el índice
+struct StreamEntries {
+    const AVStream* stream = nullptr;
+    int64_t audioSpacing = 0;   // Separación mínima entre puntos de audio
+    std::vector<KeyframeIndexEntry> entries;
+
+    void add(int64_t pts, int64_t position, int size) {
+        // En audio todos los paquetes son puntos de acceso: basta uno por segundo
+        if (audioSpacing > 0 && !entries.empty() && pts - entries.back().pts < audioSpacing) {
+            return;
+        }
+        KeyframeIndexEntry entry{};
+        entry.pts = pts;
+        entry.position = position;
+        entry.size = size > 0 ? static_cast<uint32_t>(size) : 0;
+        entries.push_back(entry);
+    }
+};
+
+// La tabla de muestras de MP4/MOV está completa en memoria tras abrir el
+// archivo, pero sus marcas son DTS: solo vale si no hay frames reordenados
+bool indexFromContainer(AVFormatContext* input, std::vector<StreamEntries>& streams) {
+    if (!std::strstr(input->iformat->name, "mov")) {
+        return false;
+    }
+    for (const auto& slot : streams) {
+        if (slot.stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && slot.stream->codecpar->video_delay > 0) {
+            return false;
+        }
+        if (avformat_index_get_entries_count(slot.stream) <= 0) {
+            return false;
+        }
+    }
+
+    for (auto& slot : streams) {
+        AVStream* stream = input->streams[slot.stream->index];
+        int count = avformat_index_get_entries_count(stream);
+        for (int i = 0; i < count; ++i) {
+            const AVIndexEntry* entry = avformat_index_get_entry(stream, i);
+            if (entry && (entry->flags & AVINDEX_KEYFRAME)) {
+                slot.add(entry->timestamp, entry->pos, entry->size);
+            }
+        }
+    }
+    return true;
+}
+
+void indexFromPackets(AVFormatContext* input, std::vector<StreamEntries>& streams) {
+    std::vector<int> slotByStream(input->nb_streams, -1);
+    for (size_t i = 0; i < streams.size(); ++i) {
+        slotByStream[streams[i].stream->index] = static_cast<int>(i);
+    }
+    // El demuxer puede saltarse los paquetes que no interesan
+    for (unsigned i = 0; i < input->nb_streams; ++i) {
+        if (slotByStream[i] < 0) {
+            input->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    PacketPtr packet(av_packet_alloc());
+    int ret;
+    while ((ret = av_read_frame(input, packet.get())) >= 0) {
+        int slot = packet->stream_index < static_cast<int>(slotByStream.size())
+            ? slotByStream[packet->stream_index]
+            : -1;
+        int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+        if (slot >= 0 && (packet->flags & AV_PKT_FLAG_KEY) && pts != AV_NOPTS_VALUE) {
+            streams[slot].add(pts, packet->pos, packet->size);
+        }
+        av_packet_unref(packet.get());
+    }
+    if (ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al leer " + std::string(input->url) + ": " + avErrorToString(ret));
+    }
+}
+
+} // namespace
+
+std::string keyframeIndexPath(const std::string& sourcePath) {
+    const char* directory = std::getenv("STREAMVIO_INDEX_DIR");
+    if (!directory || !*directory) {
+        return sourcePath + ".svidx";
+    }
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(sourcePath, ec);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.svidx",
+                  static_cast<unsigned long long>(fnv1a(ec ? sourcePath : absolute.string())));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+void writeKeyframeIndex(AVFormatContext* input, const std::string& sourcePath, const std::string& indexPath) {
+    SourceStat source;
+    if (!statSource(sourcePath, source)) {
+        throw std::runtime_error("No se puede leer " + sourcePath);
+    }
+
+    std::vector<StreamEntries> streams;
+    for (unsigned i = 0; i < input->nb_streams; ++i) {
+        const AVStream* stream = input->streams[i];
+        if (!indexable(stream) || stream->time_base.num <= 0 || stream->time_base.den <= 0) {
+            continue;
+        }
+        StreamEntries slot;
+        slot.stream = stream;
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+            slot.audioSpacing = av_rescale_q(1, AVRational{1, 1}, stream->time_base);
+        }
+        streams.push_back(std::move(slot));
+    }
+    if (streams.empty()) {
+        throw std::runtime_error("No hay streams que indexar en " + sourcePath);
+    }
+
+    if (!indexFromContainer(input, streams)) {
+        indexFromPackets(input, streams);
+    }
+
+    KeyframeIndexHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kKeyframeIndexVersion;
+    header.streamCount = static_cast<uint32_t>(streams.size());
+    header.sourceSize = source.size;
+    header.sourceMtimeNs = source.mtimeNs;
+    header.startTimeUs = input->start_time != AV_NOPTS_VALUE ? input->start_time : 0;
+    header.durationUs = input->duration != AV_NOPTS_VALUE ? input->duration : 0;
+
+    std::vector<KeyframeIndexStream> descriptors;
+    uint64_t nextEntry = 0;
+    for (auto& slot : streams) {
+        // Los paquetes llegan en orden de decodificación; la búsqueda es por pts
+        std::sort(slot.entries.begin(), slot.entries.end(),
+                  [](const KeyframeIndexEntry& a, const KeyframeIndexEntry& b) { return a.pts < b.pts; });
+        slot.entries.erase(std::unique(slot.entries.begin(), slot.entries.end(),
+                                       [](const KeyframeIndexEntry& a, const KeyframeIndexEntry& b) {
+                                           return a.pts == b.pts;
+                                       }),
+                           slot.entries.end());
+
+        KeyframeIndexStream descriptor{};
+        descriptor.streamIndex = slot.stream->index;
+        descriptor.mediaType = slot.stream->codecpar->codec_type;
+        descriptor.timeBaseNum = slot.stream->time_base.num;
+        descriptor.timeBaseDen = slot.stream->time_base.den;
+        descriptor.firstEntry = nextEntry;
+        descriptor.entryCount = slot.entries.size();
+        nextEntry += slot.entries.size();
+        descriptors.push_back(descriptor);
+    }
+    header.totalSize = sizeof(KeyframeIndexHeader) +
+                       descriptors.size() * sizeof(KeyframeIndexStream) +
+                       nextEntry * sizeof(KeyframeIndexEntry);
+
+    std::filesystem::path target(indexPath);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path());
+    }
+    std::string temporaryPath = indexPath + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(descriptors.data()),
+                  static_cast<std::streamsize>(descriptors.size() * sizeof(KeyframeIndexStream)));
+        for (const auto& slot : streams) {
+            out.write(reinterpret_cast<const char*>(slot.entries.data()),
+                      static_cast<std::streamsize>(slot.entries.size() * sizeof(KeyframeIndexEntry)));
+        }
+        if (!out) {
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("No se pudo escribir el índice " + indexPath);
+        }
+    }
+    std::filesystem::rename(temporaryPath, indexPath);
+}
+
+std::string buildKeyframeIndex(const std::string& sourcePath) {
+    initializeFFmpeg();
+
+    InputFormatPtr input = openInput(sourcePath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + sourcePath + ": " + avErrorToString(ret));
+    }
+
+    std::string indexPath = keyframeIndexPath(sourcePath);
+    writeKeyframeIndex(input.get(), sourcePath, indexPath);
+    return indexPath;
+}
+
+int seekToKeyframe(AVFormatContext* input, int streamIndex, const KeyframeIndexEntry& keyframe) {
+    if (keyframe.position >= 0 && (input->iformat->flags & AVFMT_TS_DISCONT) &&
+        !(input->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+        return avformat_seek_file(input, -1, keyframe.position, keyframe.position, keyframe.position,
+                                  AVSEEK_FLAG_BYTE);
+    }
+    return avformat_seek_file(input, streamIndex, INT64_MIN, keyframe.pts, keyframe.pts, 0);
+}
+
+std::unique_ptr<KeyframeIndex> KeyframeIndex::open(const std::string& indexPath, const std::string& sourcePath) {
+    int fd = ::open(indexPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(KeyframeIndexHeader))) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::unique_ptr<KeyframeIndex> index(new KeyframeIndex(data, size));
+    const KeyframeIndexHeader& header = index->header();
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kKeyframeIndexVersion ||
+        header.totalSize != size) {
+        return nullptr;
+    }
+
+    // Comprobar los límites una vez para que las consultas no tengan que hacerlo
+    uint64_t tableEnd = sizeof(KeyframeIndexHeader) +
+                        static_cast<uint64_t>(header.streamCount) * sizeof(KeyframeIndexStream);
+    if (tableEnd > size || (size - tableEnd) % sizeof(KeyframeIndexEntry) != 0) {
+        return nullptr;
+    }
+    uint64_t totalEntries = (size - tableEnd) / sizeof(KeyframeIndexEntry);
+    index->entryData = reinterpret_cast<const KeyframeIndexEntry*>(static_cast<const char*>(data) + tableEnd);
+    for (uint32_t i = 0; i < header.streamCount; ++i) {
+        const KeyframeIndexStream& stream = index->streamData[i];
+        if (stream.timeBaseNum <= 0 || stream.timeBaseDen <= 0 ||
+            stream.firstEntry > totalEntries || stream.entryCount > totalEntries - stream.firstEntry) {
+            return nullptr;
+        }
+    }
+
+    if (!index->matchesSource(sourcePath)) {
+        return nullptr;
+    }
+    return index;
+}
+
+KeyframeIndex::KeyframeIndex(const void* data, size_t size)
+    : mapping(data), mappingSize(size),
+      headerData(static_cast<const KeyframeIndexHeader*>(data)),
+      streamData(reinterpret_cast<const KeyframeIndexStream*>(static_cast<const char*>(data) +
+                                                              sizeof(KeyframeIndexHeader))) {}
+
+KeyframeIndex::~KeyframeIndex() {
+    ::munmap(const_cast<void*>(mapping), mappingSize);
+}
+
+const KeyframeIndexStream* KeyframeIndex::findStream(int streamIndex) const {
+    for (uint32_t i = 0; i < headerData->streamCount; ++i) {
+        if (streamData[i].streamIndex == streamIndex) {
+            return &streamData[i];
+        }
+    }
+    return nullptr;
+}
+
+const KeyframeIndexStream* KeyframeIndex::primaryStream() const {
+    for (uint32_t i = 0; i < headerData->streamCount; ++i) {
+        if (streamData[i].mediaType == AVMEDIA_TYPE_VIDEO) {
+            return &streamData[i];
+        }
+    }
+    return headerData->streamCount > 0 ? &streamData[0] : nullptr;
+}
+
+const KeyframeIndexEntry* KeyframeIndex::keyframeAtOrBefore(const KeyframeIndexStream& stream, int64_t pts) const {
+    const KeyframeIndexEntry* begin = entries(stream);
+    const KeyframeIndexEntry* end = begin + stream.entryCount;
+    const KeyframeIndexEntry* it = std::upper_bound(begin, end, pts,
+        [](int64_t value, const KeyframeIndexEntry& entry) { return value < entry.pts; });
+    return it == begin ? nullptr : it - 1;
+}
+
+const KeyframeIndexEntry* KeyframeIndex::keyframeAtOrAfter(const KeyframeIndexStream& stream, int64_t pts) const {
+    const KeyframeIndexEntry* begin = entries(stream);
+    const KeyframeIndexEntry* end = begin + stream.entryCount;
+    const KeyframeIndexEntry* it = std::lower_bound(begin, end, pts,
+        [](const KeyframeIndexEntry& entry, int64_t value) { return entry.pts < value; });
+    return it == end ? nullptr : it;
+}
+
+bool KeyframeIndex::byteRange(const KeyframeIndexStream& stream, int64_t startPts, int64_t endPts,
+                              ByteRange& range) const {
+    if (stream.entryCount == 0) {
+        return false;
+    }
+    const KeyframeIndexEntry* first = keyframeAtOrBefore(stream, startPts);
+    if (!first) {
+        first = entries(stream);
+    }
+    if (first->position < 0) {
+        return false;
+    }
+    const KeyframeIndexEntry* last = keyframeAtOrAfter(stream, endPts);
+    int64_t end = static_cast<int64_t>(headerData->sourceSize);
+    if (last && last->position >= 0) {
+        end = last->position;
+    }
+    range.offset = first->position;
+    range.length = std::max<int64_t>(0, end - first->position);
+    return true;
+}
+
+int64_t KeyframeIndex::msToPts(const KeyframeIndexStream& stream, int64_t timeMs) const {
+    return av_rescale_q(timeMs * 1000 + headerData->startTimeUs, AVRational{1, AV_TIME_BASE},
+                        AVRational{stream.timeBaseNum, stream.timeBaseDen});
+}
+
+int64_t KeyframeIndex::ptsToMs(const KeyframeIndexStream& stream, int64_t pts) const {
+    int64_t us = av_rescale_q(pts, AVRational{stream.timeBaseNum, stream.timeBaseDen}, AVRational{1, AV_TIME_BASE});
+    return (us - headerData->startTimeUs) / 1000;
+}
+
+bool KeyframeIndex::matchesSource(const std::string& sourcePath) const {
+    SourceStat source;
+    return statSource(sourcePath, source) &&
+           source.size == headerData->sourceSize &&
+           source.mtimeNs == headerData->sourceMtimeNs;
+}
+
+} // namespace StreamVio
@@ -0,0 +1,204 @@
+// StreamVio/core/src/analyzer/media_prober.cpp
+#include "analyzer/media_prober.h"
+
+#include <atomic>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+#include "analyzer/keyframe_index.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/json_writer.h"
+#include "utils/thread_pool.h"
+
+extern "C" {
+#include <libavutil/rational.h>
+}
+
+namespace StreamVio {
+
+namespace {
+
+int toKbps(int64_t bitsPerSecond) {
+    return bitsPerSecond > 0 ? static_cast<int>(bitsPerSecond / 1000) : 0;
+}
+
+long streamDurationMs(const AVStream* stream) {
+    if (stream->duration == AV_NOPTS_VALUE) {
+        return 0;
+    }
+    return static_cast<long>(av_rescale_q(stream->duration, stream->time_base, AVRational{1, 1000}));
+}
+
+} // namespace
+
+MediaInfo probeMedia(const std::string& inputPath, const ProbeOptions& options) {
+    initializeFFmpeg();
+
+    AVDictionary* openOptions = nullptr;
+    if (options.fastMode) {
+        // Limitar cuánto lee avformat_find_stream_info: en contenedores con
+        // índice (mp4, mkv) la cabecera basta para obtener los parámetros
+        av_dict_set_int(&openOptions, "probesize", options.probeSizeBytes, 0);
+        av_dict_set_int(&openOptions, "analyzeduration",
+                        static_cast<int64_t>(options.analyzeDurationMs) * 1000, 0);
+    }
+
+    InputFormatPtr formatCtx;
+    try {
+        formatCtx = openInput(inputPath, &openOptions);
+    } catch (...) {
+        av_dict_free(&openOptions);
+        throw;
+    }
+    av_dict_free(&openOptions);
+
+    int ret = avformat_find_stream_info(formatCtx.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    MediaInfo info;
+    info.path = inputPath;
+    info.format = formatCtx->iformat->name;
+    if (formatCtx->duration != AV_NOPTS_VALUE) {
+        info.duration = static_cast<long>(formatCtx->duration / (AV_TIME_BASE / 1000));
+    }
+    info.bitrate = toKbps(formatCtx->bit_rate);
+
+    int videoIndex = av_find_best_stream(formatCtx.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    int audioIndex = av_find_best_stream(formatCtx.get(), AVMEDIA_TYPE_AUDIO, -1, videoIndex, nullptr, 0);
+
+    if (videoIndex >= 0) {
+        const AVStream* stream = formatCtx->streams[videoIndex];
+        const AVCodecParameters* par = stream->codecpar;
+        info.videoCodec = avcodec_get_name(par->codec_id);
+        info.width = par->width;
+        info.height = par->height;
+        info.videoBitrate = toKbps(par->bit_rate);
+        AVRational rate = stream->avg_frame_rate.num ? stream->avg_frame_rate : stream->r_frame_rate;
+        if (rate.num > 0 && rate.den > 0) {
+            info.frameRate = av_q2d(rate);
+        }
+        if (info.duration == 0) {
+            info.duration = streamDurationMs(stream);
+        }
+    }
+
+    if (audioIndex >= 0) {
+        const AVStream* stream = formatCtx->streams[audioIndex];
+        const AVCodecParameters* par = stream->codecpar;
+        info.audioCodec = avcodec_get_name(par->codec_id);
+        info.audioBitrate = toKbps(par->bit_rate);
+        info.audioChannels = par->ch_layout.nb_channels;
+        info.audioSampleRate = par->sample_rate;
+        if (info.duration == 0) {
+            info.duration = streamDurationMs(stream);
+        }
+        const AVDictionaryEntry* language = av_dict_get(stream->metadata, "language", nullptr, 0);
+        if (language) {
+            info.metadata["audio_language"] = language->value;
+        }
+    }
+
+    // Matroska y otros contenedores no guardan el bitrate del video:
+    // se estima a partir del bitrate global
+    if (videoIndex >= 0 && info.videoBitrate == 0 && info.bitrate > info.audioBitrate) {
+        info.videoBitrate = info.bitrate - info.audioBitrate;
+    }
+
+    const AVDictionaryEntry* tag = nullptr;
+    while ((tag = av_dict_get(formatCtx->metadata, "", tag, AV_DICT_IGNORE_SUFFIX))) {
+        info.metadata[tag->key] = tag->value;
+    }
+
+    // El índice se genera con el mismo contexto ya abierto y solo si el
+    // que hay no corresponde al archivo actual
+    if (options.buildKeyframeIndex) {
+        std::string indexPath = keyframeIndexPath(inputPath);
+        if (!KeyframeIndex::open(indexPath, inputPath)) {
+            writeKeyframeIndex(formatCtx.get(), inputPath, indexPath);
+        }
+        info.keyframeIndex = indexPath;
+    }
+
+    return info;
+}
+
+std::string mediaInfoToJson(const MediaInfo& info) {
+    JsonWriter json;
+    json.field("path", info.path)
+        .field("format", info.format)
+        .field("duration", static_cast<int64_t>(info.duration))
+        .field("bitrate", info.bitrate)
+        .field("width", info.width)
+        .field("height", info.height)
+        .field("frameRate", info.frameRate)
+        .field("videoCodec", info.videoCodec)
+        .field("videoBitrate", info.videoBitrate)
+        .field("audioCodec", info.audioCodec)
+        .field("audioBitrate", info.audioBitrate)
+        .field("audioChannels", info.audioChannels)
+        .field("audioSampleRate", info.audioSampleRate)
+        .field("metadata", info.metadata);
+    if (!info.keyframeIndex.empty()) {
+        json.field("keyframeIndex", info.keyframeIndex);
+    }
+    return json.str();
+}
+
+size_t probeMany(std::istream& input,
+                 std::ostream& output,
+                 size_t threads,
+                 const ProbeOptions& options) {
+    std::mutex outputMutex;
+    std::atomic<size_t> failures{0};
+
+    auto emit = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        output << line << '\n';
+        output.flush();
+    };
+
+    {
+        ThreadPool pool(threads);
+        std::string path;
+        int64_t index = 0;
+
+        while (std::getline(input, path)) {
+            if (!path.empty() && path.back() == '\r') {
+                path.pop_back();
+            }
+            if (path.empty()) {
+                continue;
+            }
+
+            int64_t lineIndex = index++;
+            pool.submit([&, path, lineIndex]() {
+                try {
+                    MediaInfo info = probeMedia(path, options);
+                    JsonWriter json;
+                    json.field("index", lineIndex)
+                        .field("ok", true)
+                        .raw("info", mediaInfoToJson(info));
+                    emit(json.str());
+                } catch (const std::exception& e) {
+                    failures++;
+                    JsonWriter json;
+                    json.field("index", lineIndex)
+                        .field("ok", false)
+                        .field("path", path)
+                        .field("error", e.what());
+                    emit(json.str());
+                }
+            });
+        }
+
+        pool.waitIdle();
+    }
+
+    return failures.load();
+}
+
+} // namespace StreamVio
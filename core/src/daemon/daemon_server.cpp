@@ -0,0 +1,459 @@
+// StreamVio/core/src/daemon/daemon_server.cpp
+#include "daemon/daemon_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "analyzer/media_prober.h"
+#include "utils/json_reader.h"
+#include "utils/json_writer.h"
+
+namespace StreamVio {
+
+namespace {
+
+using Request = std::map<std::string, std::string>;
+
+std::string getString(const Request& request, const std::string& key,
+                      const std::string& defaultValue = "") {
+    auto it = request.find(key);
+    return it != request.end() && it->second != "null" ? it->second : defaultValue;
+}
+
+int getInt(const Request& request, const std::string& key, int defaultValue = 0) {
+    std::string value = getString(request, key);
+    if (value.empty()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+bool getBool(const Request& request, const std::string& key) {
+    std::string value = getString(request, key);
+    return value == "true" || value == "1";
+}
+
+// Envía todo el buffer; false si el cliente se ha desconectado
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void appendJobStatus(JsonWriter& json, const JobStatus& status) {
+    json.field("job", status.id)
+        .field("type", status.type)
+        .field("target", status.target)
+        .field("priority", toString(status.priority))
+        .field("state", toString(status.state))
+        .field("cores", status.cores)
+        .field("progress", status.progress);
+    if (!status.error.empty()) {
+        json.field("error", status.error);
+    }
+}
+
+} // namespace
+
+DaemonServer::DaemonServer(Transcoder& transcoder, const DaemonOptions& options)
+    : transcoder(transcoder), options(options), jobs(options.coreBudget) {}
+
+DaemonServer::~DaemonServer() {
+    stop();
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    clientsFinished.wait(lock, [this] { return activeClients == 0; });
+}
+
+void DaemonServer::run() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Ruta de socket demasiado larga: " + options.socketPath);
+    }
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error(std::string("No se pudo crear el socket: ") + std::strerror(errno));
+    }
+
+    // Un socket que quedó de una ejecución anterior impediría el bind
+    ::unlink(options.socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, 16) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listenFd);
+        listenFd = -1;
+        throw std::runtime_error("No se pudo escuchar en " + options.socketPath + ": " + reason);
+    }
+    ::chmod(options.socketPath.c_str(), 0660);
+
+    std::cerr << "Daemon escuchando en " << options.socketPath
+              << " (" << jobs.coreBudget() << " núcleos)" << std::endl;
+    if (!options.metricsFile.empty()) {
+        metricsThread = std::thread(&DaemonServer::metricsLoop, this);
+    }
+
+    while (!stopping) {
+        int clientFd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (!stopping) {
+                std::cerr << "Error en accept: " << std::strerror(errno) << std::endl;
+            }
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clientFds.insert(clientFd);
+        activeClients++;
+        std::thread([this, clientFd]() { serveClient(clientFd); }).detach();
+    }
+
+    ::close(listenFd);
+    listenFd = -1;
+    ::unlink(options.socketPath.c_str());
+    if (metricsThread.joinable()) {
+        metricsThread.join();
+    }
+}
+
+void DaemonServer::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    {
+        // Con el mutex tomado ninguna espera puede perderse el aviso entre
+        // comprobar `stopping` y dormirse
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_all();
+    // shutdown() desbloquea accept() y los recv() de los clientes
+    if (listenFd >= 0) {
+        ::shutdown(listenFd, SHUT_RDWR);
+    }
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    for (int fd : clientFds) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+}
+
+void DaemonServer::serveClient(int clientFd) {
+    std::string buffer;
+    char chunk[4096];
+
+    while (!stopping) {
+        ssize_t n = ::recv(clientFd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(n));
+
+        size_t newline;
+        bool connected = true;
+        while (connected && (newline = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            Request request;
+            try {
+                request = parseFlatJsonObject(line);
+            } catch (const std::exception&) {
+                // handleRequest responde con el error
+            }
+            std::string op = getString(request, "op");
+            if (op == "watch") {
+                connected = watchJob(clientFd, request);
+                continue;
+            }
+            connected = sendAll(clientFd, handleRequest(line) + "\n");
+            // stop() cierra todas las conexiones: primero se envía la respuesta
+            if (op == "shutdown") {
+                stop();
+            }
+        }
+        if (!connected) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clientFds.erase(clientFd);
+    ::close(clientFd);
+    activeClients--;
+    clientsFinished.notify_all();
+}
+
+std::string DaemonServer::handleRequest(const std::string& line) {
+    JsonWriter response;
+    Request request;
+    try {
+        request = parseFlatJsonObject(line);
+    } catch (const std::exception& e) {
+        response.field("ok", false).field("error", e.what());
+        return response.str();
+    }
+
+    std::string id = getString(request, "id");
+    if (!id.empty()) {
+        response.field("id", id);
+    }
+    std::string op = getString(request, "op");
+
+    try {
+        if (op == "ping") {
+            response.field("ok", true)
+                .field("cores", jobs.coreBudget())
+                .field("coresInUse", jobs.coresInUse());
+        } else if (op == "submit") {
+            int64_t jobId = submitJob(request);
+            response.field("ok", true).field("job", jobId);
+        } else if (op == "status") {
+            auto status = jobs.status(getInt(request, "job", -1));
+            if (!status) {
+                response.field("ok", false).field("error", "Trabajo no encontrado");
+            } else {
+                response.field("ok", true);
+                appendJobStatus(response, *status);
+                std::vector<PipelineQueueStats> queues = transcoder.getPipelineStats(status->target);
+                if (!queues.empty()) {
+                    response.raw("queues", pipelineStatsToJson(queues));
+                }
+                TranscodeMetricsSnapshot metrics;
+                if (status->type == "transcode" && transcoder.getTranscodeMetrics(status->target, metrics)) {
+                    response.raw("metrics", transcodeMetricsToJson(metrics));
+                }
+            }
+        } else if (op == "list") {
+            std::string list = "[";
+            for (const auto& status : jobs.list()) {
+                if (list.size() > 1) {
+                    list += ',';
+                }
+                JsonWriter json;
+                appendJobStatus(json, status);
+                list += json.str();
+            }
+            list += ']';
+            response.field("ok", true).raw("jobs", list);
+        } else if (op == "cancel") {
+            bool cancelled = request.count("job")
+                ? jobs.cancel(getInt(request, "job", -1))
+                : transcoder.cancelTranscode(getString(request, "output"));
+            response.field("ok", cancelled);
+            if (!cancelled) {
+                response.field("error", "No hay ningún trabajo activo con ese identificador");
+            }
+        } else if (op == "probe") {
+            ProbeOptions probeOptions;
+            probeOptions.fastMode = getBool(request, "fast");
+            MediaInfo info = transcoder.getMediaInfo(getString(request, "input"), probeOptions);
+            response.field("ok", true).raw("info", mediaInfoToJson(info));
+        } else if (op == "thumbnail") {
+            bool ok = transcoder.generateThumbnail(getString(request, "input"),
+                                                   getString(request, "output"),
+                                                   getInt(request, "time", 0),
+                                                   getInt(request, "width", 320),
+                                                   getInt(request, "height", 180));
+            response.field("ok", ok);
+            if (!ok) {
+                response.field("error", "No se pudo generar la miniatura");
+            }
+        } else if (op == "metrics") {
+            response.field("ok", true).field("text", prometheusMetrics());
+        } else if (op == "shutdown") {
+            // serveClient para el servidor después de enviar esta respuesta
+            response.field("ok", true);
+        } else {
+            response.field("ok", false).field("error", "Operación no reconocida: " + op);
+        }
+    } catch (const std::exception& e) {
+        JsonWriter failure;
+        if (!id.empty()) {
+            failure.field("id", id);
+        }
+        failure.field("ok", false).field("error", e.what());
+        return failure.str();
+    }
+
+    return response.str();
+}
+
+bool DaemonServer::watchJob(int clientFd, const Request& request) {
+    std::string id = getString(request, "id");
+    int64_t jobId = getInt(request, "job", -1);
+    auto interval = std::chrono::milliseconds(std::max(100, getInt(request, "intervalMs", 1000)));
+
+    while (!stopping) {
+        auto status = jobs.status(jobId);
+        JsonWriter event;
+        if (!id.empty()) {
+            event.field("id", id);
+        }
+        if (!status) {
+            event.field("ok", false).field("error", "Trabajo no encontrado");
+            return sendAll(clientFd, event.str() + "\n");
+        }
+
+        bool finished = status->state == JobState::Completed ||
+                        status->state == JobState::Failed ||
+                        status->state == JobState::Cancelled;
+        event.field("event", finished ? "done" : "progress");
+        appendJobStatus(event, *status);
+        TranscodeMetricsSnapshot metrics;
+        if (status->type == "transcode" && transcoder.getTranscodeMetrics(status->target, metrics)) {
+            event.raw("metrics", transcodeMetricsToJson(metrics));
+        }
+        if (!sendAll(clientFd, event.str() + "\n")) {
+            return false;
+        }
+        if (finished) {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait_for(lock, interval, [this] { return stopping.load(); });
+    }
+    return false;
+}
+
+std::string DaemonServer::prometheusMetrics() {
+    std::string text = transcoder.prometheusMetrics();
+
+    std::map<std::string, int> states;
+    for (const auto& status : jobs.list()) {
+        states[toString(status.state)]++;
+    }
+    text += "# HELP streamvio_daemon_jobs Trabajos conocidos por el daemon según su estado\n"
+            "# TYPE streamvio_daemon_jobs gauge\n";
+    for (const auto& state : states) {
+        text += "streamvio_daemon_jobs{state=\"" + state.first + "\"} " + std::to_string(state.second) + "\n";
+    }
+    text += "# HELP streamvio_daemon_cores Presupuesto de núcleos del daemon\n"
+            "# TYPE streamvio_daemon_cores gauge\n"
+            "streamvio_daemon_cores " + std::to_string(jobs.coreBudget()) + "\n"
+            "# HELP streamvio_daemon_cores_in_use Núcleos ocupados por trabajos en curso\n"
+            "# TYPE streamvio_daemon_cores_in_use gauge\n"
+            "streamvio_daemon_cores_in_use " + std::to_string(jobs.coresInUse()) + "\n";
+    return text;
+}
+
+void DaemonServer::metricsLoop() {
+    auto interval = std::chrono::seconds(std::max(1, options.metricsIntervalSeconds));
+    while (true) {
+        try {
+            writeMetricsFile(options.metricsFile, prometheusMetrics());
+        } catch (const std::exception& e) {
+            std::cerr << "Aviso: " << e.what() << std::endl;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (wake.wait_for(lock, interval, [this] { return stopping.load(); })) {
+            return;
+        }
+    }
+}
+
+int64_t DaemonServer::submitJob(const Request& request) {
+    std::string type = getString(request, "type");
+    std::string input = getString(request, "input");
+    std::string output = getString(request, "output");
+    if (input.empty() || output.empty()) {
+        throw std::runtime_error("Se requieren \"input\" y \"output\"");
+    }
+
+    JobPriority priority;
+    if (!parseJobPriority(getString(request, "priority"), priority)) {
+        throw std::runtime_error("Prioridad no reconocida: " + getString(request, "priority"));
+    }
+
+    Transcoder& transcoder = this->transcoder;
+    JobManager::JobFunction work;
+    std::string target = output;
+    int cores;
+
+    if (type == "transcode") {
+        cores = jobs.clampCores(getInt(request, "cores", 2));
+        TranscodeOptions transcodeOptions;
+        transcodeOptions.outputFormat = getString(request, "format");
+        transcodeOptions.videoCodec = getString(request, "vcodec");
+        transcodeOptions.audioCodec = getString(request, "acodec");
+        transcodeOptions.videoBitrate = getInt(request, "vbitrate");
+        transcodeOptions.audioBitrate = getInt(request, "abitrate");
+        transcodeOptions.width = getInt(request, "width");
+        transcodeOptions.height = getInt(request, "height");
+        transcodeOptions.threads = cores;
+        transcodeOptions.chunkSeconds = getInt(request, "chunkSeconds");
+        transcodeOptions.chunkJobs = getInt(request, "chunkJobs");
+        work = [&transcoder, input, output, transcodeOptions](const std::shared_ptr<JobControl>& control,
+                                                             std::function<void(int)> progress) {
+            return transcoder.startTranscode(input, output, transcodeOptions, progress, control);
+        };
+    } else if (type == "hls") {
+        cores = jobs.clampCores(getInt(request, "cores", jobs.coreBudget()));
+        HlsLadderOptions hlsOptions;
+        hlsOptions.maxHeight = getInt(request, "maxHeight", hlsOptions.maxHeight);
+        hlsOptions.maxBitrateKbps = getInt(request, "maxBitrate", hlsOptions.maxBitrateKbps);
+        hlsOptions.segmentDuration = getInt(request, "segment", hlsOptions.segmentDuration);
+        hlsOptions.audioBitrateKbps = getInt(request, "abitrate", hlsOptions.audioBitrateKbps);
+        hlsOptions.videoCodec = getString(request, "vcodec", hlsOptions.videoCodec);
+        hlsOptions.threads = cores;
+        target = output + "/master.m3u8";
+        work = [&transcoder, input, output, hlsOptions](const std::shared_ptr<JobControl>& control,
+                                                       std::function<void(int)> progress) {
+            return transcoder.createHlsStream(input, output, hlsOptions, progress, control);
+        };
+    } else if (type == "trickplay") {
+        cores = jobs.clampCores(getInt(request, "cores", 1));
+        TrickplayOptions trickplayOptions;
+        trickplayOptions.intervalSeconds = getInt(request, "interval", trickplayOptions.intervalSeconds);
+        trickplayOptions.tileWidth = getInt(request, "tileWidth", trickplayOptions.tileWidth);
+        trickplayOptions.columns = getInt(request, "columns", trickplayOptions.columns);
+        trickplayOptions.rows = getInt(request, "rows", trickplayOptions.rows);
+        trickplayOptions.analyze = getString(request, "analyze") != "false";
+        trickplayOptions.decoderThreads = cores;
+        work = [&transcoder, input, output, trickplayOptions](const std::shared_ptr<JobControl>& control,
+                                                             std::function<void(int)>) {
+            return transcoder.generateTrickplay(input, output, trickplayOptions, control);
+        };
+    } else {
+        throw std::runtime_error("Tipo de trabajo no reconocido: " + type);
+    }
+
+    return jobs.submit(type, target, priority, cores, std::move(work));
+}
+
+} // namespace StreamVio
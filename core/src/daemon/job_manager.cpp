@@ -0,0 +1,288 @@
+// StreamVio/core/src/daemon/job_manager.cpp
+#include "daemon/job_manager.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace {
+
+// Trabajos terminados que se conservan para consultas de estado
+constexpr size_t kMaxFinishedJobs = 256;
+
+bool isFinished(JobState state) {
+    return state == JobState::Completed || state == JobState::Failed || state == JobState::Cancelled;
+}
+
+} // namespace
+
+const char* toString(JobPriority priority) {
+    switch (priority) {
+        case JobPriority::Interactive: return "interactive";
+        case JobPriority::Normal:      return "normal";
+        case JobPriority::Background:  return "background";
+    }
+    return "normal";
+}
+
+const char* toString(JobState state) {
+    switch (state) {
+        case JobState::Queued:    return "queued";
+        case JobState::Running:   return "running";
+        case JobState::Paused:    return "paused";
+        case JobState::Completed: return "completed";
+        case JobState::Failed:    return "failed";
+        case JobState::Cancelled: return "cancelled";
+    }
+    return "queued";
+}
+
+bool parseJobPriority(const std::string& name, JobPriority& priority) {
+    if (name == "interactive") {
+        priority = JobPriority::Interactive;
+    } else if (name == "normal" || name.empty()) {
+        priority = JobPriority::Normal;
+    } else if (name == "background") {
+        priority = JobPriority::Background;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+JobManager::JobManager(int coreBudget)
+    : budget(coreBudget > 0 ? coreBudget : static_cast<int>(ThreadPool::defaultThreadCount())) {}
+
+JobManager::~JobManager() {
+    std::unique_lock<std::mutex> lock(mutex);
+    shuttingDown = true;
+    for (auto& entry : jobs) {
+        Job& job = *entry.second;
+        if (job.status.state == JobState::Queued) {
+            job.status.state = JobState::Cancelled;
+        } else if (!isFinished(job.status.state)) {
+            job.control->cancel();
+        }
+    }
+    threadsFinished.wait(lock, [this] { return runningThreads == 0; });
+}
+
+int JobManager::clampCores(int cores) const {
+    return std::clamp(cores, 1, budget);
+}
+
+int64_t JobManager::submit(const std::string& type,
+                           const std::string& target,
+                           JobPriority priority,
+                           int cores,
+                           JobFunction work) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto job = std::make_unique<Job>();
+    job->status.id = nextId++;
+    job->status.type = type;
+    job->status.target = target;
+    job->status.priority = priority;
+    job->status.cores = clampCores(cores);
+    job->work = std::move(work);
+    job->control = std::make_shared<JobControl>();
+
+    int64_t id = job->status.id;
+    jobs.emplace(id, std::move(job));
+    pruneFinished();
+    schedule();
+    return id;
+}
+
+bool JobManager::cancel(int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end() || isFinished(it->second->status.state)) {
+        return false;
+    }
+
+    Job& job = *it->second;
+    if (job.status.state == JobState::Queued) {
+        job.status.state = JobState::Cancelled;
+        job.work = nullptr;
+    } else {
+        // Running o Paused: el hilo del trabajo sale en su siguiente punto
+        // de control (un trabajo pausado se despierta para salir)
+        job.control->cancel();
+    }
+    return true;
+}
+
+std::optional<JobStatus> JobManager::status(int64_t id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return std::nullopt;
+    }
+    return it->second->status;
+}
+
+std::vector<JobStatus> JobManager::list() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<JobStatus> result;
+    result.reserve(jobs.size());
+    for (const auto& entry : jobs) {
+        result.push_back(entry.second->status);
+    }
+    return result;
+}
+
+int JobManager::coresInUse() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedCores;
+}
+
+JobManager::Job* JobManager::nextCandidate() {
+    Job* best = nullptr;
+    for (auto& entry : jobs) {
+        Job& job = *entry.second;
+        bool waiting = job.status.state == JobState::Queued ||
+                       (job.status.state == JobState::Paused && !job.holdsCores);
+        if (!waiting || job.control->isCancelled()) {
+            continue;
+        }
+        if (!best || job.status.priority < best->status.priority ||
+            (job.status.priority == best->status.priority &&
+             job.status.state == JobState::Paused && best->status.state == JobState::Queued)) {
+            // El mapa está ordenado por id: a igualdad gana el más antiguo
+            best = &job;
+        }
+    }
+    return best;
+}
+
+void JobManager::schedule() {
+    if (shuttingDown) {
+        return;
+    }
+
+    while (Job* candidate = nextCandidate()) {
+        int cores = candidate->status.cores;
+
+        if (usedCores + cores > budget) {
+            // Desalojar trabajos de menor prioridad: primero los de menor
+            // prioridad y, entre ellos, los arrancados más recientemente
+            std::vector<Job*> victims;
+            int freeable = 0;
+            for (auto& entry : jobs) {
+                Job& job = *entry.second;
+                if (job.status.state == JobState::Running && job.holdsCores &&
+                    job.status.priority > candidate->status.priority) {
+                    victims.push_back(&job);
+                    freeable += job.status.cores;
+                }
+            }
+            if (usedCores - freeable + cores > budget) {
+                // Ni desalojando cabe: esperar a que terminen otros trabajos
+                return;
+            }
+
+            std::sort(victims.begin(), victims.end(), [](const Job* a, const Job* b) {
+                if (a->status.priority != b->status.priority) {
+                    return a->status.priority > b->status.priority;
+                }
+                return a->startOrder > b->startOrder;
+            });
+            for (Job* victim : victims) {
+                if (usedCores + cores <= budget) {
+                    break;
+                }
+                victim->control->pause();
+                victim->status.state = JobState::Paused;
+                victim->holdsCores = false;
+                usedCores -= victim->status.cores;
+            }
+        }
+
+        usedCores += cores;
+        candidate->holdsCores = true;
+        if (candidate->status.state == JobState::Paused) {
+            candidate->status.state = JobState::Running;
+            candidate->control->resume();
+        } else {
+            launch(*candidate);
+        }
+    }
+}
+
+void JobManager::launch(Job& job) {
+    job.status.state = JobState::Running;
+    job.startOrder = nextStartOrder++;
+    runningThreads++;
+
+    // El Job vive en `jobs` hasta que termina: pruneFinished solo borra
+    // trabajos terminados
+    Job* jobPtr = &job;
+    std::thread([this, jobPtr]() { runJob(*jobPtr); }).detach();
+}
+
+void JobManager::runJob(Job& job) {
+    auto progress = [this, &job](int value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        job.status.progress = value;
+    };
+
+    bool succeeded = false;
+    std::string error;
+    try {
+        succeeded = job.work(job.control, progress);
+        if (!succeeded) {
+            error = job.control->error();
+        }
+    } catch (const JobCancelled&) {
+        error = "Cancelado";
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (job.holdsCores) {
+        usedCores -= job.status.cores;
+        job.holdsCores = false;
+    }
+    if (succeeded) {
+        job.status.state = JobState::Completed;
+        job.status.progress = 100;
+    } else if (job.control->isCancelled()) {
+        job.status.state = JobState::Cancelled;
+    } else {
+        job.status.state = JobState::Failed;
+        job.status.error = error.empty() ? "Error desconocido" : error;
+        std::cerr << "Trabajo " << job.status.id << " (" << job.status.type << ") falló: "
+                  << job.status.error << std::endl;
+    }
+    // Soltar lo que capture la función (rutas, referencias) cuanto antes
+    job.work = nullptr;
+
+    schedule();
+    runningThreads--;
+    threadsFinished.notify_all();
+}
+
+void JobManager::pruneFinished() {
+    size_t finished = 0;
+    for (const auto& entry : jobs) {
+        if (isFinished(entry.second->status.state)) {
+            finished++;
+        }
+    }
+    for (auto it = jobs.begin(); it != jobs.end() && finished > kMaxFinishedJobs;) {
+        if (isFinished(it->second->status.state)) {
+            it = jobs.erase(it);
+            finished--;
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace StreamVio
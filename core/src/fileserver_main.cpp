@@ -0,0 +1,133 @@
+// StreamVio/core/src/fileserver_main.cpp
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "server/file_server.h"
+
+namespace {
+
+StreamVio::FileServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+void printUsage() {
+    std::cout << "StreamVio File Server - Versión 0.1.0" << std::endl;
+    std::cout << "Uso: streamvio_fileserver [opciones]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Sirve rangos de bytes y segmentos HLS con sendfile. Por defecto publica" << std::endl;
+    std::cout << "$DATA_DIR/transcoded en /data-storage/transcoded/ y exige el mismo JWT" << std::endl;
+    std::cout << "que el servidor Node (variable de entorno JWT_SECRET, obligatoria)." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opciones:" << std::endl;
+    std::cout << "  --bind=<dirección>        - Dirección de escucha (por defecto 0.0.0.0)" << std::endl;
+    std::cout << "  --port=<puerto>           - Puerto (por defecto 8090)" << std::endl;
+    std::cout << "  --workers=<n>             - Bucles epoll (0 = núcleos disponibles, máximo 8)" << std::endl;
+    std::cout << "  --data-dir=<ruta>         - Directorio de datos (por defecto $DATA_DIR o ./data-storage)" << std::endl;
+    std::cout << "  --mount=<prefijo>=<dir>   - Publicar también un directorio (repetible)" << std::endl;
+    std::cout << "  --idle-timeout=<seg>      - Cierre de conexiones inactivas (por defecto 30)" << std::endl;
+    std::cout << "  --no-auth                 - No exigir token (solo detrás de un proxy de confianza)" << std::endl;
+}
+
+std::string getOptionValue(const std::vector<std::string>& args, const std::string& option, const std::string& defaultValue = "") {
+    for (const auto& arg : args) {
+        if (arg.find(option + "=") == 0) {
+            return arg.substr(option.length() + 1);
+        }
+    }
+    return defaultValue;
+}
+
+int getOptionValueInt(const std::vector<std::string>& args, const std::string& option, int defaultValue = 0) {
+    std::string value = getOptionValue(args, option);
+    if (value.empty()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(value);
+    } catch (...) {
+        return defaultValue;
+    }
+}
+
+bool hasOption(const std::vector<std::string>& args, const std::string& option) {
+    for (const auto& arg : args) {
+        if (arg == option) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (hasOption(args, "--help")) {
+        printUsage();
+        return 0;
+    }
+
+    StreamVio::FileServerOptions options;
+    options.bindAddress = getOptionValue(args, "--bind", options.bindAddress);
+    options.port = getOptionValueInt(args, "--port", options.port);
+    options.workers = getOptionValueInt(args, "--workers", options.workers);
+    options.idleTimeoutSeconds = getOptionValueInt(args, "--idle-timeout", options.idleTimeoutSeconds);
+    options.requireAuth = !hasOption(args, "--no-auth");
+
+    const char* envDataDir = std::getenv("DATA_DIR");
+    std::string dataDir = getOptionValue(args, "--data-dir", envDataDir ? envDataDir : "./data-storage");
+    // Solo lo transcodificado: en data-storage también están la base de datos y las copias
+    options.mounts.push_back({"/data-storage/transcoded/", dataDir + "/transcoded"});
+    for (const auto& arg : args) {
+        if (arg.find("--mount=") != 0) {
+            continue;
+        }
+        std::string value = arg.substr(8);
+        size_t equals = value.find('=');
+        if (equals == std::string::npos || equals == 0) {
+            std::cerr << "Error: Formato de montaje no válido (se espera prefijo=directorio): " << value << std::endl;
+            return 1;
+        }
+        options.mounts.push_back({value.substr(0, equals), value.substr(equals + 1)});
+    }
+
+    // Sin secreto propio no se arranca: el valor por defecto del servidor
+    // Node está en el código fuente y cualquiera podría firmar tokens con él
+    const char* secret = std::getenv("JWT_SECRET");
+    if (options.requireAuth) {
+        if (!secret || !*secret) {
+            std::cerr << "Error: JWT_SECRET no definido (o use --no-auth detrás de un proxy de confianza)" << std::endl;
+            return 1;
+        }
+        options.jwtSecret = secret;
+    }
+
+    try {
+        StreamVio::FileServer server(options);
+        activeServer = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+        // sendfile no admite MSG_NOSIGNAL: un cliente que corta no debe matar el proceso
+        std::signal(SIGPIPE, SIG_IGN);
+
+        server.run();
+        activeServer = nullptr;
+
+        const StreamVio::FileServerStats& stats = server.stats();
+        std::cerr << "Servidor detenido: " << stats.requests.load() << " peticiones, "
+                  << stats.connections.load() << " conexiones, "
+                  << (stats.bytesSent.load() / (1024 * 1024)) << " MiB enviados" << std::endl;
+    } catch (const std::exception& e) {
+        activeServer = nullptr;
+        std::cerr << "Error en el servidor de archivos: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -8,20 +8,36 @@
 #include <fstream>
 #include <cstdlib>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
 
+#include "daemon/daemon_server.h"
+#include "scanner/library_scanner.h"
 #include "transcoder/transcoder.h"
+#include "utils/json_writer.h"
 
 void printUsage() {
     std::cout << "StreamVio Transcoder - Versión 0.1.0" << std::endl;
     std::cout << "Uso: streamvio_transcoder [opciones] [comando] [parámetros]" << std::endl;
     std::cout << std::endl;
     std::cout << "Comandos:" << std::endl;
-    std::cout << "  info <archivo_entrada>                   - Obtener información de un archivo multimedia" << std::endl;
+    std::cout << "  info <archivo_entrada> [--fast]          - Obtener información de un archivo multimedia" << std::endl;
+    std::cout << "  probe-many [--threads=N] [--fast]        - Analizar rutas leídas de stdin y emitir NDJSON" << std::endl;
     std::cout << "  transcode <entrada> <salida> [opciones]  - Transcodificar un archivo" << std::endl;
     std::cout << "  thumbnail <entrada> <salida> [tiempo]    - Generar una miniatura del video" << std::endl;
+    std::cout << "  trickplay <entrada> <directorio> [opciones] - Poster, sprites y WebVTT (solo keyframes)" << std::endl;
+    std::cout << "  trickplay-many [--threads=N] [opciones]  - Trickplay para \"entrada<TAB>directorio\" leídos de stdin" << std::endl;
+    std::cout << "  hls <entrada> <directorio> [opciones]    - Generar HLS adaptativo (una decodificación)" << std::endl;
+    std::cout << "  hls-jit <entrada> <directorio> [opciones] - HLS bajo demanda: índices de segmento por stdin" << std::endl;
+    std::cout << "  index <archivo> [tiempo_ms] [fin_ms]     - Indexar keyframes; keyframe o rango de bytes de un instante" << std::endl;
+    std::cout << "  scan <directorio> [opciones]             - Cambios de la biblioteca desde el último escaneo (NDJSON)" << std::endl;
+    std::cout << "  daemon [--socket=ruta] [--cores=N]       - Servidor persistente con cola de trabajos por prioridad" << std::endl;
+    std::cout << "         [--metrics-file=ruta] [--metrics-interval=s] - Volcado periódico de métricas (Prometheus)" << std::endl;
     std::cout << std::endl;
     std::cout << "Opciones de transcodificación:" << std::endl;
-    std::cout << "  --format=<formato>        - Formato de salida (mp4, webm, etc.)" << std::endl;
+    std::cout << "  --format=<formato>        - Formato de salida (mp4, fmp4, hls, mkv, webm, etc.)" << std::endl;
     std::cout << "  --vcodec=<codec>          - Codec de video (h264, vp9, etc.)" << std::endl;
     std::cout << "  --acodec=<codec>          - Codec de audio (aac, opus, etc.)" << std::endl;
     std::cout << "  --vbitrate=<kbps>         - Bitrate de video en kbps" << std::endl;
@@ -29,6 +45,47 @@ void printUsage() {
     std::cout << "  --width=<pixeles>         - Ancho de salida" << std::endl;
     std::cout << "  --height=<pixeles>        - Alto de salida" << std::endl;
     std::cout << "  --no-hwaccel              - Desactivar aceleración por hardware" << std::endl;
+    std::cout << "  --threads=<n>             - Hilos del decodificador y del codificador" << std::endl;
+    std::cout << "  --chunk=<segundos>        - Codificar el video en trozos paralelos (reanudable)" << std::endl;
+    std::cout << "  --chunk-jobs=<n>          - Trozos simultáneos (por defecto según --threads)" << std::endl;
+    std::cout << "  --stats                   - Mostrar el estado de las colas del pipeline al terminar" << std::endl;
+    std::cout << "  --progress=ndjson         - Emitir el progreso y las métricas por etapa como NDJSON en stdout" << std::endl;
+    std::cout << "  --progress-interval=<ms>  - Separación entre eventos de progreso (por defecto 1000)" << std::endl;
+    std::cout << "  --metrics-file=<ruta>     - Volcar las métricas en formato Prometheus al terminar" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opciones de HLS:" << std::endl;
+    std::cout << "  --max-height=<pixeles>    - Altura máxima de la escalera (por defecto 1080)" << std::endl;
+    std::cout << "  --max-bitrate=<kbps>      - Bitrate máximo por calidad (por defecto 8000)" << std::endl;
+    std::cout << "  --segment=<segundos>      - Duración de cada segmento (por defecto 2)" << std::endl;
+    std::cout << "  --abitrate=<kbps>         - Bitrate de audio (por defecto 128)" << std::endl;
+    std::cout << "  --vcodec=<codec>          - Codificador de video (por defecto libx264)" << std::endl;
+    std::cout << "  --threads=<n>             - Hilos de codificación totales" << std::endl;
+    std::cout << "  --prefetch=<n>            - Segmentos a preparar por delante (hls-jit, por defecto 3)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opciones de trickplay:" << std::endl;
+    std::cout << "  --interval=<segundos>     - Separación entre miniaturas (por defecto 10)" << std::endl;
+    std::cout << "  --tile-width=<pixeles>    - Ancho de cada miniatura (por defecto 160)" << std::endl;
+    std::cout << "  --columns=<n>             - Columnas por hoja de sprites (por defecto 10)" << std::endl;
+    std::cout << "  --rows=<n>                - Filas por hoja de sprites (por defecto 10)" << std::endl;
+    std::cout << "  --poster-time=<ms>        - Instante del poster (por defecto 10% de la duración)" << std::endl;
+    std::cout << "  --no-poster               - No generar poster.jpg" << std::endl;
+    std::cout << "  --no-analysis             - No analizar los keyframes (negros, cortes, pHash) ni guardar el .svfa" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opciones de escaneo:" << std::endl;
+    std::cout << "  --index=<ruta>            - Índice de la biblioteca (por defecto <directorio>/.streamvio-scan.idx)" << std::endl;
+    std::cout << "  --threads=<n>             - Hilos de recorrido (por defecto dos por núcleo)" << std::endl;
+    std::cout << "  --max-depth=<n>           - Profundidad máxima (por defecto 10)" << std::endl;
+    std::cout << "  --follow-symlinks         - Seguir enlaces simbólicos" << std::endl;
+    std::cout << "  --hidden                  - Incluir archivos y directorios ocultos" << std::endl;
+    std::cout << "  --dry-run                 - No actualizar el índice" << std::endl;
+    std::cout << "  --duplicates[=<bits>]     - Buscar títulos duplicados con el análisis del trickplay (por defecto 10)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Opciones de análisis:" << std::endl;
+    std::cout << "  --fast                    - Limitar probesize/analyzeduration" << std::endl;
+    std::cout << "  --probesize=<bytes>       - Bytes máximos a leer en modo rápido" << std::endl;
+    std::cout << "  --analyzeduration=<ms>    - Duración máxima a analizar en modo rápido" << std::endl;
+    std::cout << "  --threads=<n>             - Hilos de análisis (0 = núcleos disponibles)" << std::endl;
+    std::cout << "  --index                   - Generar también el índice de keyframes (.svidx)" << std::endl;
 }
 
 std::string getOptionValue(const std::vector<std::string>& args, const std::string& option, const std::string& defaultValue = "") {
@@ -61,6 +118,27 @@ bool hasOption(const std::vector<std::string>& args, const std::string& option)
     return false;
 }
 
+StreamVio::ProbeOptions getProbeOptions(const std::vector<std::string>& args) {
+    StreamVio::ProbeOptions options;
+    options.fastMode = hasOption(args, "--fast");
+    options.probeSizeBytes = getOptionValueInt(args, "--probesize", static_cast<int>(options.probeSizeBytes));
+    options.analyzeDurationMs = getOptionValueInt(args, "--analyzeduration", options.analyzeDurationMs);
+    options.buildKeyframeIndex = hasOption(args, "--index");
+    return options;
+}
+
+StreamVio::TrickplayOptions getTrickplayOptions(const std::vector<std::string>& args) {
+    StreamVio::TrickplayOptions options;
+    options.poster = !hasOption(args, "--no-poster");
+    options.posterOffsetMs = getOptionValueInt(args, "--poster-time", options.posterOffsetMs);
+    options.intervalSeconds = getOptionValueInt(args, "--interval", options.intervalSeconds);
+    options.tileWidth = getOptionValueInt(args, "--tile-width", options.tileWidth);
+    options.columns = getOptionValueInt(args, "--columns", options.columns);
+    options.rows = getOptionValueInt(args, "--rows", options.rows);
+    options.analyze = !hasOption(args, "--no-analysis");
+    return options;
+}
+
 // Callback para reportar el progreso
 void progressCallback(int progress) {
     static int lastProgress = -1;
@@ -70,6 +148,55 @@ void progressCallback(int progress) {
     }
 }
 
+// Evento NDJSON con el progreso y las métricas de una transcodificación
+void printTranscodeEvent(StreamVio::Transcoder& transcoder, const std::string& event,
+                         const std::string& outputPath, const std::string& error = "") {
+    StreamVio::JsonWriter json;
+    json.field("event", event).field("output", outputPath);
+    int progress = transcoder.getTranscodeProgress(outputPath);
+    if (progress >= 0) {
+        json.field("progress", progress);
+    }
+    StreamVio::TranscodeMetricsSnapshot metrics;
+    if (transcoder.getTranscodeMetrics(outputPath, metrics)) {
+        json.raw("metrics", StreamVio::transcodeMetricsToJson(metrics));
+    }
+    if (!error.empty()) {
+        json.field("error", error);
+    }
+    std::cout << json.str() << std::endl;
+}
+
+// Emite un evento "progress" cada `intervalMs` mientras existe. La
+// transcodificación corre en el hilo principal.
+class NdjsonProgressReporter {
+public:
+    NdjsonProgressReporter(StreamVio::Transcoder& transcoder, const std::string& outputPath, int intervalMs)
+        : reporter([this, &transcoder, outputPath, intervalMs]() {
+              std::unique_lock<std::mutex> lock(mutex);
+              while (!wake.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return finished; })) {
+                  if (transcoder.getTranscodeProgress(outputPath) >= 0) {
+                      printTranscodeEvent(transcoder, "progress", outputPath);
+                  }
+              }
+          }) {}
+
+    ~NdjsonProgressReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+        }
+        wake.notify_one();
+        reporter.join();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool finished = false;
+    std::thread reporter;   // El último: arranca con lo anterior ya construido
+};
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         printUsage();
@@ -96,17 +223,22 @@ int main(int argc, char* argv[]) {
 
         std::string inputPath = args[1];
         try {
-            StreamVio::MediaInfo info = transcoder.getMediaInfo(inputPath);
+            StreamVio::MediaInfo info = transcoder.getMediaInfo(inputPath, getProbeOptions(args));
             
             std::cout << "Información del archivo: " << inputPath << std::endl;
-            std::cout << "Formato: " << info.format << std::endl;
+            std::cout << "Formato: " << info.format << " (" << info.bitrate << " kbps)" << std::endl;
             std::cout << "Duración: " << (info.duration / 1000.0) << " segundos" << std::endl;
             std::cout << "Resolución: " << info.width << "x" << info.height << std::endl;
+            std::cout << "Fotogramas por segundo: " << info.frameRate << std::endl;
             std::cout << "Codec de video: " << info.videoCodec << " (" << info.videoBitrate << " kbps)" << std::endl;
             std::cout << "Codec de audio: " << info.audioCodec << " (" << info.audioBitrate << " kbps)" << std::endl;
             std::cout << "Canales de audio: " << info.audioChannels << std::endl;
             std::cout << "Frecuencia de muestreo: " << info.audioSampleRate << " Hz" << std::endl;
             
+            if (!info.keyframeIndex.empty()) {
+                std::cout << "Índice de keyframes: " << info.keyframeIndex << std::endl;
+            }
+
             if (!info.metadata.empty()) {
                 std::cout << "Metadatos:" << std::endl;
                 for (const auto& pair : info.metadata) {
@@ -117,6 +249,21 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error: " << e.what() << std::endl;
             return 1;
         }
+    } else if (command == "probe-many") {
+        int threads = getOptionValueInt(args, "--threads", 0);
+        if (threads < 0) {
+            std::cerr << "Error: El número de hilos no puede ser negativo." << std::endl;
+            return 1;
+        }
+
+        // stdout queda reservado para los resultados NDJSON
+        std::ios::sync_with_stdio(false);
+        size_t failures = transcoder.probeMany(std::cin, std::cout, static_cast<size_t>(threads),
+                                               getProbeOptions(args));
+        if (failures > 0) {
+            std::cerr << failures << " archivos no se pudieron analizar." << std::endl;
+            return 1;
+        }
     } else if (command == "transcode") {
         if (args.size() < 3) {
             std::cerr << "Error: Se requieren rutas de entrada y salida para el comando transcode." << std::endl;
@@ -136,22 +283,53 @@ int main(int argc, char* argv[]) {
         options.width = getOptionValueInt(args, "--width");
         options.height = getOptionValueInt(args, "--height");
         options.enableHardwareAcceleration = !hasOption(args, "--no-hwaccel");
+        options.threads = getOptionValueInt(args, "--threads", options.threads);
+        options.chunkSeconds = getOptionValueInt(args, "--chunk", options.chunkSeconds);
+        options.chunkJobs = getOptionValueInt(args, "--chunk-jobs", options.chunkJobs);
+        
+        // Con --progress=ndjson stdout queda solo para los eventos
+        bool ndjson = getOptionValue(args, "--progress") == "ndjson";
+        int progressInterval = std::max(100, getOptionValueInt(args, "--progress-interval", 1000));
+        std::string metricsFile = getOptionValue(args, "--metrics-file");
+        std::ostream& log = ndjson ? std::cerr : std::cout;
         
         // Iniciar transcodificación
         try {
-            std::cout << "Iniciando transcodificación..." << std::endl;
-            if (!transcoder.startTranscode(inputPath, outputPath, options, progressCallback)) {
+            log << "Iniciando transcodificación..." << std::endl;
+            auto control = std::make_shared<StreamVio::JobControl>();
+            bool succeeded;
+            {
+                std::unique_ptr<NdjsonProgressReporter> reporter;
+                if (ndjson) {
+                    reporter.reset(new NdjsonProgressReporter(transcoder, outputPath, progressInterval));
+                }
+                succeeded = transcoder.startTranscode(inputPath, outputPath, options,
+                                                      ndjson ? nullptr : progressCallback, control);
+            }
+            if (!metricsFile.empty()) {
+                try {
+                    StreamVio::writeMetricsFile(metricsFile, transcoder.prometheusMetrics());
+                } catch (const std::exception& e) {
+                    std::cerr << "Aviso: " << e.what() << std::endl;
+                }
+            }
+            if (ndjson) {
+                printTranscodeEvent(transcoder, succeeded ? "done" : "error", outputPath, control->error());
+            }
+            if (!succeeded) {
                 std::cerr << "Error: No se pudo iniciar la transcodificación." << std::endl;
                 return 1;
             }
+
+            log << std::endl << "Transcodificación completada exitosamente." << std::endl;
             
-            // La función startTranscode es asíncrona, pero podemos esperar a que termine
-            // verificando el progreso hasta que llegue al 100%
-            while (transcoder.getTranscodeProgress(outputPath) < 100) {
-                // Esperamos un poco para no consumir demasiada CPU
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (hasOption(args, "--stats")) {
+                for (const auto& queue : transcoder.getPipelineStats(outputPath)) {
+                    std::cerr << queue.name << ": máx " << queue.maxDepth << "/" << queue.capacity
+                              << ", esperas productor " << queue.producerWaits
+                              << ", esperas consumidor " << queue.consumerWaits << std::endl;
+                }
             }
-            std::cout << std::endl << "Transcodificación completada exitosamente." << std::endl;
         } catch (const std::exception& e) {
             std::cerr << "Error durante la transcodificación: " << e.what() << std::endl;
             return 1;
@@ -178,6 +356,168 @@ int main(int argc, char* argv[]) {
             std::cerr << "Error al generar miniatura: " << e.what() << std::endl;
             return 1;
         }
+    } else if (command == "trickplay") {
+        if (args.size() < 3) {
+            std::cerr << "Error: Se requieren una entrada y un directorio de salida para el comando trickplay." << std::endl;
+            return 1;
+        }
+
+        StreamVio::TrickplayOptions options = getTrickplayOptions(args);
+        if (options.intervalSeconds <= 0 || options.tileWidth <= 0 || options.columns <= 0 || options.rows <= 0) {
+            std::cerr << "Error: Opciones de trickplay no válidas." << std::endl;
+            return 1;
+        }
+
+        std::cout << "Generando trickplay..." << std::endl;
+        if (!transcoder.generateTrickplay(args[1], args[2], options)) {
+            return 1;
+        }
+        std::cout << "Trickplay generado en: " << args[2] << std::endl;
+    } else if (command == "trickplay-many") {
+        int threads = getOptionValueInt(args, "--threads", 0);
+        StreamVio::TrickplayOptions options = getTrickplayOptions(args);
+        if (threads < 0 || options.intervalSeconds <= 0 || options.tileWidth <= 0 ||
+            options.columns <= 0 || options.rows <= 0) {
+            std::cerr << "Error: Opciones de trickplay no válidas." << std::endl;
+            return 1;
+        }
+
+        // stdout queda reservado para los resultados NDJSON
+        std::ios::sync_with_stdio(false);
+        size_t failures = transcoder.generateTrickplayMany(std::cin, std::cout, static_cast<size_t>(threads), options);
+        if (failures > 0) {
+            std::cerr << failures << " archivos no se pudieron procesar." << std::endl;
+            return 1;
+        }
+    } else if (command == "hls") {
+        if (args.size() < 3) {
+            std::cerr << "Error: Se requieren una entrada y un directorio de salida para el comando hls." << std::endl;
+            return 1;
+        }
+
+        std::string inputPath = args[1];
+        std::string outputDir = args[2];
+
+        StreamVio::HlsLadderOptions options;
+        options.maxHeight = getOptionValueInt(args, "--max-height", options.maxHeight);
+        options.maxBitrateKbps = getOptionValueInt(args, "--max-bitrate", options.maxBitrateKbps);
+        options.segmentDuration = getOptionValueInt(args, "--segment", options.segmentDuration);
+        options.audioBitrateKbps = getOptionValueInt(args, "--abitrate", options.audioBitrateKbps);
+        options.videoCodec = getOptionValue(args, "--vcodec", options.videoCodec);
+        options.threads = getOptionValueInt(args, "--threads", options.threads);
+        if (options.segmentDuration <= 0) {
+            std::cerr << "Error: La duración de segmento debe ser positiva." << std::endl;
+            return 1;
+        }
+
+        try {
+            std::cout << "Generando HLS adaptativo..." << std::endl;
+            if (!transcoder.createHlsStream(inputPath, outputDir, options, progressCallback)) {
+                std::cerr << "Error: No se pudo generar el stream HLS." << std::endl;
+                return 1;
+            }
+            std::cout << std::endl << "HLS generado: " << outputDir << "/master.m3u8" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Error al generar HLS: " << e.what() << std::endl;
+            return 1;
+        }
+    } else if (command == "hls-jit") {
+        if (args.size() < 3) {
+            std::cerr << "Error: Se requieren una entrada y un directorio de salida para el comando hls-jit." << std::endl;
+            return 1;
+        }
+
+        StreamVio::JitHlsOptions options;
+        options.maxHeight = getOptionValueInt(args, "--max-height", options.maxHeight);
+        options.maxBitrateKbps = getOptionValueInt(args, "--max-bitrate", options.maxBitrateKbps);
+        options.segmentDuration = getOptionValueInt(args, "--segment", options.segmentDuration);
+        options.audioBitrateKbps = getOptionValueInt(args, "--abitrate", options.audioBitrateKbps);
+        options.videoCodec = getOptionValue(args, "--vcodec", options.videoCodec);
+        options.threads = getOptionValueInt(args, "--threads", options.threads);
+        options.prefetchSegments = getOptionValueInt(args, "--prefetch", options.prefetchSegments);
+        if (options.segmentDuration <= 0 || options.prefetchSegments < 0) {
+            std::cerr << "Error: Duración de segmento o prefetch no válidos." << std::endl;
+            return 1;
+        }
+
+        // stdout queda reservado para los eventos NDJSON
+        if (!transcoder.serveHlsOnDemand(args[1], args[2], options, std::cin, std::cout)) {
+            return 1;
+        }
+    } else if (command == "index") {
+        if (args.size() < 2) {
+            std::cerr << "Error: Se requiere una ruta de archivo para el comando index." << std::endl;
+            return 1;
+        }
+
+        std::string inputPath = args[1];
+        try {
+            if (args.size() < 3) {
+                if (!transcoder.buildKeyframeIndex(inputPath)) {
+                    return 1;
+                }
+                std::cout << "Índice generado: " << StreamVio::keyframeIndexPath(inputPath) << std::endl;
+            } else if (args.size() < 4) {
+                StreamVio::KeyframeInfo keyframe;
+                if (!transcoder.findKeyframe(inputPath, std::stoll(args[2]), keyframe)) {
+                    return 1;
+                }
+                std::cout << "{\"timeMs\":" << keyframe.timeMs << ",\"position\":" << keyframe.position
+                          << ",\"size\":" << keyframe.size << "}" << std::endl;
+            } else {
+                StreamVio::ByteRange range;
+                if (!transcoder.getByteRange(inputPath, std::stoll(args[2]), std::stoll(args[3]), range)) {
+                    return 1;
+                }
+                std::cout << "{\"offset\":" << range.offset << ",\"length\":" << range.length << "}" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    } else if (command == "scan") {
+        if (args.size() < 2) {
+            std::cerr << "Error: Se requiere el directorio de la biblioteca para el comando scan." << std::endl;
+            return 1;
+        }
+
+        StreamVio::ScanOptions options;
+        options.indexPath = getOptionValue(args, "--index");
+        options.threads = getOptionValueInt(args, "--threads", options.threads);
+        options.maxDepth = getOptionValueInt(args, "--max-depth", options.maxDepth);
+        options.followSymlinks = hasOption(args, "--follow-symlinks");
+        options.includeHidden = hasOption(args, "--hidden");
+        options.dryRun = hasOption(args, "--dry-run");
+        if (hasOption(args, "--duplicates")) {
+            options.duplicateDistance = 10;
+        }
+        options.duplicateDistance = getOptionValueInt(args, "--duplicates", options.duplicateDistance);
+
+        try {
+            // stdout queda reservado para los eventos NDJSON
+            StreamVio::scanLibrary(args[1], options, std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error durante el escaneo: " << e.what() << std::endl;
+            return 1;
+        }
+    } else if (command == "daemon") {
+        StreamVio::DaemonOptions options;
+        options.socketPath = getOptionValue(args, "--socket", options.socketPath);
+        options.coreBudget = getOptionValueInt(args, "--cores", options.coreBudget);
+        options.metricsFile = getOptionValue(args, "--metrics-file");
+        options.metricsIntervalSeconds = getOptionValueInt(args, "--metrics-interval", options.metricsIntervalSeconds);
+        if (options.coreBudget < 0) {
+            std::cerr << "Error: El número de núcleos no puede ser negativo." << std::endl;
+            return 1;
+        }
+
+        try {
+            StreamVio::DaemonServer server(transcoder, options);
+            server.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error en el daemon: " << e.what() << std::endl;
+            return 1;
+        }
     } else {
         std::cerr << "Error: Comando no reconocido: " << command << std::endl;
         printUsage();
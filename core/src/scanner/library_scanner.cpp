@@ -0,0 +1,686 @@
+// StreamVio/core/src/scanner/library_scanner.cpp
+#include "scanner/library_scanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/murmur3.h>
+}
+
+#include "analyzer/frame_analysis.h"
+#include "utils/json_writer.h"
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace {
+
+const char kIndexMagic[8] = {'S', 'V', 'L', 'I', 'B', 'I', 'X', '\0'};
+const char* const kDefaultIndexName = ".streamvio-scan.idx";
+
+constexpr size_t kDentsBufferSize = 64 * 1024;
+constexpr int64_t kHashWindow = 64 * 1024;
+constexpr unsigned int kStatxMask = STATX_TYPE | STATX_INO | STATX_SIZE | STATX_MTIME;
+
+// Dos duraciones se consideran del mismo título si difieren menos de esto
+// o del porcentaje (créditos, intros o cortes de otra edición)
+constexpr int64_t kDuplicateDurationSlackUs = 5 * 1000000LL;
+constexpr int64_t kDuplicateDurationPercent = 2;
+
+// Formato de getdents64 (glibc no lo expone en todas las versiones)
+struct LinuxDirent64 {
+    uint64_t inode;
+    int64_t offset;
+    unsigned short recordLength;
+    unsigned char type;
+    char name[1];
+};
+
+// Mismas extensiones que SUPPORTED_EXTENSIONS en server/config/constants.js
+const char* mediaTypeFor(const char* name) {
+    static const std::unordered_map<std::string, const char*> types = {
+        {"mp4", "video"}, {"mkv", "video"}, {"avi", "video"}, {"mov", "video"},
+        {"wmv", "video"}, {"m4v", "video"}, {"webm", "video"}, {"mpg", "video"},
+        {"mpeg", "video"}, {"3gp", "video"}, {"flv", "video"},
+        {"mp3", "audio"}, {"wav", "audio"}, {"flac", "audio"}, {"aac", "audio"},
+        {"ogg", "audio"}, {"m4a", "audio"}, {"wma", "audio"},
+        {"jpg", "image"}, {"jpeg", "image"}, {"png", "image"}, {"gif", "image"},
+        {"webp", "image"}, {"bmp", "image"},
+    };
+
+    const char* dot = std::strrchr(name, '.');
+    if (!dot || dot == name || std::strlen(dot + 1) > 4) {
+        return nullptr;
+    }
+    std::string extension(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto it = types.find(extension);
+    return it != types.end() ? it->second : nullptr;
+}
+
+std::string joinPath(const std::string& directory, const char* name) {
+    return directory.empty() ? std::string(name) : directory + "/" + name;
+}
+
+std::string hashToHex(uint64_t hash) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+// Hash de los primeros y últimos 64 KiB más el tamaño: identifica el
+// contenido leyendo como mucho 128 KiB por archivo
+uint64_t partialContentHash(const std::string& path, int64_t size) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    std::unique_ptr<AVMurMur3, void (*)(void*)> murmur(av_murmur3_alloc(), av_free);
+    if (!murmur) {
+        ::close(fd);
+        return 0;
+    }
+    av_murmur3_init(murmur.get());
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(kHashWindow));
+    bool ok = true;
+    auto hashWindow = [&](int64_t offset, int64_t length) {
+        ssize_t n = ::pread(fd, buffer.data(), static_cast<size_t>(length), offset);
+        if (n != static_cast<ssize_t>(length)) {
+            ok = false;
+            return;
+        }
+        av_murmur3_update(murmur.get(), buffer.data(), static_cast<size_t>(n));
+    };
+    hashWindow(0, std::min(size, kHashWindow));
+    if (ok && size > kHashWindow) {
+        int64_t tailStart = std::max(kHashWindow, size - kHashWindow);
+        hashWindow(tailStart, size - tailStart);
+    }
+    ::close(fd);
+    if (!ok) {
+        return 0;
+    }
+
+    av_murmur3_update(murmur.get(), reinterpret_cast<const uint8_t*>(&size), sizeof(size));
+    uint8_t digest[16];
+    av_murmur3_final(murmur.get(), digest);
+    uint64_t hash = 0;
+    std::memcpy(&hash, digest, sizeof(hash));
+    // 0 queda reservado para "sin hash"
+    return hash ? hash : 1;
+}
+
+// Lector secuencial del índice con comprobación de límites
+class IndexReader {
+public:
+    explicit IndexReader(const std::string& data) : data(data) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (data.size() - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        uint32_t length = 0;
+        if (!read(length) || data.size() - offset < length) {
+            return false;
+        }
+        value.assign(data, offset, length);
+        offset += length;
+        return true;
+    }
+
+    bool atEnd() const { return offset == data.size(); }
+
+private:
+    const std::string& data;
+    size_t offset = 0;
+};
+
+template <typename T>
+void appendValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+// Recorrido paralelo: cada directorio es una tarea del pool, que encola sus
+// subdirectorios y vuelca sus archivos al resultado común de una vez
+class Walker {
+public:
+    Walker(const std::string& root, const ScanOptions& options, size_t threads)
+        : root(root), options(options),
+          // Sin límite de cola: las tareas encolan subdirectorios desde los
+          // propios workers y con una cola acotada podrían bloquearse todos
+          pool(threads, std::numeric_limits<size_t>::max()) {}
+
+    void run() {
+        scheduleDirectory("", 0);
+        pool.waitIdle();
+    }
+
+    ThreadPool& threadPool() { return pool; }
+
+    std::vector<LibraryIndexEntry> files;
+    std::vector<std::string> failedDirectories;
+    int64_t directoryCount = 0;
+
+private:
+    void scheduleDirectory(std::string relative, int depth) {
+        pool.submit([this, relative = std::move(relative), depth] { scanDirectory(relative, depth); });
+    }
+
+    void scanDirectory(const std::string& relative, int depth) {
+        std::string fullPath = relative.empty() ? root : root + "/" + relative;
+        int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+        if (!options.followSymlinks && !relative.empty()) {
+            flags |= O_NOFOLLOW;
+        }
+        int fd = ::open(fullPath.c_str(), flags);
+        if (fd < 0) {
+            recordFailure(relative, fullPath, errno);
+            return;
+        }
+
+        // Con enlaces simbólicos puede haber ciclos: cada directorio una vez
+        if (options.followSymlinks) {
+            struct stat info{};
+            if (::fstat(fd, &info) == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!visited.insert({static_cast<uint64_t>(info.st_dev), static_cast<uint64_t>(info.st_ino)}).second) {
+                    ::close(fd);
+                    return;
+                }
+            }
+        }
+
+        std::vector<LibraryIndexEntry> localFiles;
+        std::vector<std::string> subdirectories;
+        alignas(8) static thread_local char buffer[kDentsBufferSize];
+
+        while (true) {
+            long bytes = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (bytes < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // Listado incompleto: se trata como directorio ilegible
+                int error = errno;
+                ::close(fd);
+                recordFailure(relative, fullPath, error);
+                return;
+            }
+            if (bytes == 0) {
+                break;
+            }
+
+            for (long position = 0; position < bytes;) {
+                auto* entry = reinterpret_cast<LinuxDirent64*>(buffer + position);
+                position += entry->recordLength;
+                const char* name = entry->name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                    continue;
+                }
+                if (name[0] == '.' && !options.includeHidden) {
+                    continue;
+                }
+                handleEntry(fd, relative, depth, name, entry->type, localFiles, subdirectories);
+            }
+        }
+        ::close(fd);
+
+        for (auto& subdirectory : subdirectories) {
+            scheduleDirectory(std::move(subdirectory), depth + 1);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++directoryCount;
+        files.insert(files.end(), std::make_move_iterator(localFiles.begin()),
+                     std::make_move_iterator(localFiles.end()));
+    }
+
+    void handleEntry(int directoryFd, const std::string& relative, int depth, const char* name,
+                     unsigned char type, std::vector<LibraryIndexEntry>& localFiles,
+                     std::vector<std::string>& subdirectories) {
+        bool canDescend = depth < options.maxDepth;
+        if (type == DT_DIR) {
+            if (canDescend) {
+                subdirectories.push_back(joinPath(relative, name));
+            }
+            return;
+        }
+        if (type == DT_LNK && !options.followSymlinks) {
+            return;
+        }
+        // Lo que no es directorio solo interesa si tiene extensión multimedia,
+        // salvo enlaces y tipos desconocidos, que pueden ser directorios
+        bool isMediaName = mediaTypeFor(name) != nullptr;
+        if (type == DT_REG && !isMediaName) {
+            return;
+        }
+        if (type != DT_REG && type != DT_LNK && type != DT_UNKNOWN) {
+            return;
+        }
+
+        // AT_STATX_DONT_SYNC: en NFS/SMB vale lo que haya en caché sin
+        // preguntar al servidor por cada archivo
+        int flags = AT_STATX_DONT_SYNC | (type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW);
+        struct statx info{};
+        if (::statx(directoryFd, name, flags, kStatxMask, &info) != 0) {
+            return;
+        }
+        if (S_ISDIR(info.stx_mode)) {
+            if (canDescend) {
+                subdirectories.push_back(joinPath(relative, name));
+            }
+            return;
+        }
+        if (!S_ISREG(info.stx_mode) || !isMediaName) {
+            return;
+        }
+
+        LibraryIndexEntry file;
+        file.path = joinPath(relative, name);
+        file.device = makedev(info.stx_dev_major, info.stx_dev_minor);
+        file.inode = info.stx_ino;
+        file.size = static_cast<int64_t>(info.stx_size);
+        file.mtimeNs = static_cast<int64_t>(info.stx_mtime.tv_sec) * 1000000000LL + info.stx_mtime.tv_nsec;
+        localFiles.push_back(std::move(file));
+    }
+
+    void recordFailure(const std::string& relative, const std::string& fullPath, int error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::cerr << "No se pudo leer el directorio " << fullPath << ": " << std::strerror(error) << std::endl;
+        failedDirectories.push_back(relative);
+    }
+
+    const std::string& root;
+    const ScanOptions& options;
+    std::mutex mutex;
+    std::set<std::pair<uint64_t, uint64_t>> visited;
+    ThreadPool pool;
+};
+
+// True si `path` está dentro de alguno de los directorios (relativos)
+bool underAny(const std::string& path, const std::vector<std::string>& directories) {
+    for (const auto& directory : directories) {
+        if (directory.empty() ||
+            (path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 &&
+             path[directory.size()] == '/')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeEvent(std::ostream& out, const std::string& event, const std::string& root,
+                const LibraryIndexEntry& entry, const std::string* from = nullptr) {
+    JsonWriter json;
+    json.field("event", event).field("path", root + "/" + entry.path);
+    if (from) {
+        json.field("from", root + "/" + *from);
+    }
+    const char* type = mediaTypeFor(entry.path.c_str());
+    json.field("type", type ? type : "unknown");
+    if (event != "removed") {
+        json.field("size", entry.size)
+            .field("mtime", entry.mtimeNs / 1000000)
+            .field("inode", static_cast<int64_t>(entry.inode))
+            .field("hash", hashToHex(entry.partialHash));
+    }
+    out << json.str() << '\n';
+}
+
+struct TitleFingerprint {
+    size_t file = 0;
+    uint64_t titleHash = 0;
+    int64_t durationUs = 0;
+};
+
+// Compara todos los pares cercanos en duración: un popcount por par
+// aguanta bibliotecas de decenas de miles de títulos sin un índice por bits
+int64_t writeDuplicates(std::ostream& out, const std::string& root,
+                        const std::vector<LibraryIndexEntry>& files,
+                        std::vector<TitleFingerprint>& titles, int maxDistance) {
+    std::sort(titles.begin(), titles.end(), [](const TitleFingerprint& a, const TitleFingerprint& b) {
+        return a.durationUs < b.durationUs;
+    });
+
+    int64_t found = 0;
+    for (size_t i = 0; i < titles.size(); ++i) {
+        const TitleFingerprint& title = titles[i];
+        int64_t slack = std::max(kDuplicateDurationSlackUs,
+                                 title.durationUs * kDuplicateDurationPercent / 100);
+        for (size_t j = i + 1; j < titles.size() && titles[j].durationUs - title.durationUs <= slack; ++j) {
+            int distance = hammingDistance(title.titleHash, titles[j].titleHash);
+            if (distance > maxDistance) {
+                continue;
+            }
+            JsonWriter json;
+            json.field("event", "duplicate")
+                .field("path", root + "/" + files[title.file].path)
+                .field("other", root + "/" + files[titles[j].file].path)
+                .field("distance", distance);
+            out << json.str() << '\n';
+            ++found;
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+bool loadLibraryIndex(const std::string& indexPath, const std::string& root,
+                      std::vector<LibraryIndexEntry>& entries) {
+    entries.clear();
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    IndexReader reader(data);
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+    uint64_t count = 0;
+    std::string indexedRoot;
+    if (!reader.read(magic) || std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+        !reader.read(version) || version != kLibraryIndexVersion || !reader.read(reserved) ||
+        !reader.read(count) || !reader.readString(indexedRoot) || indexedRoot != root) {
+        return false;
+    }
+
+    // Cada entrada ocupa al menos 44 bytes: acota la reserva si el índice miente
+    entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, data.size() / 44)));
+    for (uint64_t i = 0; i < count; ++i) {
+        LibraryIndexEntry entry;
+        if (!reader.readString(entry.path) || !reader.read(entry.device) || !reader.read(entry.inode) ||
+            !reader.read(entry.size) || !reader.read(entry.mtimeNs) || !reader.read(entry.partialHash)) {
+            entries.clear();
+            return false;
+        }
+        entries.push_back(std::move(entry));
+    }
+    if (!reader.atEnd()) {
+        entries.clear();
+        return false;
+    }
+    return true;
+}
+
+void saveLibraryIndex(const std::string& indexPath, const std::string& root,
+                      const std::vector<LibraryIndexEntry>& entries) {
+    std::string data;
+    data.reserve(64 + entries.size() * 96);
+    data.append(kIndexMagic, sizeof(kIndexMagic));
+    appendValue(data, kLibraryIndexVersion);
+    appendValue(data, static_cast<uint32_t>(0));
+    appendValue(data, static_cast<uint64_t>(entries.size()));
+    appendString(data, root);
+    for (const auto& entry : entries) {
+        appendString(data, entry.path);
+        appendValue(data, entry.device);
+        appendValue(data, entry.inode);
+        appendValue(data, entry.size);
+        appendValue(data, entry.mtimeNs);
+        appendValue(data, entry.partialHash);
+    }
+
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), static_cast<std::streamsize>(data.size())) || !file.flush()) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("No se pudo escribir el índice: " + tempPath);
+        }
+    }
+    if (std::rename(tempPath.c_str(), indexPath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("No se pudo guardar el índice: " + indexPath);
+    }
+}
+
+ScanSummary scanLibrary(const std::string& rootPath, const ScanOptions& options, std::ostream& out) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::string root = rootPath;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    struct stat rootInfo{};
+    if (::stat(root.c_str(), &rootInfo) != 0 || !S_ISDIR(rootInfo.st_mode)) {
+        throw std::runtime_error("La ruta de la biblioteca no existe: " + root);
+    }
+    std::string indexPath = options.indexPath.empty() ? root + "/" + kDefaultIndexName : options.indexPath;
+
+    std::vector<LibraryIndexEntry> previous;
+    if (!loadLibraryIndex(indexPath, root, previous)) {
+        previous.clear();
+    }
+
+    size_t threads = options.threads > 0 ? static_cast<size_t>(options.threads)
+                                         : ThreadPool::defaultThreadCount() * 2;
+    Walker walker(root, options, threads);
+    walker.run();
+
+    ScanSummary summary;
+    summary.directories = walker.directoryCount;
+    summary.failedDirectories = static_cast<int64_t>(walker.failedDirectories.size());
+    std::vector<LibraryIndexEntry>& current = walker.files;
+    summary.files = static_cast<int64_t>(current.size());
+    std::sort(current.begin(), current.end(),
+              [](const LibraryIndexEntry& a, const LibraryIndexEntry& b) { return a.path < b.path; });
+
+    // Emparejar por ruta con el escaneo anterior
+    std::unordered_map<std::string, const LibraryIndexEntry*> previousByPath;
+    previousByPath.reserve(previous.size());
+    for (const auto& entry : previous) {
+        previousByPath.emplace(entry.path, &entry);
+    }
+
+    std::vector<size_t> addedCandidates;
+    std::vector<size_t> changedFiles;
+    std::vector<size_t> needsHash;
+    for (size_t i = 0; i < current.size(); ++i) {
+        LibraryIndexEntry& entry = current[i];
+        auto it = previousByPath.find(entry.path);
+        if (it == previousByPath.end()) {
+            addedCandidates.push_back(i);
+            needsHash.push_back(i);
+            continue;
+        }
+        const LibraryIndexEntry& old = *it->second;
+        previousByPath.erase(it);
+        if (old.size == entry.size && old.mtimeNs == entry.mtimeNs &&
+            old.inode == entry.inode && old.device == entry.device) {
+            entry.partialHash = old.partialHash;
+            ++summary.unchanged;
+        } else {
+            changedFiles.push_back(i);
+            needsHash.push_back(i);
+        }
+    }
+
+    // Lo que queda del índice anterior ha desaparecido, salvo que estuviera
+    // en un directorio que esta vez no se pudo leer
+    std::vector<LibraryIndexEntry> preserved;
+    std::vector<const LibraryIndexEntry*> missing;
+    for (const auto& entry : previous) {
+        if (previousByPath.count(entry.path) == 0) {
+            continue;
+        }
+        if (underAny(entry.path, walker.failedDirectories)) {
+            preserved.push_back(entry);
+        } else {
+            missing.push_back(&entry);
+        }
+    }
+
+    // Solo se leen los archivos nuevos o modificados
+    for (size_t index : needsHash) {
+        walker.threadPool().submit([&root, &current, index] {
+            LibraryIndexEntry& entry = current[index];
+            entry.partialHash = partialContentHash(root + "/" + entry.path, entry.size);
+        });
+    }
+    walker.threadPool().waitIdle();
+    summary.hashed = static_cast<int64_t>(needsHash.size());
+
+    // Movimientos: primero por inodo (renombrado), después por contenido
+    std::unordered_map<uint64_t, std::vector<size_t>> missingByInode;
+    std::unordered_map<uint64_t, std::vector<size_t>> missingByHash;
+    for (size_t i = 0; i < missing.size(); ++i) {
+        missingByInode[missing[i]->inode ^ (missing[i]->device << 32)].push_back(i);
+        if (missing[i]->partialHash != 0) {
+            missingByHash[missing[i]->partialHash].push_back(i);
+        }
+    }
+    std::vector<bool> missingUsed(missing.size(), false);
+    auto takeMatch = [&](std::unordered_map<uint64_t, std::vector<size_t>>& candidates, uint64_t key,
+                         const LibraryIndexEntry& entry, bool byInode) -> const LibraryIndexEntry* {
+        auto it = candidates.find(key);
+        if (it == candidates.end()) {
+            return nullptr;
+        }
+        for (size_t candidate : it->second) {
+            const LibraryIndexEntry& old = *missing[candidate];
+            bool matches = old.size == entry.size &&
+                           (byInode ? old.inode == entry.inode && old.device == entry.device
+                                    : old.partialHash == entry.partialHash);
+            if (!missingUsed[candidate] && matches) {
+                missingUsed[candidate] = true;
+                return &old;
+            }
+        }
+        return nullptr;
+    };
+
+    std::vector<std::pair<size_t, const LibraryIndexEntry*>> moves;
+    std::vector<size_t> added;
+    for (size_t index : addedCandidates) {
+        const LibraryIndexEntry& entry = current[index];
+        const LibraryIndexEntry* from = takeMatch(missingByInode, entry.inode ^ (entry.device << 32), entry, true);
+        if (!from && entry.partialHash != 0) {
+            from = takeMatch(missingByHash, entry.partialHash, entry, false);
+        }
+        if (from) {
+            moves.emplace_back(index, from);
+        } else {
+            added.push_back(index);
+        }
+    }
+
+    for (const auto& move : moves) {
+        writeEvent(out, "moved", root, current[move.first], &move.second->path);
+    }
+    for (size_t index : changedFiles) {
+        writeEvent(out, "changed", root, current[index]);
+    }
+    for (size_t index : added) {
+        writeEvent(out, "added", root, current[index]);
+    }
+    for (size_t i = 0; i < missing.size(); ++i) {
+        if (!missingUsed[i]) {
+            writeEvent(out, "removed", root, *missing[i]);
+            ++summary.removed;
+        }
+    }
+    summary.moved = static_cast<int64_t>(moves.size());
+    summary.changed = static_cast<int64_t>(changedFiles.size());
+    summary.added = static_cast<int64_t>(added.size());
+
+    // Solo los videos con un análisis vigente: no se decodifica nada aquí
+    if (options.duplicateDistance >= 0) {
+        // Cada tarea escribe solo su posición; titleHash == 0 = sin análisis
+        std::vector<TitleFingerprint> titles(current.size());
+        for (size_t i = 0; i < current.size(); ++i) {
+            const char* type = mediaTypeFor(current[i].path.c_str());
+            if (!type || std::strcmp(type, "video") != 0) {
+                continue;
+            }
+            walker.threadPool().submit([&, i] {
+                FrameAnalysis analysis;
+                if (readFrameAnalysis(root + "/" + current[i].path, analysis) &&
+                    analysis.header.titleHash != 0) {
+                    titles[i] = TitleFingerprint{i, analysis.header.titleHash, analysis.header.durationUs};
+                }
+            });
+        }
+        walker.threadPool().waitIdle();
+
+        std::vector<TitleFingerprint> usable;
+        for (const auto& title : titles) {
+            if (title.titleHash != 0) {
+                usable.push_back(title);
+            }
+        }
+        summary.duplicates = writeDuplicates(out, root, current, usable, options.duplicateDistance);
+    }
+
+    if (!options.dryRun) {
+        std::vector<LibraryIndexEntry> next = std::move(current);
+        if (!preserved.empty()) {
+            next.insert(next.end(), preserved.begin(), preserved.end());
+            std::sort(next.begin(), next.end(),
+                      [](const LibraryIndexEntry& a, const LibraryIndexEntry& b) { return a.path < b.path; });
+        }
+        saveLibraryIndex(indexPath, root, next);
+    }
+
+    summary.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+
+    JsonWriter json;
+    json.field("event", "summary")
+        .field("root", root)
+        .field("directories", summary.directories)
+        .field("files", summary.files)
+        .field("added", summary.added)
+        .field("changed", summary.changed)
+        .field("moved", summary.moved)
+        .field("removed", summary.removed)
+        .field("unchanged", summary.unchanged)
+        .field("hashed", summary.hashed)
+        .field("failedDirectories", summary.failedDirectories);
+    if (options.duplicateDistance >= 0) {
+        json.field("duplicates", summary.duplicates);
+    }
+    json.field("elapsedMs", summary.elapsedMs);
+    out << json.str() << std::endl;
+    return summary;
+}
+
+} // namespace StreamVio
@@ -0,0 +1,814 @@
+// StreamVio/core/src/server/file_server.cpp
+#include "server/file_server.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "server/http_parsing.h"
+#include "utils/json_writer.h"
+
+namespace StreamVio {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kMaxHeaderBytes = 16 * 1024;
+constexpr size_t kReadChunk = 16 * 1024;
+// Lo que una conexión puede enviar seguido antes de ceder el turno
+constexpr size_t kSendBudget = 4 * 1024 * 1024;
+constexpr int kMaxEvents = 256;
+constexpr int kMaxWorkers = 8;
+
+struct ResolvedMount {
+    std::string urlPrefix;      // Empieza y termina en '/'
+    std::string root;           // realpath del directorio, terminado en '/'
+};
+
+const char* mimeTypeFor(const std::string& path) {
+    static const std::unordered_map<std::string, const char*> types = {
+        {"m3u8", "application/vnd.apple.mpegurl"},
+        {"ts", "video/mp2t"},
+        {"m4s", "video/iso.segment"},
+        {"mp4", "video/mp4"},
+        {"m4v", "video/mp4"},
+        {"webm", "video/webm"},
+        {"mkv", "video/x-matroska"},
+        {"mov", "video/quicktime"},
+        {"avi", "video/x-msvideo"},
+        {"ogv", "video/ogg"},
+        {"ogg", "video/ogg"},
+        {"mp3", "audio/mpeg"},
+        {"m4a", "audio/mp4"},
+        {"aac", "audio/aac"},
+        {"flac", "audio/flac"},
+        {"wav", "audio/wav"},
+        {"vtt", "text/vtt; charset=utf-8"},
+        {"jpg", "image/jpeg"},
+        {"jpeg", "image/jpeg"},
+        {"png", "image/png"},
+        {"webp", "image/webp"},
+        {"json", "application/json"},
+    };
+
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos || path.find('/', dot) != std::string::npos) {
+        return "application/octet-stream";
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    auto it = types.find(extension);
+    return it != types.end() ? it->second : "application/octet-stream";
+}
+
+std::string queryParam(const std::string& query, const std::string& name) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        std::string pair = query.substr(pos, end - pos);
+        size_t equals = pair.find('=');
+        if (equals != std::string::npos && pair.compare(0, equals, name) == 0 && equals == name.size()) {
+            std::string value;
+            return percentDecode(pair.substr(equals + 1), value, true) ? value : std::string();
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+std::string cookieValue(const std::string& header, const std::string& name) {
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(';', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        size_t start = header.find_first_not_of(' ', pos);
+        if (start < end) {
+            size_t equals = header.find('=', start);
+            if (equals < end && header.compare(start, equals - start, name) == 0 &&
+                equals - start == name.size()) {
+                return header.substr(equals + 1, end - equals - 1);
+            }
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+int openListener(const std::string& address, int port) {
+    sockaddr_storage storage{};
+    socklen_t length = 0;
+    int family = AF_INET;
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+    if (::inet_pton(AF_INET, address.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(static_cast<uint16_t>(port));
+        length = sizeof(sockaddr_in);
+    } else if (::inet_pton(AF_INET6, address.c_str(), &v6->sin6_addr) == 1) {
+        family = AF_INET6;
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(static_cast<uint16_t>(port));
+        length = sizeof(sockaddr_in6);
+    } else {
+        throw std::runtime_error("Dirección de escucha no válida: " + address);
+    }
+
+    int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("No se pudo crear el socket: ") + std::strerror(errno));
+    }
+    int enable = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    // Cada worker escucha en su propio socket y el kernel reparte las conexiones
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) < 0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        std::string reason = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("No se pudo escuchar en " + address + ":" + std::to_string(port) + ": " + reason);
+    }
+    return fd;
+}
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Internal Server Error";
+    }
+}
+
+struct Connection {
+    int fd = -1;
+    std::string input;          // Bytes recibidos aún sin procesar
+    std::string output;         // Cabeceras (o respuesta de error) por enviar
+    size_t outputSent = 0;
+    int fileFd = -1;            // Cuerpo que se envía con sendfile
+    off_t fileOffset = 0;
+    int64_t fileRemaining = 0;
+    bool keepAlive = true;
+    bool waitingWritable = false;
+    Clock::time_point lastActivity;
+};
+
+struct Request {
+    std::string method;
+    std::string path;
+    std::string query;
+    bool keepAlive = true;
+    bool hasBody = false;
+    std::string range;
+    std::string authorization;
+    std::string cookie;
+};
+
+// False si la petición está mal formada
+bool parseRequest(const std::string& head, Request& request) {
+    size_t lineEnd = head.find("\r\n");
+    std::string requestLine = head.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = requestLine.rfind(' ');
+    if (firstSpace == std::string::npos || secondSpace == firstSpace) {
+        return false;
+    }
+    request.method = requestLine.substr(0, firstSpace);
+    std::string target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    std::string version = requestLine.substr(secondSpace + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        return false;
+    }
+    request.keepAlive = version == "HTTP/1.1";
+
+    // Forma absoluta "http://host/ruta" (peticiones a través de proxy)
+    if (target.compare(0, 7, "http://") == 0 || target.compare(0, 8, "https://") == 0) {
+        size_t slash = target.find('/', target.find("://") + 3);
+        target = slash == std::string::npos ? "/" : target.substr(slash);
+    }
+    size_t question = target.find('?');
+    std::string rawPath = target.substr(0, question);
+    request.query = question == std::string::npos ? "" : target.substr(question + 1);
+    if (rawPath.empty() || rawPath[0] != '/' || !percentDecode(rawPath, request.path, false)) {
+        return false;
+    }
+
+    size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == std::string::npos) {
+            end = head.size();
+        }
+        std::string line = head.substr(pos, end - pos);
+        pos = end + 2;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos || colon == 0) {
+            return false;
+        }
+        std::string name = toLower(line.substr(0, colon));
+        std::string value = trim(line.substr(colon + 1));
+        if (name == "connection") {
+            std::string lowered = toLower(value);
+            if (lowered.find("close") != std::string::npos) {
+                request.keepAlive = false;
+            } else if (lowered.find("keep-alive") != std::string::npos) {
+                request.keepAlive = true;
+            }
+        } else if (name == "range") {
+            request.range = value;
+        } else if (name == "authorization") {
+            request.authorization = value;
+        } else if (name == "cookie") {
+            request.cookie = value;
+        } else if (name == "transfer-encoding" || (name == "content-length" && value != "0")) {
+            request.hasBody = true;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+class FileServer::Worker {
+public:
+    Worker(FileServer& server, const std::vector<ResolvedMount>& mounts)
+        : server(server), mounts(mounts) {
+        listenFd = openListener(server.options.bindAddress, server.options.port);
+    }
+
+    ~Worker() {
+        for (auto& entry : connections) {
+            releaseFile(*entry.second);
+            ::close(entry.first);
+        }
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+        }
+    }
+
+    void run() {
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            std::cerr << "Error en epoll_create1: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+        // El eventfd de parada no se consume: despierta a todos los workers
+        watch(server.stopFd, EPOLLIN, EPOLL_CTL_ADD);
+
+        epoll_event events[kMaxEvents];
+        Clock::time_point lastSweep = Clock::now();
+        while (!server.stopping.load(std::memory_order_relaxed)) {
+            int count = ::epoll_wait(epollFd, events, kMaxEvents, 1000);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "Error en epoll_wait: " << std::strerror(errno) << std::endl;
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptConnections();
+                } else if (fd != server.stopFd) {
+                    handleEvent(fd, events[i].events);
+                }
+            }
+
+            Clock::time_point now = Clock::now();
+            if (now - lastSweep >= std::chrono::seconds(1)) {
+                closeIdleConnections(now);
+                lastSweep = now;
+            }
+        }
+    }
+
+private:
+    enum class FlushResult { Done, Pending, Closed };
+
+    void watch(int fd, uint32_t events, int operation) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        ::epoll_ctl(epollFd, operation, fd, &event);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    std::cerr << "Error en accept: " << std::strerror(errno) << std::endl;
+                }
+                return;
+            }
+            if (connections.size() >= static_cast<size_t>(server.options.maxConnectionsPerWorker)) {
+                ::close(fd);
+                continue;
+            }
+
+            // Las cabeceras salen con MSG_MORE junto al cuerpo; sin Nagle no
+            // se retrasa el último trozo de cada respuesta
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+            auto connection = std::make_unique<Connection>();
+            connection->fd = fd;
+            connection->lastActivity = Clock::now();
+            connections[fd] = std::move(connection);
+            watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+            server.counters.connections.fetch_add(1, std::memory_order_relaxed);
+            server.counters.activeConnections.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void handleEvent(int fd, uint32_t events) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) {
+            return;
+        }
+        Connection& connection = *it->second;
+
+        if (events & EPOLLERR) {
+            closeConnection(connection);
+            return;
+        }
+        if (connection.waitingWritable) {
+            if (events & (EPOLLOUT | EPOLLHUP)) {
+                FlushResult result = flush(connection);
+                if (result == FlushResult::Done) {
+                    connection.waitingWritable = false;
+                    watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD);
+                    // Puede haber peticiones encadenadas ya recibidas
+                    processInput(connection);
+                }
+            }
+            return;
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+            readInput(connection);
+        }
+    }
+
+    void readInput(Connection& connection) {
+        int fd = connection.fd;
+        bool peerClosed = false;
+        char buffer[kReadChunk];
+        while (true) {
+            ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                connection.input.append(buffer, static_cast<size_t>(n));
+                connection.lastActivity = Clock::now();
+                if (connection.input.size() > kMaxHeaderBytes) {
+                    break;
+                }
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (n < 0) {
+                closeConnection(connection);
+                return;
+            }
+            // El cliente ya no enviará más, pero aún se responde a lo recibido
+            peerClosed = true;
+            break;
+        }
+        if (peerClosed) {
+            connection.keepAlive = false;
+        }
+        processInput(connection);
+
+        auto it = connections.find(fd);
+        if (peerClosed && it != connections.end() && !it->second->waitingWritable) {
+            closeConnection(*it->second);
+        }
+    }
+
+    // Atiende las peticiones completas del buffer hasta que una respuesta
+    // quede pendiente de enviar o se cierre la conexión
+    void processInput(Connection& connection) {
+        while (true) {
+            size_t headEnd = connection.input.find("\r\n\r\n");
+            if (headEnd == std::string::npos) {
+                if (connection.input.size() > kMaxHeaderBytes) {
+                    connection.keepAlive = false;
+                    queueError(connection, 431, "HEADERS_TOO_LARGE", "Cabeceras demasiado grandes");
+                    finishQueued(connection);
+                }
+                return;
+            }
+
+            std::string head = connection.input.substr(0, headEnd);
+            connection.input.erase(0, headEnd + 4);
+            handleRequest(connection, head);
+
+            if (!finishQueued(connection)) {
+                return;
+            }
+        }
+    }
+
+    // Envía lo preparado; true si la conexión sigue lista para leer otra petición
+    bool finishQueued(Connection& connection) {
+        int fd = connection.fd;
+        FlushResult result = flush(connection);
+        if (result == FlushResult::Pending) {
+            connection.waitingWritable = true;
+            // Solo EPOLLOUT: con EPOLLRDHUP (por nivel) un cliente que cierra
+            // su lado mientras lee despacio despertaría a epoll_wait en bucle.
+            // El cierre se detecta al volver a leer, con recv() == 0.
+            watch(fd, EPOLLOUT, EPOLL_CTL_MOD);
+            return false;
+        }
+        return result == FlushResult::Done;
+    }
+
+    void handleRequest(Connection& connection, const std::string& head) {
+        server.counters.requests.fetch_add(1, std::memory_order_relaxed);
+
+        Request request;
+        if (!parseRequest(head, request)) {
+            connection.keepAlive = false;
+            queueError(connection, 400, "BAD_REQUEST", "Petición no válida");
+            return;
+        }
+        connection.keepAlive = request.keepAlive;
+        if (request.hasBody) {
+            // GET y HEAD no llevan cuerpo; no se intenta sincronizar el flujo
+            connection.keepAlive = false;
+            queueError(connection, 400, "BAD_REQUEST", "Petición con cuerpo no admitida");
+            return;
+        }
+
+        if (request.method == "OPTIONS") {
+            connection.output = "HTTP/1.1 204 No Content\r\n"
+                                "Access-Control-Allow-Origin: *\r\n"
+                                "Access-Control-Allow-Methods: GET, HEAD, OPTIONS\r\n"
+                                "Access-Control-Allow-Headers: Authorization, Range\r\n"
+                                "Access-Control-Max-Age: 86400\r\n";
+            connection.output += connectionHeader(connection) + "\r\n";
+            return;
+        }
+        if (request.method != "GET" && request.method != "HEAD") {
+            queueError(connection, 405, "METHOD_NOT_ALLOWED", "Método no permitido");
+            return;
+        }
+
+        if (server.options.requireAuth && !authorize(connection, request)) {
+            server.counters.unauthorized.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        int fileFd = openFile(request.path);
+        struct stat info{};
+        if (fileFd < 0 || ::fstat(fileFd, &info) < 0 || !S_ISREG(info.st_mode)) {
+            if (fileFd >= 0) {
+                ::close(fileFd);
+            }
+            server.counters.notFound.fetch_add(1, std::memory_order_relaxed);
+            queueError(connection, 404, "NOT_FOUND", "Archivo no encontrado");
+            return;
+        }
+
+        int64_t fileSize = info.st_size;
+        int64_t start = 0;
+        int64_t end = fileSize - 1;
+        int status = 200;
+        if (!request.range.empty()) {
+            RangeResult range = parseRange(request.range, fileSize, start, end);
+            if (range == RangeResult::Unsatisfiable) {
+                ::close(fileFd);
+                queueError(connection, 416, "RANGE_NOT_SATISFIABLE", "El rango solicitado no es válido",
+                           "Content-Range: bytes */" + std::to_string(fileSize) + "\r\n");
+                return;
+            }
+            if (range == RangeResult::Satisfiable) {
+                status = 206;
+            } else {
+                start = 0;
+                end = fileSize - 1;
+            }
+        }
+        int64_t length = fileSize > 0 ? end - start + 1 : 0;
+
+        std::string& out = connection.output;
+        out = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) + "\r\n";
+        out += std::string("Content-Type: ") + mimeTypeFor(request.path) + "\r\n";
+        out += "Content-Length: " + std::to_string(length) + "\r\n";
+        if (status == 206) {
+            out += "Content-Range: bytes " + std::to_string(start) + "-" + std::to_string(end) + "/" +
+                   std::to_string(fileSize) + "\r\n";
+        }
+        out += "Accept-Ranges: bytes\r\n"
+               "Cache-Control: no-cache\r\n"
+               "Access-Control-Allow-Origin: *\r\n"
+               "Access-Control-Expose-Headers: Content-Length, Content-Range, Accept-Ranges\r\n";
+        out += connectionHeader(connection) + "\r\n";
+
+        if (request.method == "HEAD" || length == 0) {
+            ::close(fileFd);
+            return;
+        }
+        ::posix_fadvise(fileFd, start, length, POSIX_FADV_SEQUENTIAL);
+        connection.fileFd = fileFd;
+        connection.fileOffset = static_cast<off_t>(start);
+        connection.fileRemaining = length;
+    }
+
+    bool authorize(Connection& connection, const Request& request) {
+        std::string token;
+        if (request.authorization.compare(0, 7, "Bearer ") == 0) {
+            token = trim(request.authorization.substr(7));
+        }
+        if (token.empty()) {
+            token = queryParam(request.query, "auth");
+        }
+        if (token.empty()) {
+            token = queryParam(request.query, "token");
+        }
+        if (token.empty()) {
+            token = cookieValue(request.cookie, "streamvio_token");
+        }
+        if (token.empty()) {
+            queueError(connection, 401, "TOKEN_REQUIRED", "Se requiere autenticación");
+            return false;
+        }
+
+        std::map<std::string, std::string> claims;
+        std::string error;
+        if (!server.verifier.verify(token, static_cast<int64_t>(std::time(nullptr)), claims, error)) {
+            queueError(connection, 401, error,
+                       error == "TOKEN_EXPIRED" ? "Token expirado" : "Token inválido");
+            return false;
+        }
+        return true;
+    }
+
+    // Descriptor del archivo pedido, o -1 si no está dentro de ningún montaje
+    int openFile(const std::string& path) const {
+        const ResolvedMount* mount = nullptr;
+        for (const auto& candidate : mounts) {
+            if (path.compare(0, candidate.urlPrefix.size(), candidate.urlPrefix) == 0 &&
+                (!mount || candidate.urlPrefix.size() > mount->urlPrefix.size())) {
+                mount = &candidate;
+            }
+        }
+        if (!mount) {
+            return -1;
+        }
+        std::string relative = path.substr(mount->urlPrefix.size());
+        if (!isSafeRelativePath(relative)) {
+            return -1;
+        }
+
+        // Los enlaces simbólicos se permiten mientras no salgan del montaje
+        char resolved[PATH_MAX];
+        if (!::realpath((mount->root + relative).c_str(), resolved) ||
+            std::strncmp(resolved, mount->root.c_str(), mount->root.size()) != 0) {
+            return -1;
+        }
+        return ::open(resolved, O_RDONLY | O_CLOEXEC);
+    }
+
+    std::string connectionHeader(const Connection& connection) const {
+        return connection.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    }
+
+    // Respuesta de error con el mismo cuerpo que errorMiddleware.js
+    void queueError(Connection& connection, int status, const std::string& code,
+                    const std::string& message, const std::string& extraHeaders = "") {
+        JsonWriter json;
+        json.field("error", code).field("message", message);
+        std::string body = json.str();
+
+        std::string& out = connection.output;
+        out = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) + "\r\n";
+        out += "Content-Type: application/json; charset=utf-8\r\n";
+        out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        out += "Access-Control-Allow-Origin: *\r\n";
+        out += extraHeaders;
+        out += connectionHeader(connection) + "\r\n";
+        out += body;
+    }
+
+    FlushResult flush(Connection& connection) {
+        size_t budget = kSendBudget;
+        while (connection.outputSent < connection.output.size()) {
+            int flags = MSG_NOSIGNAL | (connection.fileRemaining > 0 ? MSG_MORE : 0);
+            ssize_t n = ::send(connection.fd, connection.output.data() + connection.outputSent,
+                               connection.output.size() - connection.outputSent, flags);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return FlushResult::Pending;
+            }
+            if (n <= 0) {
+                closeConnection(connection);
+                return FlushResult::Closed;
+            }
+            connection.outputSent += static_cast<size_t>(n);
+            connection.lastActivity = Clock::now();
+        }
+
+        while (connection.fileRemaining > 0) {
+            if (budget == 0) {
+                // Turno agotado: EPOLLOUT volverá enseguida, tras las demás conexiones
+                return FlushResult::Pending;
+            }
+            size_t chunk = static_cast<size_t>(std::min<int64_t>(connection.fileRemaining,
+                                                                 static_cast<int64_t>(budget)));
+            ssize_t n = ::sendfile(connection.fd, connection.fileFd, &connection.fileOffset, chunk);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return FlushResult::Pending;
+            }
+            if (n <= 0) {
+                // Error o archivo truncado mientras se enviaba
+                closeConnection(connection);
+                return FlushResult::Closed;
+            }
+            connection.fileRemaining -= n;
+            budget -= static_cast<size_t>(n);
+            connection.lastActivity = Clock::now();
+            server.counters.bytesSent.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        }
+
+        server.counters.bytesSent.fetch_add(connection.output.size(), std::memory_order_relaxed);
+        releaseFile(connection);
+        connection.output.clear();
+        connection.outputSent = 0;
+        if (!connection.keepAlive) {
+            closeConnection(connection);
+            return FlushResult::Closed;
+        }
+        return FlushResult::Done;
+    }
+
+    void releaseFile(Connection& connection) {
+        if (connection.fileFd >= 0) {
+            ::close(connection.fileFd);
+            connection.fileFd = -1;
+        }
+        connection.fileRemaining = 0;
+    }
+
+    // Invalida `connection`
+    void closeConnection(Connection& connection) {
+        int fd = connection.fd;
+        releaseFile(connection);
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+        server.counters.activeConnections.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void closeIdleConnections(Clock::time_point now) {
+        auto timeout = std::chrono::seconds(server.options.idleTimeoutSeconds);
+        std::vector<Connection*> idle;
+        for (auto& entry : connections) {
+            if (now - entry.second->lastActivity > timeout) {
+                idle.push_back(entry.second.get());
+            }
+        }
+        for (Connection* connection : idle) {
+            closeConnection(*connection);
+        }
+    }
+
+    FileServer& server;
+    const std::vector<ResolvedMount>& mounts;
+    int listenFd = -1;
+    int epollFd = -1;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+};
+
+FileServer::FileServer(const FileServerOptions& options)
+    : options(options), verifier(options.jwtSecret) {
+    stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopFd < 0) {
+        throw std::runtime_error(std::string("No se pudo crear el eventfd: ") + std::strerror(errno));
+    }
+}
+
+FileServer::~FileServer() {
+    ::close(stopFd);
+}
+
+void FileServer::run() {
+    std::vector<ResolvedMount> mounts;
+    for (const auto& mount : options.mounts) {
+        char resolved[PATH_MAX];
+        if (!::realpath(mount.directory.c_str(), resolved)) {
+            throw std::runtime_error("No existe el directorio a servir: " + mount.directory);
+        }
+        ResolvedMount entry;
+        entry.urlPrefix = mount.urlPrefix;
+        if (entry.urlPrefix.empty() || entry.urlPrefix.front() != '/') {
+            entry.urlPrefix.insert(entry.urlPrefix.begin(), '/');
+        }
+        if (entry.urlPrefix.back() != '/') {
+            entry.urlPrefix += '/';
+        }
+        entry.root = resolved;
+        if (entry.root.back() != '/') {
+            entry.root += '/';
+        }
+        mounts.push_back(entry);
+    }
+    if (mounts.empty()) {
+        throw std::runtime_error("No hay ningún directorio que servir");
+    }
+
+    int workerCount = options.workers;
+    if (workerCount <= 0) {
+        workerCount = std::min(kMaxWorkers, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    }
+
+    // Todos los sockets se abren antes de arrancar hilos para que un error
+    // de bind llegue al llamador
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < workerCount; ++i) {
+        workers.push_back(std::make_unique<Worker>(*this, mounts));
+    }
+
+    std::cerr << "Servidor de archivos escuchando en " << options.bindAddress << ":" << options.port
+              << " (" << workerCount << " workers)" << std::endl;
+    for (const auto& mount : mounts) {
+        std::cerr << "  " << mount.urlPrefix << " -> " << mount.root << std::endl;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        threads.emplace_back([&workers, i] { workers[i]->run(); });
+    }
+    workers[0]->run();
+    // Si el primero termina por un error, los demás también deben parar
+    stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void FileServer::stop() {
+    stopping.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = ::write(stopFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+} // namespace StreamVio
@@ -0,0 +1,123 @@
+// StreamVio/core/src/server/http_parsing.cpp
+#include "server/http_parsing.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace StreamVio {
+
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseInt64(const std::string& text, int64_t& value) {
+    if (text.empty() || text.size() > 18 ||
+        !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return false;
+    }
+    value = std::stoll(text);
+    return true;
+}
+
+} // namespace
+
+bool percentDecode(const std::string& input, std::string& output, bool plusIsSpace) {
+    output.clear();
+    output.reserve(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        char c = input[i];
+        if (c == '%') {
+            if (i + 2 >= input.size()) {
+                return false;
+            }
+            int high = hexValue(input[i + 1]);
+            int low = hexValue(input[i + 2]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            c = static_cast<char>(high * 16 + low);
+            i += 2;
+        } else if (c == '+' && plusIsSpace) {
+            c = ' ';
+        }
+        if (c == '\0') {
+            return false;
+        }
+        output.push_back(c);
+    }
+    return true;
+}
+
+std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(start, end - start + 1);
+}
+
+RangeResult parseRange(const std::string& header, int64_t fileSize, int64_t& start, int64_t& end) {
+    std::string value = trim(header);
+    if (value.compare(0, 6, "bytes=") != 0 || value.find(',') != std::string::npos) {
+        return RangeResult::None;
+    }
+    value = trim(value.substr(6));
+    size_t dash = value.find('-');
+    if (dash == std::string::npos) {
+        return RangeResult::None;
+    }
+    std::string first = trim(value.substr(0, dash));
+    std::string last = trim(value.substr(dash + 1));
+
+    int64_t a = 0;
+    int64_t b = 0;
+    if (first.empty()) {
+        // Sufijo: los últimos n bytes
+        if (!parseInt64(last, b)) {
+            return RangeResult::None;
+        }
+        if (b == 0 || fileSize == 0) {
+            return RangeResult::Unsatisfiable;
+        }
+        start = std::max<int64_t>(0, fileSize - b);
+        end = fileSize - 1;
+        return RangeResult::Satisfiable;
+    }
+
+    if (!parseInt64(first, a) || (!last.empty() && (!parseInt64(last, b) || b < a))) {
+        return RangeResult::None;
+    }
+    if (a >= fileSize) {
+        return RangeResult::Unsatisfiable;
+    }
+    start = a;
+    end = last.empty() ? fileSize - 1 : std::min(b, fileSize - 1);
+    return RangeResult::Satisfiable;
+}
+
+bool isSafeRelativePath(const std::string& path) {
+    if (path.empty()) {
+        return false;
+    }
+    size_t pos = 0;
+    while (pos <= path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        std::string segment = path.substr(pos, end - pos);
+        if (segment.empty() || segment == "." || segment == "..") {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return true;
+}
+
+} // namespace StreamVio
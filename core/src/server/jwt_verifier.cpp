@@ -0,0 +1,153 @@
+// StreamVio/core/src/server/jwt_verifier.cpp
+#include "server/jwt_verifier.h"
+
+#include <memory>
+
+extern "C" {
+#include <libavutil/hmac.h>
+}
+
+#include "utils/json_reader.h"
+
+namespace StreamVio {
+
+namespace {
+
+const char* const kInvalidToken = "INVALID_TOKEN";
+const char* const kExpiredToken = "TOKEN_EXPIRED";
+
+int base64UrlValue(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-') return 62;
+    if (c == '_') return 63;
+    return -1;
+}
+
+// base64url sin relleno (RFC 7515). False si hay caracteres no válidos.
+bool decodeBase64Url(const std::string& input, std::string& output) {
+    output.clear();
+    output.reserve(input.size() * 3 / 4);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : input) {
+        int value = base64UrlValue(c);
+        if (value < 0) {
+            return false;
+        }
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+        }
+    }
+    // Un único carácter sobrante no puede codificar ningún byte
+    return bits < 6;
+}
+
+// Comparación en tiempo constante para no filtrar la firma por tiempos
+bool equalSignatures(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    unsigned char diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+// Campo numérico de fecha (segundos). False si existe pero no es un número.
+bool readTimeClaim(const std::map<std::string, std::string>& claims, const char* key,
+                   bool& present, int64_t& value) {
+    auto it = claims.find(key);
+    present = it != claims.end();
+    if (!present) {
+        return true;
+    }
+    try {
+        size_t used = 0;
+        value = static_cast<int64_t>(std::stod(it->second, &used));
+        return used == it->second.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace
+
+bool JwtVerifier::verify(const std::string& token, int64_t nowSeconds,
+                         std::map<std::string, std::string>& claims, std::string& error) const {
+    claims.clear();
+    error = kInvalidToken;
+
+    size_t firstDot = token.find('.');
+    size_t secondDot = firstDot == std::string::npos ? std::string::npos : token.find('.', firstDot + 1);
+    if (secondDot == std::string::npos || token.find('.', secondDot + 1) != std::string::npos) {
+        return false;
+    }
+
+    std::string headerJson;
+    std::string payloadJson;
+    std::string signature;
+    if (!decodeBase64Url(token.substr(0, firstDot), headerJson) ||
+        !decodeBase64Url(token.substr(firstDot + 1, secondDot - firstDot - 1), payloadJson) ||
+        !decodeBase64Url(token.substr(secondDot + 1), signature)) {
+        return false;
+    }
+
+    std::map<std::string, std::string> header;
+    try {
+        header = parseFlatJsonObject(headerJson);
+        claims = parseFlatJsonObject(payloadJson);
+    } catch (const std::exception&) {
+        claims.clear();
+        return false;
+    }
+
+    // Solo HS256: aceptar el algoritmo que diga el propio token permitiría
+    // falsificarlo con "none"
+    auto alg = header.find("alg");
+    if (alg == header.end() || alg->second != "HS256") {
+        claims.clear();
+        return false;
+    }
+
+    std::unique_ptr<AVHMAC, decltype(&av_hmac_free)> hmac(av_hmac_alloc(AV_HMAC_SHA256), av_hmac_free);
+    if (!hmac) {
+        claims.clear();
+        return false;
+    }
+    uint8_t expected[32];
+    av_hmac_calc(hmac.get(),
+                 reinterpret_cast<const uint8_t*>(token.data()), static_cast<unsigned int>(secondDot),
+                 reinterpret_cast<const uint8_t*>(secret.data()), static_cast<unsigned int>(secret.size()),
+                 expected, sizeof(expected));
+    if (!equalSignatures(signature, std::string(reinterpret_cast<const char*>(expected), sizeof(expected)))) {
+        claims.clear();
+        return false;
+    }
+
+    bool hasExpiry = false;
+    bool hasNotBefore = false;
+    int64_t expiry = 0;
+    int64_t notBefore = 0;
+    if (!readTimeClaim(claims, "exp", hasExpiry, expiry) ||
+        !readTimeClaim(claims, "nbf", hasNotBefore, notBefore) ||
+        (hasNotBefore && nowSeconds < notBefore)) {
+        claims.clear();
+        return false;
+    }
+    if (hasExpiry && nowSeconds >= expiry) {
+        claims.clear();
+        error = kExpiredToken;
+        return false;
+    }
+
+    error.clear();
+    return true;
+}
+
+} // namespace StreamVio
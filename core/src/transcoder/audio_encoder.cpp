@@ -0,0 +1,194 @@
+// StreamVio/core/src/transcoder/audio_encoder.cpp
+#include "transcoder/audio_encoder.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+}
+
+namespace StreamVio {
+
+namespace {
+
+AVSampleFormat preferredSampleFormat(const AVCodec* codec) {
+    if (codec->id == AV_CODEC_ID_AAC) {
+        return AV_SAMPLE_FMT_FLTP; // Único formato del codificador aac nativo
+    }
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* formats = nullptr;
+    int count = 0;
+    if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_SAMPLE_FORMAT, 0,
+                                     &formats, &count) >= 0 && formats && count > 0) {
+        return static_cast<const AVSampleFormat*>(formats)[0];
+    }
+#else
+    if (codec->sample_fmts) {
+        return codec->sample_fmts[0];
+    }
+#endif
+    return AV_SAMPLE_FMT_FLTP;
+}
+
+std::string describeLayout(const AVChannelLayout& layout) {
+    char buffer[128] = {0};
+    av_channel_layout_describe(&layout, buffer, sizeof(buffer));
+    return buffer;
+}
+
+} // namespace
+
+AudioEncoder::AudioEncoder(const AVStream* inputStream, const AudioEncoderConfig& config)
+    : decodedFrame(av_frame_alloc()), filteredFrame(av_frame_alloc()) {
+    decoder = openDecoder(inputStream);
+
+    const AVCodec* codec = avcodec_find_encoder_by_name(config.codecName.c_str());
+    if (!codec) {
+        throw std::runtime_error("Codificador de audio no disponible: " + config.codecName);
+    }
+
+    encoder.reset(avcodec_alloc_context3(codec));
+    if (!encoder) {
+        throw std::runtime_error("No se pudo reservar el contexto del codificador de audio");
+    }
+
+    int channels = std::min(decoder->ch_layout.nb_channels, config.maxChannels);
+    av_channel_layout_default(&encoder->ch_layout, channels > 0 ? channels : 2);
+    encoder->sample_rate = std::min(decoder->sample_rate, config.maxSampleRate);
+    encoder->sample_fmt = preferredSampleFormat(codec);
+    encoder->bit_rate = static_cast<int64_t>(config.bitrateKbps) * 1000;
+    encoder->time_base = AVRational{1, encoder->sample_rate};
+    if (config.globalHeader) {
+        encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    int ret = avcodec_open2(encoder.get(), codec, nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo abrir el codificador de audio: " + avErrorToString(ret));
+    }
+
+    buildFilterGraph(inputStream);
+}
+
+void AudioEncoder::buildFilterGraph(const AVStream* inputStream) {
+    graph.reset(avfilter_graph_alloc());
+    if (!graph) {
+        throw std::runtime_error("No se pudo reservar el grafo de filtros de audio");
+    }
+
+    std::string sourceArgs =
+        "time_base=" + std::to_string(inputStream->time_base.num) + "/" +
+        std::to_string(inputStream->time_base.den) +
+        ":sample_rate=" + std::to_string(decoder->sample_rate) +
+        ":sample_fmt=" + av_get_sample_fmt_name(decoder->sample_fmt) +
+        ":channel_layout=" + describeLayout(decoder->ch_layout);
+
+    std::string formatArgs =
+        std::string("sample_fmts=") + av_get_sample_fmt_name(encoder->sample_fmt) +
+        ":sample_rates=" + std::to_string(encoder->sample_rate) +
+        ":channel_layouts=" + describeLayout(encoder->ch_layout);
+
+    AVFilterContext* formatCtx = nullptr;
+    int ret = avfilter_graph_create_filter(&sourceCtx, avfilter_get_by_name("abuffer"), "in",
+                                           sourceArgs.c_str(), nullptr, graph.get());
+    if (ret >= 0) {
+        ret = avfilter_graph_create_filter(&formatCtx, avfilter_get_by_name("aformat"), "format",
+                                           formatArgs.c_str(), nullptr, graph.get());
+    }
+    if (ret >= 0) {
+        ret = avfilter_graph_create_filter(&sinkCtx, avfilter_get_by_name("abuffersink"), "out",
+                                           nullptr, nullptr, graph.get());
+    }
+    if (ret >= 0) {
+        ret = avfilter_link(sourceCtx, 0, formatCtx, 0);
+    }
+    if (ret >= 0) {
+        ret = avfilter_link(formatCtx, 0, sinkCtx, 0);
+    }
+    if (ret >= 0) {
+        ret = avfilter_graph_config(graph.get(), nullptr);
+    }
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo configurar el grafo de audio: " + avErrorToString(ret));
+    }
+
+    // El codificador exige frames de tamaño fijo (1024 muestras en AAC)
+    if (encoder->frame_size > 0 &&
+        !(encoder->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)) {
+        av_buffersink_set_frame_size(sinkCtx, encoder->frame_size);
+    }
+}
+
+void AudioEncoder::encode(const AVPacket* packet, std::vector<PacketPtr>& output) {
+    int ret = avcodec_send_packet(decoder.get(), packet);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        // Paquete corrupto: se descarta sin detener la transcodificación
+        return;
+    }
+
+    while ((ret = avcodec_receive_frame(decoder.get(), decodedFrame.get())) >= 0) {
+        decodedFrame->pts = decodedFrame->best_effort_timestamp;
+        ret = av_buffersrc_add_frame_flags(sourceCtx, decodedFrame.get(), 0);
+        av_frame_unref(decodedFrame.get());
+        if (ret < 0) {
+            throw std::runtime_error("Error al filtrar audio: " + avErrorToString(ret));
+        }
+        drainFilter(output, false);
+    }
+
+    if (!packet) {
+        av_buffersrc_add_frame_flags(sourceCtx, nullptr, 0);
+        drainFilter(output, true);
+    }
+}
+
+void AudioEncoder::drainFilter(std::vector<PacketPtr>& output, bool flushing) {
+    AVRational sinkTimeBase = av_buffersink_get_time_base(sinkCtx);
+
+    while (true) {
+        int ret = av_buffersink_get_frame(sinkCtx, filteredFrame.get());
+        if (ret == AVERROR(EAGAIN)) {
+            return;
+        }
+        if (ret == AVERROR_EOF) {
+            if (flushing) {
+                avcodec_send_frame(encoder.get(), nullptr);
+                drainEncoder(output);
+            }
+            return;
+        }
+        if (ret < 0) {
+            throw std::runtime_error("Error al leer audio filtrado: " + avErrorToString(ret));
+        }
+
+        if (filteredFrame->pts != AV_NOPTS_VALUE) {
+            filteredFrame->pts = av_rescale_q(filteredFrame->pts, sinkTimeBase, encoder->time_base);
+        }
+        ret = avcodec_send_frame(encoder.get(), filteredFrame.get());
+        av_frame_unref(filteredFrame.get());
+        if (ret < 0) {
+            throw std::runtime_error("Error al codificar audio: " + avErrorToString(ret));
+        }
+        drainEncoder(output);
+    }
+}
+
+void AudioEncoder::drainEncoder(std::vector<PacketPtr>& output) {
+    while (true) {
+        PacketPtr packet(av_packet_alloc());
+        int ret = avcodec_receive_packet(encoder.get(), packet.get());
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return;
+        }
+        if (ret < 0) {
+            throw std::runtime_error("Error al recibir audio codificado: " + avErrorToString(ret));
+        }
+        output.push_back(std::move(packet));
+    }
+}
+
+} // namespace StreamVio
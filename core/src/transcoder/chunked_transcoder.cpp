@@ -0,0 +1,802 @@
+// StreamVio/core/src/transcoder/chunked_transcoder.cpp
+#include "transcoder/chunked_transcoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "analyzer/keyframe_index.h"
+#include "transcoder/audio_encoder.h"
+#include "transcoder/file_transcoder.h"
+#include "transcoder/video_encoder.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/json_reader.h"
+#include "utils/json_writer.h"
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int kManifestVersion = 1;
+const char* const kManifestName = "manifest.ndjson";
+const char* const kAudioTask = "audio";
+
+// Un codificador H.264/HEVC apenas escala más allá de 8-16 hilos: con más
+// núcleos compensa tener varios trozos en vuelo
+const int kThreadsPerChunk = 8;
+
+// Los trozos intermedios van en NUT, que guarda las marcas de tiempo en la
+// base de tiempo del stream sin redondear
+const char* const kChunkMuxer = "nut";
+
+std::string chunkTaskName(size_t index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "chunk_%05zu", index);
+    return name;
+}
+
+// Opciones que determinan el resultado: si cambian, los trozos guardados no sirven
+std::string settingsSignature(const TranscodeOptions& options) {
+    return JsonWriter()
+        .field("format", options.outputFormat)
+        .field("vcodec", options.videoCodec)
+        .field("acodec", options.audioCodec)
+        .field("vbitrate", options.videoBitrate)
+        .field("abitrate", options.audioBitrate)
+        .field("width", options.width)
+        .field("height", options.height)
+        .str();
+}
+
+// Lanzada por una tarea que se detiene porque otra ha fallado
+struct ChunkStopped {};
+
+// Diario de tareas terminadas: una cabecera que identifica entrada y
+// opciones, y una línea por tarea. Solo se añaden líneas, así que un corte
+// deja como mucho una línea incompleta, que se ignora al reanudar.
+class ChunkManifest {
+public:
+    ChunkManifest(const fs::path& workDir, const std::string& header) : path(workDir / kManifestName) {
+        std::ifstream existing(path);
+        std::string line;
+        if (existing && std::getline(existing, line) && line == header) {
+            while (std::getline(existing, line)) {
+                try {
+                    auto entry = parseFlatJsonObject(line);
+                    auto it = entry.find("done");
+                    if (it != entry.end()) {
+                        done.insert(it->second);
+                    }
+                } catch (const std::exception&) {
+                    // Línea a medio escribir
+                }
+            }
+            existing.close();
+            out.open(path, std::ios::app);
+        } else {
+            // Otra entrada u otras opciones: se empieza de cero
+            existing.close();
+            std::error_code ec;
+            fs::remove_all(workDir, ec);
+            fs::create_directories(workDir);
+            out.open(path, std::ios::trunc);
+            out << header << '\n';
+            out.flush();
+        }
+        if (!out) {
+            throw std::runtime_error("No se pudo escribir el manifiesto " + path.string());
+        }
+    }
+
+    bool isDone(const std::string& task) const { return done.count(task) > 0; }
+
+    void markDone(const std::string& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.insert(task);
+        out << JsonWriter().field("done", task).str() << '\n';
+        out.flush();
+    }
+
+private:
+    fs::path path;
+    std::set<std::string> done;
+    std::ofstream out;
+    std::mutex mutex;
+};
+
+void writeChunkPacket(AVFormatContext* output, AVPacket* packet, AVRational sourceTimeBase, int outputIndex) {
+    av_packet_rescale_ts(packet, sourceTimeBase, output->streams[outputIndex]->time_base);
+    packet->stream_index = outputIndex;
+    packet->pos = -1;
+    int ret = av_interleaved_write_frame(output, packet);
+    if (ret < 0) {
+        throw std::runtime_error("Error al escribir " + std::string(output->url) + ": " + avErrorToString(ret));
+    }
+}
+
+// Cierra un archivo intermedio y lo publica con su nombre definitivo
+void finishChunkFile(OutputFormatPtr& output, const fs::path& temporary, const fs::path& final) {
+    int ret = av_write_trailer(output.get());
+    if (ret < 0) {
+        throw std::runtime_error("Error al finalizar " + temporary.string() + ": " + avErrorToString(ret));
+    }
+    output.reset();
+    fs::rename(temporary, final);
+}
+
+// av_read_frame contado como demux
+int readTimedPacket(AVFormatContext* input, AVPacket* packet, TranscodeMetrics* metrics) {
+    StageTimer timer(metrics, TranscodeStage::Demux);
+    int ret = av_read_frame(input, packet);
+    if (ret >= 0 && metrics) {
+        metrics->addBytesIn(static_cast<uint64_t>(packet->size));
+    }
+    return ret;
+}
+
+bool sameExtradata(const AVCodecParameters* a, const AVCodecParameters* b) {
+    return a->extradata_size == b->extradata_size &&
+           (a->extradata_size == 0 || std::memcmp(a->extradata, b->extradata, a->extradata_size) == 0);
+}
+
+class ChunkedTranscoder {
+public:
+    ChunkedTranscoder(const std::string& inputPath,
+                      const std::string& outputPath,
+                      const TranscodeOptions& options,
+                      std::function<void(int)> progressCallback,
+                      JobControl* control,
+                      TranscodeMetrics* metrics);
+
+    void run();
+
+private:
+    // Devuelve false si no compensa trocear
+    bool prepare();
+    void runTasks();
+    void encodeChunk(size_t index);
+    void encodeAudio();
+    void concatenate();
+
+    void checkpoint();
+    void recordError(std::exception_ptr error);
+    int64_t chunkSpanUs(size_t index) const;
+    void reportProgress();
+
+    std::string inputPath;
+    std::string outputPath;
+    TranscodeOptions options;
+    std::function<void(int)> progressCallback;
+    JobControl* control;
+    TranscodeMetrics* metrics;
+
+    fs::path workDir;
+    TranscodePlan plan;
+    bool globalHeader = false;
+    AVRational videoTimeBase{1, 1};
+    AVRational frameRate{25, 1};
+    int64_t streamStart = 0;
+    int64_t durationUs = 0;
+    int64_t chunkUs = 0;
+    // Límite inferior de cada trozo en pts del stream de video
+    std::vector<int64_t> chunkStarts;
+    size_t chunkCount = 0;
+    size_t parallelChunks = 1;
+    int threadsPerChunk = 1;
+
+    std::unique_ptr<ChunkManifest> manifest;
+    // Microsegundos ya codificados de cada trozo
+    std::unique_ptr<std::atomic<int64_t>[]> chunkProgressUs;
+    int lastProgress = -1;
+
+    std::atomic<bool> stopping{false};
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+};
+
+ChunkedTranscoder::ChunkedTranscoder(const std::string& inputPath,
+                                     const std::string& outputPath,
+                                     const TranscodeOptions& options,
+                                     std::function<void(int)> progressCallback,
+                                     JobControl* control,
+                                     TranscodeMetrics* metrics)
+    : inputPath(inputPath), outputPath(outputPath), options(options),
+      progressCallback(std::move(progressCallback)), control(control), metrics(metrics),
+      workDir(outputPath + ".chunks") {}
+
+void ChunkedTranscoder::run() {
+    initializeFFmpeg();
+
+    if (!prepare()) {
+        transcodeFile(inputPath, outputPath, options, progressCallback, control, nullptr, metrics);
+        return;
+    }
+
+    runTasks();
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+
+    concatenate();
+
+    std::error_code ec;
+    fs::remove_all(workDir, ec);
+
+    if (progressCallback) {
+        progressCallback(100);
+    }
+}
+
+bool ChunkedTranscoder::prepare() {
+    InputFormatPtr input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    plan = planTranscode(input.get(), outputPath, options);
+    durationUs = input->duration;
+    chunkUs = static_cast<int64_t>(options.chunkSeconds) * AV_TIME_BASE;
+    // Copiar video va a velocidad de E/S: trocear no aporta nada
+    if (plan.video != StreamAction::Transcode || durationUs <= 0 || chunkUs <= 0) {
+        return false;
+    }
+
+    AVStream* stream = input->streams[plan.videoIndex];
+    videoTimeBase = stream->time_base;
+    streamStart = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    // Límites nominales cada chunkSeconds. Si hay índice de keyframes se
+    // ajustan al keyframe real, lo que evita trozos vacíos cuando el GOP es
+    // más largo que el trozo y permite buscar el inicio exacto
+    auto index = KeyframeIndex::open(keyframeIndexPath(inputPath), inputPath);
+    const KeyframeIndexStream* indexed = index ? index->findStream(plan.videoIndex) : nullptr;
+    size_t nominalCount = static_cast<size_t>((durationUs + chunkUs - 1) / chunkUs);
+    chunkStarts.push_back(streamStart);
+    for (size_t k = 1; k < nominalCount; ++k) {
+        int64_t nominal = streamStart + av_rescale_q(static_cast<int64_t>(k) * chunkUs,
+                                                     AVRational{1, AV_TIME_BASE}, videoTimeBase);
+        if (!indexed) {
+            chunkStarts.push_back(nominal);
+            continue;
+        }
+        const KeyframeIndexEntry* keyframe = index->keyframeAtOrAfter(*indexed, nominal);
+        if (!keyframe) {
+            break;
+        }
+        if (keyframe->pts > chunkStarts.back()) {
+            chunkStarts.push_back(keyframe->pts);
+        }
+    }
+    chunkCount = chunkStarts.size();
+    if (chunkCount < 2) {
+        return false;
+    }
+    frameRate = av_guess_frame_rate(input.get(), stream, nullptr);
+    if (frameRate.num <= 0 || frameRate.den <= 0) {
+        frameRate = AVRational{25, 1};
+    }
+
+    const AVOutputFormat* format =
+        av_guess_format(plan.muxerName.empty() ? nullptr : plan.muxerName.c_str(), outputPath.c_str(), nullptr);
+    globalHeader = format && (format->flags & AVFMT_GLOBALHEADER);
+
+    // `threads` es el total del trabajo; cada trozo se lleva una parte
+    int totalThreads = options.threads > 0 ? options.threads : static_cast<int>(ThreadPool::defaultThreadCount());
+    if (options.chunkJobs > 0) {
+        parallelChunks = static_cast<size_t>(options.chunkJobs);
+        threadsPerChunk = std::max(1, totalThreads / options.chunkJobs);
+    } else {
+        threadsPerChunk = std::min(kThreadsPerChunk, totalThreads);
+        parallelChunks = static_cast<size_t>(std::max(1, totalThreads / threadsPerChunk));
+    }
+    parallelChunks = std::min(parallelChunks, chunkCount);
+
+    std::string startsJson = "[";
+    for (size_t i = 0; i < chunkCount; ++i) {
+        startsJson += (i ? "," : "") + std::to_string(chunkStarts[i]);
+    }
+    startsJson += "]";
+    std::string header = JsonWriter()
+        .field("version", kManifestVersion)
+        .field("input", inputPath)
+        .field("size", static_cast<int64_t>(fs::file_size(inputPath)))
+        .field("mtime", static_cast<int64_t>(fs::last_write_time(inputPath).time_since_epoch().count()))
+        .raw("settings", settingsSignature(options))
+        .field("chunkSeconds", options.chunkSeconds)
+        .raw("starts", startsJson)
+        .str();
+    manifest = std::make_unique<ChunkManifest>(workDir, header);
+
+    chunkProgressUs.reset(new std::atomic<int64_t>[chunkCount]);
+    for (size_t i = 0; i < chunkCount; ++i) {
+        chunkProgressUs[i] = 0;
+    }
+    return true;
+}
+
+void ChunkedTranscoder::runTasks() {
+    std::vector<std::function<void()>> tasks;
+    bool audioPending = plan.audio != StreamAction::None &&
+                        !(manifest->isDone(kAudioTask) && fs::exists(workDir / "audio.nut"));
+    if (audioPending) {
+        tasks.push_back([this]() { encodeAudio(); });
+    }
+    for (size_t i = 0; i < chunkCount; ++i) {
+        std::string name = chunkTaskName(i);
+        if (manifest->isDone(name) && fs::exists(workDir / (name + ".nut"))) {
+            chunkProgressUs[i] = chunkSpanUs(i);
+        } else {
+            tasks.push_back([this, i]() { encodeChunk(i); });
+        }
+    }
+    if (tasks.empty()) {
+        return;
+    }
+
+    std::mutex doneMutex;
+    std::condition_variable allDone;
+    size_t remaining = tasks.size();
+
+    // El audio es una pasada ligera que va en paralelo con los trozos
+    ThreadPool pool(parallelChunks + (audioPending ? 1 : 0), tasks.size());
+    for (auto& task : tasks) {
+        pool.submit([&, task]() {
+            if (!stopping) {
+                try {
+                    task();
+                } catch (const ChunkStopped&) {
+                    // Otra tarea falló y ya registró el error
+                } catch (...) {
+                    recordError(std::current_exception());
+                }
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0) {
+                allDone.notify_all();
+            }
+        });
+    }
+
+    // El progreso se notifica siempre desde este hilo
+    std::unique_lock<std::mutex> lock(doneMutex);
+    while (!allDone.wait_for(lock, std::chrono::milliseconds(500), [&]() { return remaining == 0; })) {
+        lock.unlock();
+        reportProgress();
+        lock.lock();
+    }
+}
+
+void ChunkedTranscoder::encodeChunk(size_t index) {
+    InputFormatPtr input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+    for (unsigned i = 0; i < input->nb_streams; ++i) {
+        if (static_cast<int>(i) != plan.videoIndex) {
+            input->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVStream* stream = input->streams[plan.videoIndex];
+    TranscodeOptions chunkOptions = options;
+    chunkOptions.threads = threadsPerChunk;
+    CodecContextPtr decoder = openDecoder(stream, threadsPerChunk);
+    CodecContextPtr encoder = openVideoEncoder(
+        videoEncoderConfigFor(input.get(), stream, decoder.get(), plan, chunkOptions, globalHeader));
+
+    fs::path finalPath = workDir / (chunkTaskName(index) + ".nut");
+    fs::path temporaryPath = finalPath.string() + ".tmp";
+    OutputFormatPtr output = createOutput(temporaryPath.string(), kChunkMuxer);
+    AVStream* outStream = avformat_new_stream(output.get(), nullptr);
+    if (!outStream) {
+        throw std::runtime_error("No se pudo crear el stream del trozo");
+    }
+    avcodec_parameters_from_context(outStream->codecpar, encoder.get());
+    outStream->time_base = encoder->time_base;
+    writeOutputHeader(output.get(), temporaryPath.string());
+
+    // Límites del trozo; los reales son el primer keyframe con PTS >= cada
+    // límite, así que el trozo anterior y este coinciden exactamente en el
+    // mismo frame sin haberse comunicado
+    bool first = index == 0;
+    bool last = index + 1 == chunkCount;
+    int64_t nominalStart = chunkStarts[index];
+    int64_t nominalEnd = last ? INT64_MAX : chunkStarts[index + 1];
+    if (!first) {
+        // Keyframe anterior al límite; si la entrada no admite búsquedas se
+        // lee desde el principio, que es más lento pero da el mismo resultado
+        avformat_seek_file(input.get(), plan.videoIndex, INT64_MIN, nominalStart, nominalStart, 0);
+    }
+
+    bool started = first;
+    bool endFound = false;
+    int64_t startPts = INT64_MIN;
+    int64_t endPts = INT64_MAX;
+
+    FramePtr decoded(av_frame_alloc());
+    FramePtr scaled = allocVideoFrame(encoder->width, encoder->height, encoder->pix_fmt);
+    PacketPtr packet(av_packet_alloc());
+    PacketPtr encoded(av_packet_alloc());
+    SwsContextPtr scaler;
+    if (!decoded || !packet || !encoded) {
+        throw std::bad_alloc();
+    }
+
+    auto writeEncoded = [&](AVPacket* p) {
+        writeChunkPacket(output.get(), p, encoder->time_base, 0);
+        if (metrics) {
+            metrics->addFrames(1);
+        }
+    };
+    auto receiveDecoded = [&]() {
+        StageTimer timer(metrics, TranscodeStage::Decode);
+        return avcodec_receive_frame(decoder.get(), decoded.get());
+    };
+    auto encodeDecodedFrames = [&]() {
+        int result;
+        while ((result = receiveDecoded()) >= 0) {
+            int64_t pts = decoded->best_effort_timestamp;
+            if (pts != AV_NOPTS_VALUE && pts >= startPts && pts < endPts) {
+                {
+                    StageTimer timer(metrics, TranscodeStage::Scale);
+                    scaler.reset(sws_getCachedContext(scaler.release(), decoded->width, decoded->height,
+                                                      static_cast<AVPixelFormat>(decoded->format),
+                                                      scaled->width, scaled->height,
+                                                      static_cast<AVPixelFormat>(scaled->format),
+                                                      SWS_BICUBIC, nullptr, nullptr, nullptr));
+                    if (!scaler) {
+                        throw std::runtime_error("No se pudo crear el escalador");
+                    }
+                    int writable = av_frame_make_writable(scaled.get());
+                    if (writable < 0) {
+                        throw std::runtime_error("No se pudo reutilizar el frame escalado: " + avErrorToString(writable));
+                    }
+                    sws_scale(scaler.get(), decoded->data, decoded->linesize, 0, decoded->height,
+                              scaled->data, scaled->linesize);
+                }
+                scaled->pts = pts;
+                {
+                    StageTimer timer(metrics, TranscodeStage::Encode);
+                    encodeVideoFrame(encoder.get(), scaled.get(), encoded.get(), writeEncoded);
+                }
+
+                int64_t doneUs = av_rescale_q(pts - nominalStart, videoTimeBase, AVRational{1, AV_TIME_BASE});
+                chunkProgressUs[index] = std::max<int64_t>(0, std::min(doneUs, chunkSpanUs(index)));
+            }
+            av_frame_unref(decoded.get());
+        }
+        if (result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
+            throw std::runtime_error("Error al decodificar video: " + avErrorToString(result));
+        }
+    };
+
+    while ((ret = readTimedPacket(input.get(), packet.get(), metrics)) >= 0) {
+        checkpoint();
+        if (packet->stream_index != plan.videoIndex) {
+            av_packet_unref(packet.get());
+            continue;
+        }
+        int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+        bool key = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+
+        if (!started) {
+            if (!key || pts == AV_NOPTS_VALUE || pts < nominalStart) {
+                av_packet_unref(packet.get());
+                continue;
+            }
+            started = true;
+            startPts = pts;
+        }
+        if (!endFound && !last && key && pts != AV_NOPTS_VALUE && pts >= nominalEnd) {
+            endFound = true;
+            endPts = pts;
+            if (endPts <= startPts) {
+                // GOP más largo que el trozo: el siguiente empieza en este
+                // mismo keyframe y este queda vacío
+                av_packet_unref(packet.get());
+                break;
+            }
+            // El keyframe final se decodifica igualmente: los frames "leading"
+            // de un GOP abierto que lo siguen lo usan como referencia
+        } else if (endFound && (pts == AV_NOPTS_VALUE || pts >= endPts)) {
+            av_packet_unref(packet.get());
+            break;
+        }
+
+        // Los paquetes dañados se descartan, como en transcodeFile
+        int sent;
+        {
+            StageTimer timer(metrics, TranscodeStage::Decode);
+            sent = avcodec_send_packet(decoder.get(), packet.get());
+        }
+        if (sent >= 0) {
+            encodeDecodedFrames();
+        }
+        av_packet_unref(packet.get());
+    }
+    if (ret < 0 && ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al leer " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    avcodec_send_packet(decoder.get(), nullptr);
+    encodeDecodedFrames();
+    {
+        StageTimer timer(metrics, TranscodeStage::Encode);
+        encodeVideoFrame(encoder.get(), nullptr, encoded.get(), writeEncoded);
+    }
+
+    finishChunkFile(output, temporaryPath, finalPath);
+    manifest->markDone(chunkTaskName(index));
+    chunkProgressUs[index] = chunkSpanUs(index);
+}
+
+void ChunkedTranscoder::encodeAudio() {
+    InputFormatPtr input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+    for (unsigned i = 0; i < input->nb_streams; ++i) {
+        if (static_cast<int>(i) != plan.audioIndex) {
+            input->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    AVStream* inStream = input->streams[plan.audioIndex];
+
+    fs::path finalPath = workDir / "audio.nut";
+    fs::path temporaryPath = finalPath.string() + ".tmp";
+    OutputFormatPtr output = createOutput(temporaryPath.string(), kChunkMuxer);
+    AVStream* outStream = avformat_new_stream(output.get(), nullptr);
+    if (!outStream) {
+        throw std::runtime_error("No se pudo crear el stream de audio intermedio");
+    }
+
+    std::unique_ptr<AudioEncoder> encoder;
+    if (plan.audio == StreamAction::Copy) {
+        avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+    } else {
+        encoder.reset(new AudioEncoder(inStream, audioEncoderConfigFor(plan, options, globalHeader)));
+        avcodec_parameters_from_context(outStream->codecpar, encoder->codecContext());
+        outStream->time_base = encoder->codecContext()->time_base;
+    }
+    writeOutputHeader(output.get(), temporaryPath.string());
+
+    std::vector<PacketPtr> encodedPackets;
+    auto writeEncoded = [&]() {
+        for (auto& encoded : encodedPackets) {
+            writeChunkPacket(output.get(), encoded.get(), encoder->codecContext()->time_base, 0);
+        }
+        encodedPackets.clear();
+    };
+
+    PacketPtr packet(av_packet_alloc());
+    while ((ret = readTimedPacket(input.get(), packet.get(), metrics)) >= 0) {
+        checkpoint();
+        if (packet->stream_index == plan.audioIndex) {
+            if (encoder) {
+                {
+                    StageTimer timer(metrics, TranscodeStage::Audio);
+                    encoder->encode(packet.get(), encodedPackets);
+                }
+                writeEncoded();
+            } else {
+                writeChunkPacket(output.get(), packet.get(), inStream->time_base, 0);
+            }
+        }
+        av_packet_unref(packet.get());
+    }
+    if (ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al leer " + inputPath + ": " + avErrorToString(ret));
+    }
+    if (encoder) {
+        {
+            StageTimer timer(metrics, TranscodeStage::Audio);
+            encoder->encode(nullptr, encodedPackets);
+        }
+        writeEncoded();
+    }
+
+    finishChunkFile(output, temporaryPath, finalPath);
+    manifest->markDone(kAudioTask);
+}
+
+void ChunkedTranscoder::concatenate() {
+    OutputFormatPtr output = createOutput(outputPath, plan.muxerName);
+
+    // Todos los trozos salen de codificadores con la misma configuración:
+    // los parámetros del primero valen para el stream completo
+    InputFormatPtr chunk = openInput((workDir / (chunkTaskName(0) + ".nut")).string());
+    AVStream* videoOut = avformat_new_stream(output.get(), nullptr);
+    if (!videoOut) {
+        throw std::runtime_error("No se pudo crear el stream de video de salida");
+    }
+    avcodec_parameters_copy(videoOut->codecpar, chunk->streams[0]->codecpar);
+    videoOut->codecpar->codec_tag = 0;
+    videoOut->time_base = chunk->streams[0]->time_base;
+    videoOut->avg_frame_rate = frameRate;
+    int videoOutIndex = videoOut->index;
+
+    InputFormatPtr audio;
+    int audioOutIndex = -1;
+    if (plan.audio != StreamAction::None) {
+        audio = openInput((workDir / "audio.nut").string());
+        AVStream* audioOut = avformat_new_stream(output.get(), nullptr);
+        if (!audioOut) {
+            throw std::runtime_error("No se pudo crear el stream de audio de salida");
+        }
+        avcodec_parameters_copy(audioOut->codecpar, audio->streams[0]->codecpar);
+        audioOut->codecpar->codec_tag = 0;
+        audioOut->time_base = audio->streams[0]->time_base;
+        audioOutIndex = audioOut->index;
+    }
+
+    writeTranscodeHeader(output.get(), plan, outputPath);
+
+    size_t nextChunk = 1;
+    bool chunkStarted = false;
+    PacketPtr videoPacket(av_packet_alloc());
+    PacketPtr audioPacket(av_packet_alloc());
+    auto readPacket = [](AVFormatContext* source, AVPacket* packet) {
+        int ret = av_read_frame(source, packet);
+        if (ret < 0 && ret != AVERROR_EOF) {
+            throw std::runtime_error("Error al leer " + std::string(source->url) + ": " + avErrorToString(ret));
+        }
+        return ret >= 0;
+    };
+    auto readVideo = [&]() {
+        while (true) {
+            if (readPacket(chunk.get(), videoPacket.get())) {
+                return true;
+            }
+            if (nextChunk >= chunkCount) {
+                return false;
+            }
+            chunk = openInput((workDir / (chunkTaskName(nextChunk++) + ".nut")).string());
+            chunkStarted = false;
+            // Sin cabecera global (TS) el SPS/PPS va dentro del stream y da igual
+            if (!sameExtradata(chunk->streams[0]->codecpar, videoOut->codecpar)) {
+                throw std::runtime_error("Los trozos no comparten la cabecera del codec; "
+                                         "este codificador no admite codificación por trozos");
+            }
+        }
+    };
+
+    auto writeOutput = [&](AVPacket* packet, AVRational sourceTimeBase, int outputIndex) {
+        uint64_t size = static_cast<uint64_t>(packet->size);
+        StageTimer timer(metrics, TranscodeStage::Mux);
+        writeChunkPacket(output.get(), packet, sourceTimeBase, outputIndex);
+        if (metrics) {
+            metrics->addBytesOut(size);
+        }
+    };
+
+    bool haveVideo = readVideo();
+    bool haveAudio = audio && readPacket(audio.get(), audioPacket.get());
+    int64_t lastVideoDts = AV_NOPTS_VALUE;
+    int64_t dtsOffset = 0;
+
+    // Mezcla ordenada por DTS de los dos orígenes
+    while (haveVideo || haveAudio) {
+        if (control) {
+            control->checkpoint();
+        }
+        bool takeVideo = haveVideo &&
+                         (!haveAudio || av_compare_ts(videoPacket->dts, chunk->streams[0]->time_base,
+                                                      audioPacket->dts, audio->streams[0]->time_base) <= 0);
+        if (takeVideo) {
+            av_packet_rescale_ts(videoPacket.get(), chunk->streams[0]->time_base, videoOut->time_base);
+            // Con B-frames el primer DTS de un trozo queda por debajo del
+            // último del anterior (el retardo de reordenación). Todo el trozo
+            // se desplaza lo justo para seguir tras él; el PTS no se toca,
+            // así que la presentación no cambia en la unión
+            if (!chunkStarted) {
+                chunkStarted = true;
+                dtsOffset = 0;
+                if (lastVideoDts != AV_NOPTS_VALUE && videoPacket->dts != AV_NOPTS_VALUE &&
+                    videoPacket->dts <= lastVideoDts) {
+                    dtsOffset = lastVideoDts + 1 - videoPacket->dts;
+                }
+            }
+            if (videoPacket->dts != AV_NOPTS_VALUE) {
+                videoPacket->dts += dtsOffset;
+                if ((videoPacket->pts != AV_NOPTS_VALUE && videoPacket->dts > videoPacket->pts) ||
+                    (lastVideoDts != AV_NOPTS_VALUE && videoPacket->dts <= lastVideoDts)) {
+                    throw std::runtime_error("Las marcas de tiempo de los trozos no encajan; "
+                                             "este codificador no admite codificación por trozos");
+                }
+                lastVideoDts = videoPacket->dts;
+            }
+            writeOutput(videoPacket.get(), videoOut->time_base, videoOutIndex);
+            haveVideo = readVideo();
+        } else {
+            writeOutput(audioPacket.get(), audio->streams[0]->time_base, audioOutIndex);
+            haveAudio = readPacket(audio.get(), audioPacket.get());
+        }
+    }
+
+    int ret = av_write_trailer(output.get());
+    if (ret < 0) {
+        throw std::runtime_error("Error al finalizar " + outputPath + ": " + avErrorToString(ret));
+    }
+}
+
+void ChunkedTranscoder::checkpoint() {
+    if (control) {
+        control->checkpoint();
+    }
+    if (stopping) {
+        throw ChunkStopped();
+    }
+}
+
+void ChunkedTranscoder::recordError(std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!firstError) {
+        firstError = error;
+    }
+    stopping = true;
+}
+
+int64_t ChunkedTranscoder::chunkSpanUs(size_t index) const {
+    auto startUs = [this](size_t k) {
+        return av_rescale_q(chunkStarts[k] - streamStart, videoTimeBase, AVRational{1, AV_TIME_BASE});
+    };
+    int64_t endUs = index + 1 < chunkCount ? startUs(index + 1) : durationUs;
+    return std::max<int64_t>(0, endUs - startUs(index));
+}
+
+void ChunkedTranscoder::reportProgress() {
+    if (!progressCallback && !metrics) {
+        return;
+    }
+    int64_t doneUs = 0;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        doneUs += chunkProgressUs[i];
+    }
+    // Suma de lo codificado en todos los trozos: con varios en vuelo la
+    // velocidad refleja el trabajo completo
+    if (metrics) {
+        metrics->setMediaTime(doneUs);
+    }
+    if (!progressCallback) {
+        return;
+    }
+    // El último 5% queda para la concatenación
+    int progress = static_cast<int>(std::min<int64_t>(95, doneUs * 95 / durationUs));
+    if (progress > lastProgress) {
+        lastProgress = progress;
+        progressCallback(progress);
+    }
+}
+
+} // namespace
+
+void transcodeFileChunked(const std::string& inputPath,
+                          const std::string& outputPath,
+                          const TranscodeOptions& options,
+                          std::function<void(int)> progressCallback,
+                          JobControl* control,
+                          TranscodeMetrics* metrics) {
+    ChunkedTranscoder transcoder(inputPath, outputPath, options, std::move(progressCallback), control, metrics);
+    transcoder.run();
+}
+
+} // namespace StreamVio
@@ -0,0 +1,615 @@
+// StreamVio/core/src/transcoder/file_transcoder.cpp
+#include "transcoder/file_transcoder.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "transcoder/audio_encoder.h"
+#include "transcoder/transcode_pipeline.h"
+#include "transcoder/video_encoder.h"
+#include "utils/ffmpeg_utils.h"
+
+namespace StreamVio {
+
+namespace {
+
+const int kHlsSegmentDuration = 2; // Igual que HLS_SEGMENT_DURATION del servidor
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Sin codec pedido, los contenedores pensados para el navegador usan sus
+// codecs por defecto (H.264 + AAC/MP3); el resto acepta lo que admita el muxer
+bool defaultCodecAccepted(OutputContainer container, AVMediaType type, AVCodecID sourceId) {
+    if (container == OutputContainer::Other) {
+        return true;
+    }
+    if (type == AVMEDIA_TYPE_VIDEO) {
+        return sourceId == AV_CODEC_ID_H264;
+    }
+    return sourceId == AV_CODEC_ID_AAC || sourceId == AV_CODEC_ID_MP3;
+}
+
+bool codecMatches(const std::string& requested, OutputContainer container,
+                  AVMediaType type, AVCodecID sourceId) {
+    if (requested.empty()) {
+        return defaultCodecAccepted(container, type, sourceId);
+    }
+    std::string name = toLower(requested);
+    if (name == "h265") {
+        name = "hevc";
+    }
+    if (const AVCodec* encoder = avcodec_find_encoder_by_name(name.c_str())) {
+        return encoder->id == sourceId;
+    }
+    if (const AVCodecDescriptor* descriptor = avcodec_descriptor_get_by_name(name.c_str())) {
+        return descriptor->id == sourceId;
+    }
+    return false;
+}
+
+// Un bitrate pedido solo obliga a transcodificar si el origen lo supera
+bool bitrateFits(int requestedKbps, int64_t sourceBitsPerSecond) {
+    if (requestedKbps <= 0 || sourceBitsPerSecond <= 0) {
+        return true;
+    }
+    return sourceBitsPerSecond <= static_cast<int64_t>(requestedKbps) * 1100;
+}
+
+bool muxable(const AVOutputFormat* format, AVCodecID codecId) {
+    // avformat_query_codec devuelve un valor negativo si el muxer no lo sabe
+    return avformat_query_codec(format, codecId, FF_COMPLIANCE_NORMAL) != 0;
+}
+
+struct EncoderCandidate {
+    AVCodecID id;
+    const char* name;           // Codificador preferido para ese codec
+};
+
+// Por orden de preferencia cuando no se pide codec: H.264 + AAC donde el
+// contenedor los admite y, si no (webm, ogg...), los abiertos
+const EncoderCandidate kDefaultVideoEncoders[] = {
+    {AV_CODEC_ID_H264, "libx264"},
+    {AV_CODEC_ID_VP9, "libvpx-vp9"},
+    {AV_CODEC_ID_AV1, "libaom-av1"},
+    {AV_CODEC_ID_VP8, "libvpx"},
+};
+const EncoderCandidate kDefaultAudioEncoders[] = {
+    {AV_CODEC_ID_AAC, "aac"},
+    {AV_CODEC_ID_OPUS, "libopus"},
+    {AV_CODEC_ID_VORBIS, "libvorbis"},
+    {AV_CODEC_ID_MP3, "libmp3lame"},
+};
+
+const AVCodec* findEncoder(const std::string& requested) {
+    std::string name = toLower(requested);
+    if (name == "h265") {
+        name = "hevc";
+    }
+    if (const AVCodec* encoder = avcodec_find_encoder_by_name(name.c_str())) {
+        return encoder;
+    }
+    // Nombre de codec ("h264", "vp9") en lugar de codificador
+    if (const AVCodecDescriptor* descriptor = avcodec_descriptor_get_by_name(name.c_str())) {
+        return avcodec_find_encoder(descriptor->id);
+    }
+    return nullptr;
+}
+
+// Codificador para un stream que se transcodifica: el pedido, si el muxer
+// lo admite, o el primer candidato disponible que admita. Así un webm sin
+// codec pedido no acaba con H.264 + AAC, que su muxer rechaza al escribir
+// la cabecera, después de abrir los codificadores.
+std::string chooseEncoder(const AVOutputFormat* format, const std::string& requested,
+                          const EncoderCandidate* candidates, size_t count, const char* kind) {
+    if (!requested.empty()) {
+        const AVCodec* encoder = findEncoder(requested);
+        if (encoder && !muxable(format, encoder->id)) {
+            throw std::runtime_error(std::string("El formato ") + format->name + " no admite el codec de " +
+                                     kind + " " + requested);
+        }
+        // Si no existe, openVideoEncoder/AudioEncoder darán el error
+        return encoder ? encoder->name : requested;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!muxable(format, candidates[i].id)) {
+            continue;
+        }
+        const AVCodec* encoder = avcodec_find_encoder_by_name(candidates[i].name);
+        if (!encoder) {
+            encoder = avcodec_find_encoder(candidates[i].id);
+        }
+        // Los experimentales (p. ej. el codificador opus nativo) no abren sin -strict
+        if (encoder && !(encoder->capabilities & AV_CODEC_CAP_EXPERIMENTAL)) {
+            return encoder->name;
+        }
+    }
+    throw std::runtime_error(std::string("No hay ningún codificador de ") + kind +
+                             " disponible para el formato " + format->name);
+}
+
+void resolveOutputSize(const TranscodeOptions& options, int sourceWidth, int sourceHeight,
+                       int& width, int& height) {
+    width = options.width;
+    height = options.height;
+    if (width <= 0 && height <= 0) {
+        width = sourceWidth;
+        height = sourceHeight;
+    } else if (width <= 0) {
+        width = static_cast<int>(static_cast<int64_t>(sourceWidth) * height / sourceHeight);
+    } else if (height <= 0) {
+        height = static_cast<int>(static_cast<int64_t>(sourceHeight) * width / sourceWidth);
+    }
+    // Los codificadores 4:2:0 exigen dimensiones pares
+    width &= ~1;
+    height &= ~1;
+}
+
+int elapsedPercent(int64_t elapsed, int64_t total) {
+    if (total <= 0 || elapsed <= 0) {
+        return 0;
+    }
+    return static_cast<int>(std::min<int64_t>(99, elapsed * 100 / total));
+}
+
+class FileTranscoder {
+public:
+    FileTranscoder(const std::string& inputPath,
+                   const std::string& outputPath,
+                   const TranscodeOptions& options,
+                   std::function<void(int)> progressCallback,
+                   JobControl* control,
+                   PipelineStatsCallback statsCallback,
+                   TranscodeMetrics* metrics);
+
+    void run();
+
+private:
+    void setupVideo();
+    void setupAudio();
+    void openOutput();
+    int readPacket(AVPacket* packet);
+    void handleVideoPacket(AVPacket* packet);
+    void handleAudioPacket(AVPacket* packet);
+    void writeEncodedAudio();
+    void writePacket(AVPacket* packet, AVRational sourceTimeBase, int outputIndex);
+    void reportProgress(const AVPacket* packet);
+
+    std::string inputPath;
+    std::string outputPath;
+    TranscodeOptions options;
+    std::function<void(int)> progressCallback;
+    JobControl* control;
+    PipelineStatsCallback statsCallback;
+    TranscodeMetrics* metrics;
+
+    InputFormatPtr input;
+    OutputFormatPtr output;
+    TranscodePlan plan;
+
+    int videoOutIndex = -1;
+    int audioOutIndex = -1;
+
+    // Ruta de video transcodificado
+    CodecContextPtr videoDecoder;
+    CodecContextPtr videoEncoder;
+
+    // Ruta de audio transcodificado
+    std::unique_ptr<AudioEncoder> audioEncoder;
+    std::vector<PacketPtr> audioPackets;
+
+    int64_t startPts = AV_NOPTS_VALUE;
+    int64_t inputSize = 0;
+    int lastProgress = -1;
+
+    // Decodificación, escalado, codificación y muxing en sus propios hilos.
+    // Se declara el último para destruirse antes que los contextos que usa.
+    std::unique_ptr<TranscodePipeline> pipeline;
+};
+
+FileTranscoder::FileTranscoder(const std::string& inputPath,
+                               const std::string& outputPath,
+                               const TranscodeOptions& options,
+                               std::function<void(int)> progressCallback,
+                               JobControl* control,
+                               PipelineStatsCallback statsCallback,
+                               TranscodeMetrics* metrics)
+    : inputPath(inputPath), outputPath(outputPath), options(options),
+      progressCallback(std::move(progressCallback)), control(control),
+      statsCallback(std::move(statsCallback)), metrics(metrics) {}
+
+void FileTranscoder::run() {
+    initializeFFmpeg();
+
+    input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+    inputSize = input->pb ? avio_size(input->pb) : 0;
+
+    plan = planTranscode(input.get(), outputPath, options);
+    if (plan.video == StreamAction::None && plan.audio == StreamAction::None) {
+        throw std::runtime_error("El archivo no contiene streams de audio ni video: " + inputPath);
+    }
+
+    output = createOutput(outputPath, plan.muxerName);
+    setupVideo();
+    setupAudio();
+    openOutput();
+
+    // Con video transcodificado, este hilo solo demuxa (y procesa el
+    // audio, que es barato); el resto de etapas van en paralelo
+    if (plan.video == StreamAction::Transcode) {
+        TranscodePipeline::Config config;
+        config.metrics = metrics;
+        pipeline = std::make_unique<TranscodePipeline>(output.get(), videoDecoder.get(), videoEncoder.get(),
+                                                       videoOutIndex, config);
+        pipeline->start();
+    }
+
+    PacketPtr packet(av_packet_alloc());
+    while ((ret = readPacket(packet.get())) >= 0) {
+        if (control) {
+            control->checkpoint();
+        }
+        if (packet->stream_index == plan.videoIndex) {
+            reportProgress(packet.get());
+            handleVideoPacket(packet.get());
+        } else if (packet->stream_index == plan.audioIndex) {
+            if (plan.videoIndex < 0) {
+                reportProgress(packet.get());
+            }
+            handleAudioPacket(packet.get());
+        }
+        av_packet_unref(packet.get());
+    }
+    if (ret != AVERROR_EOF) {
+        throw std::runtime_error("Error al leer " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    // Vaciar decodificadores y codificadores
+    if (plan.audio == StreamAction::Transcode) {
+        handleAudioPacket(nullptr);
+    }
+    if (pipeline) {
+        pipeline->finish();
+        if (statsCallback) {
+            statsCallback(pipeline->stats());
+        }
+    }
+
+    ret = av_write_trailer(output.get());
+    if (ret < 0) {
+        throw std::runtime_error("Error al finalizar " + outputPath + ": " + avErrorToString(ret));
+    }
+
+    if (progressCallback) {
+        progressCallback(100);
+    }
+}
+
+void FileTranscoder::setupVideo() {
+    if (plan.video == StreamAction::None) {
+        return;
+    }
+
+    AVStream* inStream = input->streams[plan.videoIndex];
+    AVStream* outStream = avformat_new_stream(output.get(), nullptr);
+    if (!outStream) {
+        throw std::runtime_error("No se pudo crear el stream de video de salida");
+    }
+    videoOutIndex = outStream->index;
+
+    if (plan.video == StreamAction::Copy) {
+        avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        outStream->avg_frame_rate = inStream->avg_frame_rate;
+        outStream->sample_aspect_ratio = inStream->sample_aspect_ratio;
+        return;
+    }
+
+    videoDecoder = openDecoder(inStream, options.threads);
+    VideoEncoderConfig config = videoEncoderConfigFor(input.get(), inStream, videoDecoder.get(), plan, options,
+                                                      (output->oformat->flags & AVFMT_GLOBALHEADER) != 0);
+    videoEncoder = openVideoEncoder(config);
+
+    avcodec_parameters_from_context(outStream->codecpar, videoEncoder.get());
+    outStream->time_base = videoEncoder->time_base;
+    outStream->avg_frame_rate = config.frameRate;
+}
+
+void FileTranscoder::setupAudio() {
+    if (plan.audio == StreamAction::None) {
+        return;
+    }
+
+    AVStream* inStream = input->streams[plan.audioIndex];
+    AVStream* outStream = avformat_new_stream(output.get(), nullptr);
+    if (!outStream) {
+        throw std::runtime_error("No se pudo crear el stream de audio de salida");
+    }
+    audioOutIndex = outStream->index;
+
+    if (plan.audio == StreamAction::Copy) {
+        avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+        outStream->codecpar->codec_tag = 0;
+        outStream->time_base = inStream->time_base;
+        return;
+    }
+
+    AudioEncoderConfig config = audioEncoderConfigFor(plan, options, (output->oformat->flags & AVFMT_GLOBALHEADER) != 0);
+    audioEncoder.reset(new AudioEncoder(inStream, config));
+
+    avcodec_parameters_from_context(outStream->codecpar, audioEncoder->codecContext());
+    outStream->time_base = audioEncoder->codecContext()->time_base;
+}
+
+void FileTranscoder::openOutput() {
+    writeTranscodeHeader(output.get(), plan, outputPath);
+}
+
+int FileTranscoder::readPacket(AVPacket* packet) {
+    StageTimer timer(metrics, TranscodeStage::Demux);
+    int ret = av_read_frame(input.get(), packet);
+    if (ret >= 0 && metrics) {
+        metrics->addBytesIn(static_cast<uint64_t>(packet->size));
+    }
+    return ret;
+}
+
+void FileTranscoder::handleVideoPacket(AVPacket* packet) {
+    if (plan.video == StreamAction::Copy) {
+        writePacket(packet, input->streams[plan.videoIndex]->time_base, videoOutIndex);
+        return;
+    }
+    pipeline->pushVideoPacket(packet);
+}
+
+void FileTranscoder::handleAudioPacket(AVPacket* packet) {
+    if (plan.audio == StreamAction::Copy) {
+        writePacket(packet, input->streams[plan.audioIndex]->time_base, audioOutIndex);
+        return;
+    }
+
+    audioPackets.clear();
+    {
+        StageTimer timer(metrics, TranscodeStage::Audio);
+        audioEncoder->encode(packet, audioPackets);
+    }
+    writeEncodedAudio();
+}
+
+void FileTranscoder::writeEncodedAudio() {
+    for (auto& encoded : audioPackets) {
+        writePacket(encoded.get(), audioEncoder->codecContext()->time_base, audioOutIndex);
+    }
+    audioPackets.clear();
+}
+
+void FileTranscoder::writePacket(AVPacket* packet, AVRational sourceTimeBase, int outputIndex) {
+    // Con el pipeline activo solo su hilo de muxing escribe en la salida
+    if (pipeline) {
+        pipeline->pushMuxPacket(packet, sourceTimeBase, outputIndex);
+        return;
+    }
+    av_packet_rescale_ts(packet, sourceTimeBase, output->streams[outputIndex]->time_base);
+    packet->stream_index = outputIndex;
+    packet->pos = -1;
+    int size = packet->size;
+    StageTimer timer(metrics, TranscodeStage::Mux);
+    int ret = av_interleaved_write_frame(output.get(), packet);
+    if (ret < 0) {
+        throw std::runtime_error("Error al escribir en " + outputPath + ": " + avErrorToString(ret));
+    }
+    if (metrics) {
+        metrics->addBytesOut(static_cast<uint64_t>(size));
+        // Sin pipeline el video solo puede estar copiándose
+        if (outputIndex == videoOutIndex) {
+            metrics->addFrames(1);
+        }
+    }
+}
+
+void FileTranscoder::reportProgress(const AVPacket* packet) {
+    if (!progressCallback && !metrics) {
+        return;
+    }
+
+    int64_t elapsedUs = 0;
+    if (packet->pts != AV_NOPTS_VALUE) {
+        if (startPts == AV_NOPTS_VALUE) {
+            startPts = packet->pts;
+        }
+        elapsedUs = av_rescale_q(packet->pts - startPts, input->streams[packet->stream_index]->time_base,
+                                 AVRational{1, AV_TIME_BASE});
+        if (metrics && elapsedUs > 0) {
+            metrics->setMediaTime(elapsedUs);
+        }
+    }
+
+    int progress = 0;
+    if (input->duration > 0 && packet->pts != AV_NOPTS_VALUE) {
+        progress = elapsedPercent(elapsedUs, input->duration);
+    } else if (inputSize > 0) {
+        progress = elapsedPercent(avio_tell(input->pb), inputSize);
+    }
+
+    if (progress > lastProgress && progressCallback) {
+        lastProgress = progress;
+        progressCallback(progress);
+        if (pipeline && statsCallback) {
+            statsCallback(pipeline->stats());
+        }
+    }
+}
+
+} // namespace
+
+TranscodePlan planTranscode(AVFormatContext* input,
+                            const std::string& outputPath,
+                            const TranscodeOptions& options) {
+    TranscodePlan plan;
+
+    std::string format = toLower(options.outputFormat);
+    if (format.empty()) {
+        format = toLower(std::filesystem::path(outputPath).extension().string());
+        if (!format.empty() && format[0] == '.') {
+            format.erase(0, 1);
+        }
+    }
+
+    if (format == "mp4" || format == "m4v") {
+        plan.container = OutputContainer::Mp4;
+        plan.muxerName = "mp4";
+    } else if (format == "fmp4") {
+        plan.container = OutputContainer::FragmentedMp4;
+        plan.muxerName = "mp4";
+    } else if (format == "hls" || format == "m3u8") {
+        plan.container = OutputContainer::Hls;
+        plan.muxerName = "hls";
+    } else if (format == "mkv") {
+        plan.muxerName = "matroska";
+    } else if (!options.outputFormat.empty()) {
+        plan.muxerName = options.outputFormat;
+    }
+
+    const AVOutputFormat* outputFormat =
+        av_guess_format(plan.muxerName.empty() ? nullptr : plan.muxerName.c_str(), outputPath.c_str(), nullptr);
+    if (!outputFormat) {
+        throw std::runtime_error("Formato de salida no soportado: " + outputPath);
+    }
+
+    plan.videoIndex = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (plan.videoIndex >= 0 &&
+        (input->streams[plan.videoIndex]->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+        plan.videoIndex = -1; // Carátula de un archivo de audio
+    }
+    plan.audioIndex = av_find_best_stream(input, AVMEDIA_TYPE_AUDIO, -1, plan.videoIndex, nullptr, 0);
+
+    if (plan.videoIndex >= 0) {
+        const AVCodecParameters* par = input->streams[plan.videoIndex]->codecpar;
+        bool sameSize = (options.width <= 0 || options.width == par->width) &&
+                        (options.height <= 0 || options.height == par->height);
+        int64_t sourceBitrate = par->bit_rate > 0 ? par->bit_rate : input->bit_rate;
+        bool copy = codecMatches(options.videoCodec, plan.container, AVMEDIA_TYPE_VIDEO, par->codec_id) &&
+                    sameSize &&
+                    bitrateFits(options.videoBitrate, sourceBitrate) &&
+                    muxable(outputFormat, par->codec_id);
+        plan.video = copy ? StreamAction::Copy : StreamAction::Transcode;
+        if (plan.video == StreamAction::Transcode) {
+            plan.videoEncoder = chooseEncoder(outputFormat, options.videoCodec, kDefaultVideoEncoders,
+                                              std::size(kDefaultVideoEncoders), "video");
+        }
+    }
+
+    if (plan.audioIndex >= 0) {
+        const AVCodecParameters* par = input->streams[plan.audioIndex]->codecpar;
+        bool copy = codecMatches(options.audioCodec, plan.container, AVMEDIA_TYPE_AUDIO, par->codec_id) &&
+                    bitrateFits(options.audioBitrate, par->bit_rate) &&
+                    muxable(outputFormat, par->codec_id);
+        plan.audio = copy ? StreamAction::Copy : StreamAction::Transcode;
+        if (plan.audio == StreamAction::Transcode) {
+            plan.audioEncoder = chooseEncoder(outputFormat, options.audioCodec, kDefaultAudioEncoders,
+                                              std::size(kDefaultAudioEncoders), "audio");
+        }
+    }
+
+    return plan;
+}
+
+VideoEncoderConfig videoEncoderConfigFor(AVFormatContext* input,
+                                         AVStream* stream,
+                                         const AVCodecContext* decoder,
+                                         const TranscodePlan& plan,
+                                         const TranscodeOptions& options,
+                                         bool globalHeader) {
+    AVRational frameRate = av_guess_frame_rate(input, stream, nullptr);
+    if (frameRate.num <= 0 || frameRate.den <= 0) {
+        frameRate = AVRational{25, 1};
+    }
+
+    VideoEncoderConfig config;
+    if (!plan.videoEncoder.empty()) {
+        config.codecName = plan.videoEncoder;
+    }
+    resolveOutputSize(options, decoder->width, decoder->height, config.width, config.height);
+    config.timeBase = stream->time_base;
+    config.frameRate = frameRate;
+    config.sampleAspectRatio = decoder->sample_aspect_ratio;
+    config.bitrateKbps = options.videoBitrate;
+    config.threads = options.threads;
+    config.globalHeader = globalHeader;
+    if (plan.container == OutputContainer::Hls) {
+        config.gopSize = static_cast<int>(av_q2d(frameRate) * kHlsSegmentDuration + 0.5);
+    }
+    return config;
+}
+
+AudioEncoderConfig audioEncoderConfigFor(const TranscodePlan& plan, const TranscodeOptions& options,
+                                         bool globalHeader) {
+    AudioEncoderConfig config;
+    if (!plan.audioEncoder.empty()) {
+        config.codecName = plan.audioEncoder;
+    }
+    if (options.audioBitrate > 0) {
+        config.bitrateKbps = options.audioBitrate;
+    }
+    config.globalHeader = globalHeader;
+    return config;
+}
+
+void writeTranscodeHeader(AVFormatContext* output, const TranscodePlan& plan, const std::string& outputPath) {
+    AVDictionary* muxOptions = nullptr;
+    switch (plan.container) {
+        case OutputContainer::Mp4:
+            // Reescribe el archivo al final para dejar el moov delante
+            av_dict_set(&muxOptions, "movflags", "+faststart", 0);
+            break;
+        case OutputContainer::FragmentedMp4:
+            av_dict_set(&muxOptions, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+            break;
+        case OutputContainer::Hls: {
+            std::filesystem::path playlist(outputPath);
+            std::string pattern = (playlist.parent_path() / (playlist.stem().string() + "_%03d.ts")).string();
+            av_dict_set_int(&muxOptions, "hls_time", kHlsSegmentDuration, 0);
+            av_dict_set(&muxOptions, "hls_playlist_type", "vod", 0);
+            av_dict_set(&muxOptions, "hls_segment_filename", pattern.c_str(), 0);
+            break;
+        }
+        case OutputContainer::Other:
+            break;
+    }
+
+    try {
+        writeOutputHeader(output, outputPath, &muxOptions);
+    } catch (...) {
+        av_dict_free(&muxOptions);
+        throw;
+    }
+    av_dict_free(&muxOptions);
+}
+
+void transcodeFile(const std::string& inputPath,
+                   const std::string& outputPath,
+                   const TranscodeOptions& options,
+                   std::function<void(int)> progressCallback,
+                   JobControl* control,
+                   PipelineStatsCallback statsCallback,
+                   TranscodeMetrics* metrics) {
+    FileTranscoder transcoder(inputPath, outputPath, options, std::move(progressCallback), control,
+                              std::move(statsCallback), metrics);
+    transcoder.run();
+}
+
+} // namespace StreamVio
@@ -0,0 +1,425 @@
+// StreamVio/core/src/transcoder/hls_ladder.cpp
+#include "transcoder/hls_ladder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "transcoder/audio_encoder.h"
+#include "transcoder/video_encoder.h"
+#include "utils/blocking_queue.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace {
+
+// Misma fórmula que calculateBitrate en transcoderInterface.js
+int calculateBitrate(int width, int height, double multiplier, int maxBitrateKbps) {
+    double bpp = 0.15;
+    if (height <= 360) bpp = 0.07;
+    else if (height <= 480) bpp = 0.08;
+    else if (height <= 720) bpp = 0.1;
+    else if (height <= 1080) bpp = 0.12;
+
+    long bitrate = std::lround(width * static_cast<double>(height) * bpp * 30 / 1000);
+    bitrate = std::lround(bitrate * multiplier);
+    return static_cast<int>(std::min<long>(bitrate, maxBitrateKbps));
+}
+
+HlsRendition makeRendition(int width, int height, int maxBitrateKbps) {
+    HlsRendition rendition;
+    rendition.width = width;
+    rendition.height = height;
+    rendition.bitrateKbps = calculateBitrate(width, height, 1.0, maxBitrateKbps);
+    rendition.maxBitrateKbps = calculateBitrate(width, height, 1.5, maxBitrateKbps);
+    rendition.bufsizeKbps = calculateBitrate(width, height, 2.0, maxBitrateKbps);
+    return rendition;
+}
+
+// Elemento que el hilo decodificador reparte a cada calidad: un frame
+// decodificado (referencia compartida, sin copia) o un paquete de audio
+// ya codificado.
+struct LadderItem {
+    FramePtr frame;
+    PacketPtr audio;
+};
+
+struct RenditionWorker {
+    HlsRendition rendition;
+    int index = 0;
+    std::string playlistPath;
+    OutputFormatPtr output;
+    CodecContextPtr encoder;
+    SwsContext* scaler = nullptr;
+    FramePtr scaled;
+    PacketPtr scratch;
+    BlockingQueue<LadderItem> queue{8};
+    std::thread thread;
+    std::string error;
+
+    ~RenditionWorker() { sws_freeContext(scaler); }
+};
+
+void writeVideoPacket(RenditionWorker& worker, AVPacket* packet) {
+    AVStream* stream = worker.output->streams[0];
+    av_packet_rescale_ts(packet, worker.encoder->time_base, stream->time_base);
+    packet->stream_index = 0;
+    int ret = av_interleaved_write_frame(worker.output.get(), packet);
+    if (ret < 0) {
+        throw std::runtime_error("Error al escribir video: " + avErrorToString(ret));
+    }
+}
+
+void runRendition(RenditionWorker& worker, AVRational audioTimeBase, int64_t segmentLength) {
+    int64_t nextKeyframePts = AV_NOPTS_VALUE;
+    LadderItem item;
+
+    while (worker.queue.pop(item)) {
+        if (item.audio) {
+            AVPacket* packet = item.audio.get();
+            av_packet_rescale_ts(packet, audioTimeBase, worker.output->streams[1]->time_base);
+            packet->stream_index = 1;
+            int ret = av_interleaved_write_frame(worker.output.get(), packet);
+            if (ret < 0) {
+                throw std::runtime_error("Error al escribir audio: " + avErrorToString(ret));
+            }
+            continue;
+        }
+
+        AVFrame* source = item.frame.get();
+        worker.scaler = sws_getCachedContext(worker.scaler,
+                                             source->width, source->height,
+                                             static_cast<AVPixelFormat>(source->format),
+                                             worker.rendition.width, worker.rendition.height,
+                                             worker.encoder->pix_fmt,
+                                             SWS_BICUBIC, nullptr, nullptr, nullptr);
+        if (!worker.scaler) {
+            throw std::runtime_error("No se pudo crear el escalador");
+        }
+
+        // Si el codificador aún referencia el frame anterior se reserva uno nuevo
+        int ret = av_frame_make_writable(worker.scaled.get());
+        if (ret < 0) {
+            throw std::runtime_error("No se pudo reutilizar el frame escalado: " + avErrorToString(ret));
+        }
+        sws_scale(worker.scaler, source->data, source->linesize, 0, source->height,
+                  worker.scaled->data, worker.scaled->linesize);
+
+        AVFrame* scaled = worker.scaled.get();
+        scaled->pts = source->pts;
+        scaled->pict_type = AV_PICTURE_TYPE_NONE;
+
+        // Forzar un keyframe en cada límite de segmento para que todas las
+        // calidades corten en el mismo instante
+        if (scaled->pts != AV_NOPTS_VALUE) {
+            if (nextKeyframePts == AV_NOPTS_VALUE || scaled->pts >= nextKeyframePts) {
+                scaled->pict_type = AV_PICTURE_TYPE_I;
+                nextKeyframePts = (nextKeyframePts == AV_NOPTS_VALUE ? scaled->pts : nextKeyframePts)
+                                  + segmentLength;
+            }
+        }
+
+        encodeVideoFrame(worker.encoder.get(), scaled, worker.scratch.get(),
+                         [&](AVPacket* packet) { writeVideoPacket(worker, packet); });
+    }
+
+    encodeVideoFrame(worker.encoder.get(), nullptr, worker.scratch.get(),
+                     [&](AVPacket* packet) { writeVideoPacket(worker, packet); });
+
+    int ret = av_write_trailer(worker.output.get());
+    if (ret < 0) {
+        throw std::runtime_error("Error al cerrar la playlist: " + avErrorToString(ret));
+    }
+}
+
+void writeMasterPlaylist(const std::string& outputDir,
+                         const std::vector<std::unique_ptr<RenditionWorker>>& workers,
+                         int audioBitrateKbps) {
+    std::ofstream master(outputDir + "/master.m3u8");
+    if (!master.good()) {
+        throw std::runtime_error("No se pudo escribir master.m3u8 en " + outputDir);
+    }
+    master << "#EXTM3U\n";
+    master << "#EXT-X-VERSION:3\n";
+    for (const auto& worker : workers) {
+        const HlsRendition& r = worker->rendition;
+        int peak = (r.maxBitrateKbps > 0 ? r.maxBitrateKbps : r.bitrateKbps) + audioBitrateKbps;
+        int average = r.bitrateKbps + audioBitrateKbps;
+        master << "#EXT-X-STREAM-INF:BANDWIDTH=" << peak * 1000
+               << ",AVERAGE-BANDWIDTH=" << average * 1000
+               << ",RESOLUTION=" << r.width << "x" << r.height << "\n";
+        master << "stream_" << worker->index << ".m3u8\n";
+    }
+}
+
+} // namespace
+
+std::vector<HlsRendition> buildHlsLadder(int sourceWidth, int sourceHeight,
+                                         int maxHeight, int maxBitrateKbps) {
+    if (sourceWidth <= 0 || sourceHeight <= 0) {
+        return {makeRendition(640, 360, maxBitrateKbps)};
+    }
+
+    double aspectRatio = static_cast<double>(sourceWidth) / sourceHeight;
+    auto evenWidth = [aspectRatio](int height) {
+        return static_cast<int>(std::lround(height * aspectRatio / 2)) * 2;
+    };
+
+    std::vector<HlsRendition> ladder;
+    for (int height : {360, 480, 720, 1080}) {
+        if (height <= maxHeight && height <= sourceHeight) {
+            ladder.push_back(makeRendition(evenWidth(height), height, maxBitrateKbps));
+        }
+    }
+
+    if (ladder.empty()) {
+        int height = std::min(sourceHeight, maxHeight) & ~1;
+        ladder.push_back(makeRendition(evenWidth(height), height, maxBitrateKbps));
+    }
+    return ladder;
+}
+
+void encodeHlsLadder(const std::string& inputPath,
+                     const std::string& outputDir,
+                     const HlsLadderOptions& options,
+                     std::function<void(int)> progressCallback,
+                     JobControl* control) {
+    initializeFFmpeg();
+
+    InputFormatPtr input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    int videoIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0) {
+        throw std::runtime_error("El archivo no contiene video: " + inputPath);
+    }
+    int audioIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_AUDIO, -1, videoIndex, nullptr, 0);
+
+    AVStream* videoStream = input->streams[videoIndex];
+    CodecContextPtr decoder = openDecoder(videoStream);
+
+    std::unique_ptr<AudioEncoder> audioEncoder;
+    if (audioIndex >= 0) {
+        AudioEncoderConfig audioConfig;
+        audioConfig.bitrateKbps = options.audioBitrateKbps;
+        audioEncoder.reset(new AudioEncoder(input->streams[audioIndex], audioConfig));
+    }
+
+    std::vector<HlsRendition> renditions = options.renditions;
+    if (renditions.empty()) {
+        renditions = buildHlsLadder(decoder->width, decoder->height,
+                                    options.maxHeight, options.maxBitrateKbps);
+    }
+
+    AVRational frameRate = av_guess_frame_rate(input.get(), videoStream, nullptr);
+    if (frameRate.num <= 0 || frameRate.den <= 0) {
+        frameRate = AVRational{25, 1};
+    }
+
+    // Repartir los hilos de codificación según los píxeles de cada calidad
+    int totalThreads = options.threads > 0 ? options.threads
+                                           : static_cast<int>(ThreadPool::defaultThreadCount());
+    double totalPixels = 0;
+    for (const auto& r : renditions) {
+        totalPixels += static_cast<double>(r.width) * r.height;
+    }
+
+    std::vector<std::unique_ptr<RenditionWorker>> workers;
+    for (size_t i = 0; i < renditions.size(); ++i) {
+        auto worker = std::make_unique<RenditionWorker>();
+        worker->rendition = renditions[i];
+        worker->index = static_cast<int>(i);
+        worker->playlistPath = outputDir + "/stream_" + std::to_string(i) + ".m3u8";
+
+        double share = static_cast<double>(renditions[i].width) * renditions[i].height / totalPixels;
+        VideoEncoderConfig videoConfig;
+        videoConfig.codecName = options.videoCodec;
+        videoConfig.preset = options.preset;
+        videoConfig.width = renditions[i].width;
+        videoConfig.height = renditions[i].height;
+        videoConfig.timeBase = videoStream->time_base;
+        videoConfig.frameRate = frameRate;
+        videoConfig.sampleAspectRatio = decoder->sample_aspect_ratio;
+        videoConfig.bitrateKbps = renditions[i].bitrateKbps;
+        videoConfig.maxBitrateKbps = renditions[i].maxBitrateKbps;
+        videoConfig.bufsizeKbps = renditions[i].bufsizeKbps;
+        videoConfig.gopSize = static_cast<int>(std::lround(av_q2d(frameRate) * options.segmentDuration));
+        videoConfig.threads = std::max(1, static_cast<int>(std::lround(totalThreads * share)));
+        worker->encoder = openVideoEncoder(videoConfig);
+        worker->scaled = allocVideoFrame(videoConfig.width, videoConfig.height, videoConfig.pixelFormat);
+        worker->scratch.reset(av_packet_alloc());
+
+        worker->output = createOutput(worker->playlistPath, "hls");
+        AVStream* outVideo = avformat_new_stream(worker->output.get(), nullptr);
+        if (!outVideo) {
+            throw std::runtime_error("No se pudo crear el stream de video de salida");
+        }
+        avcodec_parameters_from_context(outVideo->codecpar, worker->encoder.get());
+        outVideo->time_base = worker->encoder->time_base;
+
+        if (audioEncoder) {
+            AVStream* outAudio = avformat_new_stream(worker->output.get(), nullptr);
+            if (!outAudio) {
+                throw std::runtime_error("No se pudo crear el stream de audio de salida");
+            }
+            avcodec_parameters_from_context(outAudio->codecpar, audioEncoder->codecContext());
+            outAudio->time_base = audioEncoder->codecContext()->time_base;
+        }
+
+        AVDictionary* muxOptions = nullptr;
+        std::string segmentPattern = outputDir + "/segment_" + std::to_string(i) + "_%03d.ts";
+        av_dict_set_int(&muxOptions, "hls_time", options.segmentDuration, 0);
+        av_dict_set(&muxOptions, "hls_playlist_type", "vod", 0);
+        av_dict_set(&muxOptions, "hls_segment_filename", segmentPattern.c_str(), 0);
+        try {
+            writeOutputHeader(worker->output.get(), worker->playlistPath, &muxOptions);
+        } catch (...) {
+            av_dict_free(&muxOptions);
+            throw;
+        }
+        av_dict_free(&muxOptions);
+
+        workers.push_back(std::move(worker));
+    }
+
+    AVRational audioTimeBase = audioEncoder ? audioEncoder->codecContext()->time_base : AVRational{1, 1};
+    int64_t segmentLength = av_rescale_q(options.segmentDuration, AVRational{1, 1}, videoStream->time_base);
+
+    for (auto& worker : workers) {
+        RenditionWorker* w = worker.get();
+        w->thread = std::thread([w, audioTimeBase, segmentLength]() {
+            try {
+                runRendition(*w, audioTimeBase, segmentLength);
+            } catch (const std::exception& e) {
+                w->error = e.what();
+                // Cerrar la cola desbloquea al hilo decodificador
+                w->queue.close();
+            }
+        });
+    }
+
+    // Repartir un elemento a todas las calidades; false si alguna falló
+    auto broadcast = [&](const AVFrame* frame, const AVPacket* audio) {
+        for (auto& worker : workers) {
+            LadderItem item;
+            if (frame) {
+                item.frame.reset(av_frame_clone(frame));
+            } else {
+                item.audio.reset(av_packet_clone(audio));
+            }
+            if (!worker->queue.push(std::move(item))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    int64_t durationUs = input->duration != AV_NOPTS_VALUE ? input->duration : 0;
+    int64_t startPts = AV_NOPTS_VALUE;
+    int lastProgress = -1;
+    bool aborted = false;
+
+    PacketPtr packet(av_packet_alloc());
+    FramePtr frame(av_frame_alloc());
+    std::vector<PacketPtr> audioPackets;
+
+    auto drainDecoder = [&]() {
+        while (!aborted && avcodec_receive_frame(decoder.get(), frame.get()) >= 0) {
+            frame->pts = frame->best_effort_timestamp;
+            if (!broadcast(frame.get(), nullptr)) {
+                aborted = true;
+            }
+
+            if (frame->pts != AV_NOPTS_VALUE && durationUs > 0 && progressCallback) {
+                if (startPts == AV_NOPTS_VALUE) {
+                    startPts = frame->pts;
+                }
+                int64_t elapsedUs = av_rescale_q(frame->pts - startPts, videoStream->time_base,
+                                                 AVRational{1, AV_TIME_BASE});
+                int progress = static_cast<int>(std::min<int64_t>(99, elapsedUs * 100 / durationUs));
+                if (progress > lastProgress) {
+                    lastProgress = progress;
+                    progressCallback(progress);
+                }
+            }
+            av_frame_unref(frame.get());
+        }
+    };
+
+    auto sendAudio = [&](const AVPacket* source) {
+        audioPackets.clear();
+        audioEncoder->encode(source, audioPackets);
+        for (const auto& encoded : audioPackets) {
+            if (!broadcast(nullptr, encoded.get())) {
+                aborted = true;
+                return;
+            }
+        }
+    };
+
+    auto stopWorkers = [&]() {
+        for (auto& worker : workers) {
+            worker->queue.close();
+        }
+        for (auto& worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    };
+
+    try {
+        while (!aborted && av_read_frame(input.get(), packet.get()) >= 0) {
+            if (control) {
+                // En pausa, los codificadores vacían su cola y se bloquean
+                control->checkpoint();
+            }
+            if (packet->stream_index == videoIndex) {
+                if (avcodec_send_packet(decoder.get(), packet.get()) >= 0) {
+                    drainDecoder();
+                }
+            } else if (audioEncoder && packet->stream_index == audioIndex) {
+                sendAudio(packet.get());
+            }
+            av_packet_unref(packet.get());
+        }
+
+        if (!aborted) {
+            avcodec_send_packet(decoder.get(), nullptr);
+            drainDecoder();
+            if (audioEncoder) {
+                sendAudio(nullptr);
+            }
+        }
+    } catch (...) {
+        stopWorkers();
+        throw;
+    }
+
+    stopWorkers();
+    std::string firstError;
+    for (auto& worker : workers) {
+        if (firstError.empty() && !worker->error.empty()) {
+            firstError = "Calidad " + std::to_string(worker->rendition.height) + "p: " + worker->error;
+        }
+    }
+    if (!firstError.empty()) {
+        throw std::runtime_error(firstError);
+    }
+
+    writeMasterPlaylist(outputDir, workers, audioEncoder ? options.audioBitrateKbps : 0);
+
+    if (progressCallback) {
+        progressCallback(100);
+    }
+}
+
+} // namespace StreamVio
@@ -0,0 +1,526 @@
+// StreamVio/core/src/transcoder/jit_segmenter.cpp
+#include "transcoder/jit_segmenter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include "analyzer/media_prober.h"
+#include "transcoder/audio_encoder.h"
+#include "transcoder/video_encoder.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/json_writer.h"
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace {
+
+const AVRational kMicroseconds{1, AV_TIME_BASE};
+
+// Audio que se codifica antes del corte de una sesión nueva y se descarta:
+// cubre el cebado de AAC (1024 muestras) y varios frames más
+const int64_t kAudioPrerollUs = 200000;
+
+// Borra el segmento a medio escribir si la sesión termina antes de cerrarlo
+struct TemporarySegmentGuard {
+    OutputFormatPtr& output;
+    const std::string& path;
+
+    ~TemporarySegmentGuard() {
+        if (output) {
+            output.reset();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    }
+};
+
+// Señala que la sesión debe terminar sin error (cancelada, o el
+// siguiente segmento ya existe porque lo generó otra sesión)
+struct SessionStopped {};
+
+} // namespace
+
+JitHlsSegmenter::JitHlsSegmenter(const std::string& inputPath,
+                                 const std::string& outputDir,
+                                 const JitHlsOptions& options)
+    : inputPath(inputPath), outputDir(outputDir), options(options) {
+    if (this->options.segmentDuration <= 0) {
+        throw std::runtime_error("La duración de segmento debe ser positiva");
+    }
+
+    ProbeOptions probeOptions;
+    probeOptions.fastMode = true;
+    MediaInfo info = probeMedia(inputPath, probeOptions);
+    if (info.duration <= 0 || info.videoCodec.empty()) {
+        throw std::runtime_error("No se puede segmentar bajo demanda sin video ni duración: " + inputPath);
+    }
+    durationMs = info.duration;
+    rendition = buildHlsLadder(info.width, info.height,
+                               options.maxHeight, options.maxBitrateKbps).back();
+
+    // Si el archivo ya se indexó, cada sesión salta directamente a su keyframe
+    keyframes = KeyframeIndex::open(keyframeIndexPath(inputPath), inputPath);
+
+    long segmentMs = static_cast<long>(options.segmentDuration) * 1000;
+    size_t count = static_cast<size_t>((durationMs + segmentMs - 1) / segmentMs);
+    segmentReady.assign(count, false);
+
+    // Los segmentos se renombran al terminar, así que los que ya existen
+    // de una ejecución anterior están completos
+    for (size_t i = 0; i < count; ++i) {
+        std::error_code ec;
+        segmentReady[i] = std::filesystem::exists(segmentPath(static_cast<int>(i)), ec);
+    }
+}
+
+JitHlsSegmenter::~JitHlsSegmenter() {
+    std::unique_lock<std::mutex> lock(mutex);
+    stopSession(lock);
+}
+
+std::string JitHlsSegmenter::segmentPath(int index) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "segment_%05d.ts", index);
+    return outputDir + "/" + name;
+}
+
+std::string JitHlsSegmenter::writePlaylist() const {
+    std::string playlistPath = outputDir + "/playlist.m3u8";
+    std::ofstream playlist(playlistPath);
+    if (!playlist.good()) {
+        throw std::runtime_error("No se pudo escribir " + playlistPath);
+    }
+
+    playlist << "#EXTM3U\n";
+    playlist << "#EXT-X-VERSION:3\n";
+    playlist << "#EXT-X-TARGETDURATION:" << options.segmentDuration << "\n";
+    playlist << "#EXT-X-MEDIA-SEQUENCE:0\n";
+    playlist << "#EXT-X-PLAYLIST-TYPE:VOD\n";
+
+    long segmentMs = static_cast<long>(options.segmentDuration) * 1000;
+    for (int i = 0; i < segmentCount(); ++i) {
+        long remainingMs = durationMs - i * segmentMs;
+        long lengthMs = remainingMs < segmentMs ? remainingMs : segmentMs;
+        char extinf[48];
+        std::snprintf(extinf, sizeof(extinf), "#EXTINF:%.3f,\n", lengthMs / 1000.0);
+        playlist << extinf;
+        playlist << std::filesystem::path(segmentPath(i)).filename().string() << "\n";
+    }
+    playlist << "#EXT-X-ENDLIST\n";
+    return playlistPath;
+}
+
+std::string JitHlsSegmenter::requestSegment(int index) {
+    if (index < 0 || index >= segmentCount()) {
+        throw std::runtime_error("Segmento fuera de rango: " + std::to_string(index));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    lastRequested = index;
+    stateChanged.notify_all(); // Despierta a la sesión si estaba pausada
+
+    while (!segmentReady[index]) {
+        if (session && session->finished && !session->error.empty() &&
+            index >= session->startSegment && index <= session->currentSegment) {
+            throw std::runtime_error("Error al generar el segmento " + std::to_string(index) +
+                                     ": " + session->error);
+        }
+        if (!sessionCovers(index)) {
+            // Sin forma de cancelar una petición, una espera antigua que
+            // reiniciara la sesión desharía el salto del espectador
+            if (index != lastRequested) {
+                throw SegmentSuperseded(index);
+            }
+            stopSession(lock);
+            // stopSession suelta el cerrojo: puede haber llegado otra petición
+            if (!session && index == lastRequested) {
+                startSession(index);
+            }
+            continue;
+        }
+        stateChanged.wait(lock);
+    }
+    return segmentPath(index);
+}
+
+bool JitHlsSegmenter::sessionCovers(int index) const {
+    return session && !session->finished && !session->cancelled &&
+           index >= session->startSegment &&
+           index <= session->currentSegment + options.prefetchSegments;
+}
+
+void JitHlsSegmenter::startSession(int startSegment) {
+    session = std::make_unique<Session>();
+    session->startSegment = startSegment;
+    session->currentSegment = startSegment;
+
+    Session* current = session.get();
+    current->thread = std::thread([this, current]() {
+        std::string error;
+        try {
+            runSession(*current);
+        } catch (const SessionStopped&) {
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        current->error = error;
+        current->finished = true;
+        stateChanged.notify_all();
+    });
+}
+
+void JitHlsSegmenter::stopSession(std::unique_lock<std::mutex>& lock) {
+    if (!session) {
+        return;
+    }
+    std::unique_ptr<Session> old = std::move(session);
+    old->cancelled = true;
+    stateChanged.notify_all();
+
+    lock.unlock();
+    old->thread.join();
+    lock.lock();
+}
+
+void JitHlsSegmenter::markReady(Session& session, int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    segmentReady[index] = true;
+    session.currentSegment = index;
+    stateChanged.notify_all();
+}
+
+bool JitHlsSegmenter::waitForDemand(Session& session, int nextIndex) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (nextIndex >= segmentCount() || segmentReady[nextIndex]) {
+        return false;
+    }
+    session.currentSegment = nextIndex;
+    stateChanged.wait(lock, [&]() {
+        return session.cancelled || nextIndex <= lastRequested + options.prefetchSegments;
+    });
+    return !session.cancelled;
+}
+
+void JitHlsSegmenter::runSession(Session& session) {
+    InputFormatPtr input = openInput(inputPath);
+    int ret = avformat_find_stream_info(input.get(), nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+    }
+
+    int videoIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0) {
+        throw std::runtime_error("El archivo no contiene video: " + inputPath);
+    }
+    int audioIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_AUDIO, -1, videoIndex, nullptr, 0);
+
+    AVStream* videoStream = input->streams[videoIndex];
+    AVStream* audioStream = audioIndex >= 0 ? input->streams[audioIndex] : nullptr;
+    CodecContextPtr decoder = openDecoder(videoStream);
+
+    std::unique_ptr<AudioEncoder> audioEncoder;
+    if (audioStream) {
+        AudioEncoderConfig audioConfig;
+        audioConfig.bitrateKbps = options.audioBitrateKbps;
+        audioEncoder.reset(new AudioEncoder(audioStream, audioConfig));
+    }
+
+    AVRational frameRate = av_guess_frame_rate(input.get(), videoStream, nullptr);
+    if (frameRate.num <= 0 || frameRate.den <= 0) {
+        frameRate = AVRational{25, 1};
+    }
+
+    VideoEncoderConfig videoConfig;
+    videoConfig.codecName = options.videoCodec;
+    videoConfig.preset = options.preset;
+    videoConfig.width = rendition.width;
+    videoConfig.height = rendition.height;
+    videoConfig.timeBase = videoStream->time_base;
+    videoConfig.frameRate = frameRate;
+    videoConfig.sampleAspectRatio = decoder->sample_aspect_ratio;
+    videoConfig.bitrateKbps = rendition.bitrateKbps;
+    videoConfig.maxBitrateKbps = rendition.maxBitrateKbps;
+    videoConfig.bufsizeKbps = rendition.bufsizeKbps;
+    videoConfig.gopSize = static_cast<int>(std::lround(av_q2d(frameRate) * options.segmentDuration));
+    videoConfig.threads = options.threads;
+    CodecContextPtr encoder = openVideoEncoder(videoConfig);
+    AVRational encoderTimeBase = encoder->time_base;
+    AVRational audioTimeBase = audioEncoder ? audioEncoder->codecContext()->time_base : AVRational{1, 1};
+
+    // Línea de tiempo común: microsegundos desde el inicio del archivo.
+    // Así el segmento N empieza exactamente en N * segmentDuration
+    const int64_t segmentUs = static_cast<int64_t>(options.segmentDuration) * AV_TIME_BASE;
+    const int64_t originUs = input->start_time != AV_NOPTS_VALUE ? input->start_time : 0;
+    const int64_t sessionStartUs = session.startSegment * segmentUs;
+
+    if (session.startSegment > 0) {
+        // Keyframe anterior más cercano al inicio del segmento
+        int64_t target = originUs + sessionStartUs;
+        const KeyframeIndexStream* indexed = keyframes ? keyframes->findStream(videoIndex) : nullptr;
+        const KeyframeIndexEntry* keyframe = indexed
+            ? keyframes->keyframeAtOrBefore(*indexed, av_rescale_q(target, kMicroseconds, videoStream->time_base))
+            : nullptr;
+        if (keyframe) {
+            seekToKeyframe(input.get(), videoIndex, *keyframe);
+        } else {
+            avformat_seek_file(input.get(), -1, INT64_MIN, target, target, 0);
+        }
+    }
+
+    int current = session.startSegment;
+    std::string temporaryPath;
+    OutputFormatPtr output;
+    TemporarySegmentGuard temporaryGuard{output, temporaryPath};
+
+    auto openSegment = [&](int index) {
+        temporaryPath = segmentPath(index) + ".tmp";
+        output = createOutput(temporaryPath, "mpegts");
+
+        AVStream* outVideo = avformat_new_stream(output.get(), nullptr);
+        if (!outVideo) {
+            throw std::runtime_error("No se pudo crear el stream de video del segmento");
+        }
+        avcodec_parameters_from_context(outVideo->codecpar, encoder.get());
+        outVideo->time_base = encoderTimeBase;
+
+        if (audioEncoder) {
+            AVStream* outAudio = avformat_new_stream(output.get(), nullptr);
+            if (!outAudio) {
+                throw std::runtime_error("No se pudo crear el stream de audio del segmento");
+            }
+            avcodec_parameters_from_context(outAudio->codecpar, audioEncoder->codecContext());
+            outAudio->time_base = audioTimeBase;
+        }
+
+        // Conservar las marcas de tiempo para que los segmentos de
+        // distintas sesiones encajen entre sí
+        AVDictionary* muxOptions = nullptr;
+        av_dict_set(&muxOptions, "mpegts_copyts", "1", 0);
+        try {
+            writeOutputHeader(output.get(), temporaryPath, &muxOptions);
+        } catch (...) {
+            av_dict_free(&muxOptions);
+            throw;
+        }
+        av_dict_free(&muxOptions);
+    };
+
+    auto closeSegment = [&]() {
+        int trailerRet = av_write_trailer(output.get());
+        output.reset();
+        if (trailerRet < 0) {
+            throw std::runtime_error("Error al cerrar el segmento: " + avErrorToString(trailerRet));
+        }
+        std::error_code ec;
+        std::filesystem::rename(temporaryPath, segmentPath(current), ec);
+        if (ec) {
+            throw std::runtime_error("No se pudo publicar el segmento: " + ec.message());
+        }
+        markReady(session, current);
+    };
+
+    std::deque<PacketPtr> pendingAudio;
+    auto writePendingAudio = [&](int64_t limitUs) {
+        while (!pendingAudio.empty()) {
+            AVPacket* packet = pendingAudio.front().get();
+            if (limitUs >= 0 && av_rescale_q(packet->pts, audioTimeBase, kMicroseconds) >= limitUs) {
+                break;
+            }
+            av_packet_rescale_ts(packet, audioTimeBase, output->streams[1]->time_base);
+            packet->stream_index = 1;
+            int writeRet = av_interleaved_write_frame(output.get(), packet);
+            if (writeRet < 0) {
+                throw std::runtime_error("Error al escribir audio: " + avErrorToString(writeRet));
+            }
+            pendingAudio.pop_front();
+        }
+    };
+
+    auto onVideoPacket = [&](AVPacket* packet) {
+        // El keyframe forzado en el límite abre el siguiente segmento
+        if ((packet->flags & AV_PKT_FLAG_KEY) && packet->pts != AV_NOPTS_VALUE &&
+            av_rescale_q(packet->pts, encoderTimeBase, kMicroseconds) >= (current + 1) * segmentUs) {
+            writePendingAudio((current + 1) * segmentUs);
+            closeSegment();
+            if (session.cancelled || !waitForDemand(session, current + 1)) {
+                throw SessionStopped();
+            }
+            ++current;
+            openSegment(current);
+        }
+
+        av_packet_rescale_ts(packet, encoderTimeBase, output->streams[0]->time_base);
+        packet->stream_index = 0;
+        int writeRet = av_interleaved_write_frame(output.get(), packet);
+        if (writeRet < 0) {
+            throw std::runtime_error("Error al escribir video: " + avErrorToString(writeRet));
+        }
+    };
+
+    SwsContextPtr scaler;
+    FramePtr scaled = allocVideoFrame(rendition.width, rendition.height, videoConfig.pixelFormat);
+    FramePtr frame(av_frame_alloc());
+    PacketPtr packet(av_packet_alloc());
+    PacketPtr scratch(av_packet_alloc());
+    std::vector<PacketPtr> audioPackets;
+    int64_t lastForcedSegment = -1;
+
+    auto drainDecoder = [&]() {
+        while (avcodec_receive_frame(decoder.get(), frame.get()) >= 0) {
+            int64_t pts = frame->best_effort_timestamp;
+            int64_t relativeUs = pts == AV_NOPTS_VALUE
+                ? -1
+                : av_rescale_q(pts, videoStream->time_base, kMicroseconds) - originUs;
+            // Descartar lo anterior al inicio de la sesión (desde el keyframe)
+            if (relativeUs < sessionStartUs) {
+                av_frame_unref(frame.get());
+                continue;
+            }
+
+            scaler.reset(sws_getCachedContext(scaler.release(), frame->width, frame->height,
+                                              static_cast<AVPixelFormat>(frame->format),
+                                              rendition.width, rendition.height, videoConfig.pixelFormat,
+                                              SWS_BICUBIC, nullptr, nullptr, nullptr));
+            if (!scaler) {
+                throw std::runtime_error("No se pudo crear el escalador");
+            }
+            int writableRet = av_frame_make_writable(scaled.get());
+            if (writableRet < 0) {
+                throw std::runtime_error("No se pudo reutilizar el frame escalado: " + avErrorToString(writableRet));
+            }
+            sws_scale(scaler.get(), frame->data, frame->linesize, 0, frame->height,
+                      scaled->data, scaled->linesize);
+            av_frame_unref(frame.get());
+
+            scaled->pts = av_rescale_q(relativeUs, kMicroseconds, encoderTimeBase);
+            int64_t segmentIndex = relativeUs / segmentUs;
+            scaled->pict_type = AV_PICTURE_TYPE_NONE;
+            if (segmentIndex > lastForcedSegment) {
+                scaled->pict_type = AV_PICTURE_TYPE_I;
+                lastForcedSegment = segmentIndex;
+            }
+            encodeVideoFrame(encoder.get(), scaled.get(), scratch.get(), onVideoPacket);
+        }
+    };
+
+    // Una sesión que no empieza en el segmento 0 estrena codificador de
+    // audio: sus primeros paquetes llevan el cebado del codificador
+    // (initial_padding) y el audio de antes del corte, que ya contiene el
+    // segmento anterior. Se codifica desde un poco antes para que el
+    // codificador llegue estable al corte y se descarta todo lo anterior a
+    // él, así el primer paquete del segmento continúa al último del previo
+    // sin silencio ni solape. Queda la diferencia de estado entre dos
+    // codificadores distintos en esa unión, mucho menos audible.
+    const int64_t audioStartUs = session.startSegment > 0 ? sessionStartUs : INT64_MIN;
+    const int64_t audioFeedStartUs = session.startSegment > 0 ? sessionStartUs - kAudioPrerollUs : sessionStartUs;
+
+    auto encodeAudio = [&](const AVPacket* source) {
+        audioPackets.clear();
+        audioEncoder->encode(source, audioPackets);
+        int64_t originAudio = av_rescale_q(originUs, kMicroseconds, audioTimeBase);
+        for (auto& encoded : audioPackets) {
+            encoded->pts -= originAudio;
+            encoded->dts -= originAudio;
+            if (encoded->pts != AV_NOPTS_VALUE &&
+                av_rescale_q(encoded->pts, audioTimeBase, kMicroseconds) < audioStartUs) {
+                continue;
+            }
+            pendingAudio.push_back(std::move(encoded));
+        }
+        writePendingAudio((current + 1) * segmentUs);
+    };
+
+    openSegment(current);
+
+    while (!session.cancelled && av_read_frame(input.get(), packet.get()) >= 0) {
+        if (packet->stream_index == videoIndex) {
+            if (avcodec_send_packet(decoder.get(), packet.get()) >= 0) {
+                drainDecoder();
+            }
+        } else if (audioEncoder && packet->stream_index == audioIndex) {
+            int64_t endUs = packet->pts == AV_NOPTS_VALUE
+                ? sessionStartUs
+                : av_rescale_q(packet->pts + packet->duration, audioStream->time_base, kMicroseconds) - originUs;
+            if (endUs >= audioFeedStartUs) {
+                encodeAudio(packet.get());
+            }
+        }
+        av_packet_unref(packet.get());
+    }
+
+    if (session.cancelled) {
+        throw SessionStopped();
+    }
+
+    avcodec_send_packet(decoder.get(), nullptr);
+    drainDecoder();
+    encodeVideoFrame(encoder.get(), nullptr, scratch.get(), onVideoPacket);
+    if (audioEncoder) {
+        encodeAudio(nullptr);
+        writePendingAudio(-1);
+    }
+    closeSegment();
+}
+
+void serveJitHls(const std::string& inputPath,
+                 const std::string& outputDir,
+                 const JitHlsOptions& options,
+                 std::istream& requests,
+                 std::ostream& events) {
+    JitHlsSegmenter segmenter(inputPath, outputDir, options);
+    std::mutex eventsMutex;
+    auto emit = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events << line << '\n';
+        events.flush();
+    };
+
+    JsonWriter playlist;
+    playlist.field("event", "playlist")
+        .field("path", segmenter.writePlaylist())
+        .field("segments", segmenter.segmentCount());
+    emit(playlist.str());
+
+    // Varias peticiones pueden esperar a la vez (el reproductor pide en
+    // paralelo); la sesión de transcodificación sigue siendo única
+    ThreadPool pool(4);
+    std::string line;
+    while (std::getline(requests, line)) {
+        if (line.empty() || line == "\r") {
+            continue;
+        }
+        int index = -1;
+        try {
+            index = std::stoi(line);
+        } catch (...) {
+            JsonWriter error;
+            error.field("event", "error").field("request", line).field("error", "Índice no válido");
+            emit(error.str());
+            continue;
+        }
+
+        pool.submit([&, index]() {
+            JsonWriter json;
+            try {
+                std::string path = segmenter.requestSegment(index);
+                json.field("event", "segment").field("index", index).field("path", path);
+            } catch (const SegmentSuperseded&) {
+                json.field("event", "superseded").field("index", index);
+            } catch (const std::exception& e) {
+                json.field("event", "error").field("index", index).field("error", e.what());
+            }
+            emit(json.str());
+        });
+    }
+    pool.waitIdle();
+}
+
+} // namespace StreamVio
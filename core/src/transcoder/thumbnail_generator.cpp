@@ -0,0 +1,695 @@
+// StreamVio/core/src/transcoder/thumbnail_generator.cpp
+#include "transcoder/thumbnail_generator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+
+#include "analyzer/frame_analysis.h"
+#include "analyzer/keyframe_index.h"
+#include "utils/ffmpeg_utils.h"
+#include "utils/json_writer.h"
+#include "utils/thread_pool.h"
+
+namespace StreamVio {
+
+namespace {
+
+constexpr AVRational kMicroseconds{1, 1000000};
+
+// Si el siguiente instante buscado está más lejos que esto, se salta con
+// una búsqueda en lugar de leer (y descartar) todos los paquetes intermedios
+constexpr int64_t kSeekThresholdUs = 3 * 1000000;
+
+// Sin análisis previo, cuánto se puede retrasar el poster automático
+// buscando un keyframe que no sea negro, fundido o plano
+constexpr int64_t kPosterSearchUs = 30 * 1000000;
+
+int evenDimension(double value) {
+    int result = static_cast<int>(value + 0.5) & ~1;
+    return std::max(result, 2);
+}
+
+bool hasExtension(const std::string& path, const std::string& extension) {
+    std::string actual = std::filesystem::path(path).extension().string();
+    std::transform(actual.begin(), actual.end(), actual.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return actual == extension;
+}
+
+std::string formatVttTime(int64_t us) {
+    int64_t ms = us / 1000;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld.%03lld",
+                  static_cast<long long>(ms / 3600000),
+                  static_cast<long long>((ms / 60000) % 60),
+                  static_cast<long long>((ms / 1000) % 60),
+                  static_cast<long long>(ms % 1000));
+    return buffer;
+}
+
+std::string spriteFileName(int sheet) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "sprite_%03d.jpg", sheet);
+    return name;
+}
+
+// Escala `source` dentro del rectángulo (x, y, w, h) de `target`, que debe
+// ser YUVJ420P. x, y, w y h deben ser pares por el submuestreo de croma.
+void scaleInto(SwsContextPtr& scaler, const AVFrame* source, AVFrame* target,
+               int x, int y, int w, int h) {
+    scaler.reset(sws_getCachedContext(scaler.release(), source->width, source->height,
+                                      static_cast<AVPixelFormat>(source->format),
+                                      w, h, AV_PIX_FMT_YUVJ420P,
+                                      SWS_BILINEAR, nullptr, nullptr, nullptr));
+    if (!scaler) {
+        throw std::runtime_error("No se pudo crear el escalador de miniaturas");
+    }
+
+    uint8_t* planes[4] = {
+        target->data[0] + y * target->linesize[0] + x,
+        target->data[1] + (y / 2) * target->linesize[1] + x / 2,
+        target->data[2] + (y / 2) * target->linesize[2] + x / 2,
+        nullptr
+    };
+    int strides[4] = {target->linesize[0], target->linesize[1], target->linesize[2], 0};
+    sws_scale(scaler.get(), source->data, source->linesize, 0, source->height, planes, strides);
+}
+
+void fillBlack(AVFrame* frame) {
+    for (int row = 0; row < frame->height; row++) {
+        std::memset(frame->data[0] + row * frame->linesize[0], 0, frame->width);
+    }
+    for (int row = 0; row < frame->height / 2; row++) {
+        std::memset(frame->data[1] + row * frame->linesize[1], 128, frame->width / 2);
+        std::memset(frame->data[2] + row * frame->linesize[2], 128, frame->width / 2);
+    }
+}
+
+// Una pasada sobre la entrada: solo se leen y decodifican keyframes, y
+// cada uno se usa para todas las salidas que lo necesiten
+class KeyframePass {
+public:
+    KeyframePass(const std::string& inputPath, const TrickplayOptions& options,
+                 JobControl* control = nullptr)
+        : options(options), control(control), inputPath(inputPath) {
+        initializeFFmpeg();
+        input = openInput(inputPath);
+
+        int ret = avformat_find_stream_info(input.get(), nullptr);
+        if (ret < 0) {
+            throw std::runtime_error("No se pudo analizar " + inputPath + ": " + avErrorToString(ret));
+        }
+
+        videoIndex = av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (videoIndex < 0) {
+            throw std::runtime_error("La entrada no tiene video: " + inputPath);
+        }
+        stream = input->streams[videoIndex];
+
+        // Con índice, los saltos van directos al keyframe que interesa
+        keyframes = KeyframeIndex::open(keyframeIndexPath(inputPath), inputPath);
+        if (keyframes) {
+            indexedStream = keyframes->findStream(videoIndex);
+        }
+
+        decoder = openDecoder(stream, options.decoderThreads);
+        // Los frames no clave no se decodifican y el filtro de bucle
+        // (deblocking) se omite: para miniaturas no se nota y es la mayor
+        // parte del coste de decodificación de un intra
+        decoder->skip_frame = AVDISCARD_NONKEY;
+        decoder->skip_loop_filter = AVDISCARD_ALL;
+        decoder->flags2 |= AV_CODEC_FLAG2_FAST;
+
+        if (stream->start_time != AV_NOPTS_VALUE) {
+            originUs = av_rescale_q(stream->start_time, stream->time_base, kMicroseconds);
+        } else if (input->start_time != AV_NOPTS_VALUE) {
+            originUs = input->start_time;
+        }
+        if (input->duration != AV_NOPTS_VALUE && input->duration > 0) {
+            durationUs = input->duration;
+        }
+
+        // Relación de aspecto de visualización (con píxeles no cuadrados)
+        double sar = stream->codecpar->sample_aspect_ratio.num > 0
+            ? av_q2d(stream->codecpar->sample_aspect_ratio) : 1.0;
+        displayWidth = stream->codecpar->width * sar;
+        sourceHeight = stream->codecpar->height;
+        if (displayWidth <= 0 || sourceHeight <= 0) {
+            throw std::runtime_error("Dimensiones de video inválidas en " + inputPath);
+        }
+    }
+
+    TrickplayResult run(const std::string& posterPath, const std::string& spriteDir) {
+        TrickplayResult result;
+        this->posterPath = posterPath;
+        this->spriteDir = spriteDir;
+
+        bool wantPoster = options.poster && !posterPath.empty();
+        bool wantSprites = options.sprites && !spriteDir.empty();
+        posterDone = !wantPoster;
+        spritesDone = !wantSprites;
+        // Solo los sprites recorren todo el archivo; sin ellos el análisis
+        // quedaría a medias y no se guarda
+        saveAnalysis = options.analyze && wantSprites;
+
+        if (wantPoster) {
+            posterUs = options.posterOffsetMs >= 0
+                ? static_cast<int64_t>(options.posterOffsetMs) * 1000
+                : durationUs / 10;
+            posterWidth = options.posterWidth > 0
+                ? options.posterWidth
+                : static_cast<int>(displayWidth);
+            posterHeight = options.posterHeight > 0
+                ? options.posterHeight
+                : static_cast<int>(posterWidth * sourceHeight / displayWidth);
+            posterWidth = evenDimension(posterWidth);
+            posterHeight = evenDimension(posterHeight);
+
+            // Con el análisis de una pasada anterior se elige el keyframe de
+            // antemano; si no, se descartan sobre la marcha los que no sirven
+            FrameAnalysis analysis;
+            if (readFrameAnalysis(inputPath, analysis)) {
+                posterUs = chooseThumbnailTimeMs(analysis, posterUs / 1000) * 1000;
+            } else if (options.analyze && options.posterOffsetMs < 0) {
+                posterDeadlineUs = posterUs + kPosterSearchUs;
+            }
+        }
+
+        if (wantSprites) {
+            intervalUs = static_cast<int64_t>(std::max(options.intervalSeconds, 1)) * 1000000;
+            tileWidth = evenDimension(options.tileWidth);
+            tileHeight = options.tileHeight > 0
+                ? evenDimension(options.tileHeight)
+                : evenDimension(tileWidth * sourceHeight / displayWidth);
+            columns = std::max(options.columns, 1);
+            rows = std::max(options.rows, 1);
+            if (durationUs > 0) {
+                totalTiles = static_cast<int>((durationUs + intervalUs - 1) / intervalUs);
+            }
+        }
+
+        decodeKeyframes();
+
+        if (wantPoster) {
+            if (!posterDone) {
+                // Archivo más corto que el instante pedido: se usa el primer keyframe
+                if (!firstKeyframe) {
+                    throw std::runtime_error("No se encontró ningún keyframe decodificable");
+                }
+                writePoster(firstKeyframe.get());
+            }
+            result.posterPath = posterPath;
+        }
+
+        if (wantSprites) {
+            flushSheet();
+            if (tilesWritten == 0) {
+                throw std::runtime_error("No se encontró ningún keyframe decodificable");
+            }
+            result.spritePaths = spritePaths;
+            result.vttPath = writeVtt();
+            result.tiles = tilesWritten;
+
+            if (saveAnalysis && !analyzer.entries().empty()) {
+                try {
+                    analyzer.write(inputPath, durationUs);
+                } catch (const std::exception& e) {
+                    // Biblioteca de solo lectura sin STREAMVIO_INDEX_DIR: no es un fallo del trickplay
+                    std::cerr << "Aviso: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        return result;
+    }
+
+private:
+    void decodeKeyframes() {
+        PacketPtr packet(av_packet_alloc());
+        FramePtr frame(av_frame_alloc());
+        if (!packet || !frame) {
+            throw std::runtime_error("No se pudo reservar memoria para la decodificación");
+        }
+
+        int64_t lastSeekTargetUs = -1;
+        bool draining = false;
+
+        while (!finished()) {
+            if (!draining) {
+                int ret = av_read_frame(input.get(), packet.get());
+                if (ret == AVERROR_EOF) {
+                    draining = true;
+                    avcodec_send_packet(decoder.get(), nullptr);
+                } else if (ret < 0) {
+                    throw std::runtime_error("Error al leer la entrada: " + avErrorToString(ret));
+                } else {
+                    bool usable = packet->stream_index == videoIndex &&
+                                  (packet->flags & AV_PKT_FLAG_KEY);
+                    int64_t packetTs = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+                    if (usable) {
+                        ret = avcodec_send_packet(decoder.get(), packet.get());
+                        if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_INVALIDDATA) {
+                            av_packet_unref(packet.get());
+                            throw std::runtime_error("Error al decodificar: " + avErrorToString(ret));
+                        }
+                    }
+                    av_packet_unref(packet.get());
+                    if (!usable) {
+                        continue;
+                    }
+                    if (control) {
+                        control->checkpoint();
+                    }
+
+                    receiveFrames(frame.get());
+
+                    // Saltar hasta el siguiente instante que falta si está lejos.
+                    // Los keyframes en vuelo en el decodificador son anteriores
+                    // a ese instante, así que no se pierde nada al vaciarlo.
+                    int64_t targetUs = nextTargetUs();
+                    if (packetTs != AV_NOPTS_VALUE && targetUs >= 0 && targetUs != lastSeekTargetUs) {
+                        int64_t currentUs = av_rescale_q(packetTs, stream->time_base, kMicroseconds) - originUs;
+                        if (targetUs - currentUs > kSeekThresholdUs) {
+                            lastSeekTargetUs = targetUs;
+                            int64_t seekTs = av_rescale_q(targetUs + originUs, kMicroseconds, stream->time_base);
+                            const KeyframeIndexEntry* keyframe = indexedStream
+                                ? keyframes->keyframeAtOrAfter(*indexedStream, seekTs)
+                                : nullptr;
+                            int seekRet = keyframe
+                                ? seekToKeyframe(input.get(), videoIndex, *keyframe)
+                                : avformat_seek_file(input.get(), videoIndex, seekTs, seekTs, INT64_MAX, 0);
+                            if (seekRet >= 0) {
+                                avcodec_flush_buffers(decoder.get());
+                            }
+                        }
+                    }
+                    continue;
+                }
+            }
+
+            if (!receiveFrames(frame.get())) {
+                break;
+            }
+        }
+    }
+
+    // Devuelve false cuando el decodificador ya no tiene más frames
+    bool receiveFrames(AVFrame* frame) {
+        while (true) {
+            int ret = avcodec_receive_frame(decoder.get(), frame);
+            if (ret == AVERROR(EAGAIN)) {
+                return true;
+            }
+            if (ret == AVERROR_EOF) {
+                return false;
+            }
+            if (ret < 0) {
+                throw std::runtime_error("Error al decodificar: " + avErrorToString(ret));
+            }
+            handleKeyframe(frame);
+            av_frame_unref(frame);
+        }
+    }
+
+    void handleKeyframe(AVFrame* frame) {
+        if (frame->best_effort_timestamp == AV_NOPTS_VALUE) {
+            return;
+        }
+        int64_t timeUs = av_rescale_q(frame->best_effort_timestamp, stream->time_base, kMicroseconds) - originUs;
+
+        // Sin sidecar que guardar solo se analizan los candidatos a poster
+        bool posterCandidate = !posterDone && timeUs >= posterUs && timeUs < posterDeadlineUs;
+        const FrameAnalysisEntry* analysis = saveAnalysis || (options.analyze && posterCandidate)
+            ? analyzer.addFrame(frame, timeUs)
+            : nullptr;
+
+        if (!firstKeyframe && !posterDone) {
+            firstKeyframe.reset(av_frame_clone(frame));
+        }
+
+        if (!posterDone && timeUs >= posterUs) {
+            bool unsuitable = analysis && (analysis->flags & (kFrameBlack | kFrameFade | kFrameFlat));
+            if (unsuitable && timeUs < posterDeadlineUs) {
+                // El primero descartado queda de reserva: es el más cercano al instante pedido
+                if (!posterFallback) {
+                    firstKeyframe.reset(av_frame_clone(frame));
+                    posterFallback = true;
+                }
+            } else {
+                writePoster(unsuitable && posterFallback ? firstKeyframe.get() : frame);
+                posterDone = true;
+                firstKeyframe.reset();
+            }
+        }
+
+        // Un keyframe cubre todas las miniaturas cuyo instante ya ha pasado
+        // (con GOPs más largos que el intervalo se repite la imagen)
+        while (!spritesDone && timeUs >= static_cast<int64_t>(nextTile) * intervalUs) {
+            drawTile(frame);
+            if (totalTiles >= 0 && nextTile >= totalTiles) {
+                spritesDone = true;
+            }
+        }
+    }
+
+    int64_t nextTargetUs() const {
+        int64_t target = -1;
+        if (!spritesDone) {
+            target = static_cast<int64_t>(nextTile) * intervalUs;
+        }
+        if (!posterDone && (target < 0 || posterUs < target)) {
+            target = posterUs;
+        }
+        return target;
+    }
+
+    bool finished() const {
+        return posterDone && spritesDone;
+    }
+
+    void writePoster(const AVFrame* frame) {
+        FramePtr poster = allocVideoFrame(posterWidth, posterHeight, AV_PIX_FMT_YUVJ420P);
+        scaleInto(scaler, frame, poster.get(), 0, 0, posterWidth, posterHeight);
+        writeImageFile(poster.get(), posterPath, options.jpegQuality);
+    }
+
+    void drawTile(const AVFrame* frame) {
+        int perSheet = columns * rows;
+        int slot = nextTile % perSheet;
+        if (!sheet) {
+            sheet = allocVideoFrame(columns * tileWidth, rows * tileHeight, AV_PIX_FMT_YUVJ420P);
+            fillBlack(sheet.get());
+        }
+
+        scaleInto(scaler, frame, sheet.get(),
+                  (slot % columns) * tileWidth, (slot / columns) * tileHeight,
+                  tileWidth, tileHeight);
+        sheetTiles = slot + 1;
+        nextTile++;
+        tilesWritten = nextTile;
+
+        if (sheetTiles == perSheet) {
+            flushSheet();
+        }
+    }
+
+    void flushSheet() {
+        if (!sheet || sheetTiles == 0) {
+            return;
+        }
+        // La última hoja se recorta a las filas usadas
+        int usedRows = (sheetTiles + columns - 1) / columns;
+        int fullHeight = sheet->height;
+        sheet->height = usedRows * tileHeight;
+
+        std::string name = spriteFileName(static_cast<int>(spritePaths.size()));
+        std::string path = (std::filesystem::path(spriteDir) / name).string();
+        writeImageFile(sheet.get(), path, options.jpegQuality);
+        spritePaths.push_back(path);
+
+        sheet->height = fullHeight;
+        sheet.reset();
+        sheetTiles = 0;
+    }
+
+    std::string writeVtt() const {
+        std::string path = (std::filesystem::path(spriteDir) / "thumbnails.vtt").string();
+        std::string temporaryPath = path + ".tmp";
+        {
+            std::ofstream vtt(temporaryPath, std::ios::trunc);
+            if (!vtt) {
+                throw std::runtime_error("No se pudo escribir " + path);
+            }
+
+            vtt << "WEBVTT\n";
+            int perSheet = columns * rows;
+            for (int tile = 0; tile < tilesWritten; tile++) {
+                int64_t startUs = static_cast<int64_t>(tile) * intervalUs;
+                int64_t endUs = startUs + intervalUs;
+                if (durationUs > startUs) {
+                    endUs = std::min(endUs, durationUs);
+                }
+                int slot = tile % perSheet;
+                vtt << "\n" << formatVttTime(startUs) << " --> " << formatVttTime(endUs) << "\n"
+                    << spriteFileName(tile / perSheet)
+                    << "#xywh=" << (slot % columns) * tileWidth << ','
+                    << (slot / columns) * tileHeight << ','
+                    << tileWidth << ',' << tileHeight << "\n";
+            }
+        }
+        std::filesystem::rename(temporaryPath, path);
+        return path;
+    }
+
+    TrickplayOptions options;
+    JobControl* control;
+    std::string inputPath;
+    InputFormatPtr input;
+    std::unique_ptr<KeyframeIndex> keyframes;
+    const KeyframeIndexStream* indexedStream = nullptr;
+    CodecContextPtr decoder;
+    SwsContextPtr scaler;
+    const AVStream* stream = nullptr;
+    int videoIndex = -1;
+    int64_t originUs = 0;
+    int64_t durationUs = 0;
+    double displayWidth = 0;
+    int sourceHeight = 0;
+
+    std::string posterPath;
+    bool posterDone = true;
+    int64_t posterUs = 0;
+    int posterWidth = 0;
+    int posterHeight = 0;
+    int64_t posterDeadlineUs = -1;  // -1 = el primer keyframe tras posterUs, sea como sea
+    bool posterFallback = false;
+    FramePtr firstKeyframe;
+
+    bool saveAnalysis = false;
+    FrameAnalyzer analyzer;
+
+    std::string spriteDir;
+    bool spritesDone = true;
+    int64_t intervalUs = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    int columns = 1;
+    int rows = 1;
+    int totalTiles = -1;          // -1 = duración desconocida, hasta EOF
+    int nextTile = 0;
+    int tilesWritten = 0;
+    FramePtr sheet;
+    int sheetTiles = 0;
+    std::vector<std::string> spritePaths;
+};
+
+std::string trickplayResultToJson(const TrickplayResult& result) {
+    std::string sprites = "[";
+    for (size_t i = 0; i < result.spritePaths.size(); i++) {
+        if (i > 0) {
+            sprites += ',';
+        }
+        sprites += '"' + jsonEscape(result.spritePaths[i]) + '"';
+    }
+    sprites += ']';
+
+    JsonWriter json;
+    json.field("poster", result.posterPath)
+        .raw("sprites", sprites)
+        .field("vtt", result.vttPath)
+        .field("tiles", result.tiles);
+    return json.str();
+}
+
+} // namespace
+
+TrickplayResult generateTrickplay(const std::string& inputPath,
+                                  const std::string& outputDir,
+                                  const TrickplayOptions& options,
+                                  JobControl* control) {
+    std::filesystem::create_directories(outputDir);
+
+    KeyframePass pass(inputPath, options, control);
+    std::string posterPath = (std::filesystem::path(outputDir) / "poster.jpg").string();
+    return pass.run(posterPath, outputDir);
+}
+
+void generatePoster(const std::string& inputPath,
+                    const std::string& outputPath,
+                    int timeOffsetMs,
+                    int width,
+                    int height) {
+    TrickplayOptions options;
+    options.sprites = false;
+    options.posterOffsetMs = std::max(timeOffsetMs, 0);
+    options.posterWidth = width;
+    options.posterHeight = height;
+
+    KeyframePass pass(inputPath, options);
+    pass.run(outputPath, "");
+}
+
+size_t generateTrickplayMany(std::istream& input,
+                             std::ostream& output,
+                             size_t threads,
+                             const TrickplayOptions& options) {
+    std::mutex outputMutex;
+    std::atomic<size_t> failures{0};
+
+    // El paralelismo está entre archivos: un hilo de decodificación por
+    // archivo salvo que se pida otra cosa
+    TrickplayOptions fileOptions = options;
+    if (fileOptions.decoderThreads == 0) {
+        fileOptions.decoderThreads = 1;
+    }
+
+    auto emit = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        output << line << '\n';
+        output.flush();
+    };
+
+    {
+        ThreadPool pool(threads);
+        std::string line;
+        int64_t index = 0;
+
+        while (std::getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+
+            // "<entrada>\t<directorio>"; sin directorio se usa <entrada>_trickplay
+            std::string path = line;
+            std::string outputDir;
+            size_t tab = line.find('\t');
+            if (tab != std::string::npos) {
+                path = line.substr(0, tab);
+                outputDir = line.substr(tab + 1);
+            }
+            if (outputDir.empty()) {
+                std::filesystem::path source(path);
+                outputDir = (source.parent_path() / (source.stem().string() + "_trickplay")).string();
+            }
+
+            int64_t lineIndex = index++;
+            pool.submit([&, path, outputDir, lineIndex]() {
+                try {
+                    TrickplayResult result = generateTrickplay(path, outputDir, fileOptions);
+                    JsonWriter json;
+                    json.field("index", lineIndex)
+                        .field("ok", true)
+                        .field("path", path)
+                        .raw("result", trickplayResultToJson(result));
+                    emit(json.str());
+                } catch (const std::exception& e) {
+                    failures++;
+                    JsonWriter json;
+                    json.field("index", lineIndex)
+                        .field("ok", false)
+                        .field("path", path)
+                        .field("error", e.what());
+                    emit(json.str());
+                }
+            });
+        }
+
+        pool.waitIdle();
+    }
+
+    return failures.load();
+}
+
+void writeImageFile(const AVFrame* frame, const std::string& path, int jpegQuality) {
+    bool png = hasExtension(path, ".png");
+    AVPixelFormat format = png ? AV_PIX_FMT_RGB24 : AV_PIX_FMT_YUVJ420P;
+
+    const AVCodec* codec = avcodec_find_encoder(png ? AV_CODEC_ID_PNG : AV_CODEC_ID_MJPEG);
+    if (!codec) {
+        throw std::runtime_error(png ? "Codificador PNG no disponible" : "Codificador MJPEG no disponible");
+    }
+
+    CodecContextPtr encoder(avcodec_alloc_context3(codec));
+    if (!encoder) {
+        throw std::runtime_error("No se pudo reservar el codificador de imagen");
+    }
+    encoder->width = frame->width;
+    encoder->height = frame->height;
+    encoder->pix_fmt = format;
+    encoder->time_base = AVRational{1, 25};
+    if (!png) {
+        encoder->color_range = AVCOL_RANGE_JPEG;
+        encoder->flags |= AV_CODEC_FLAG_QSCALE;
+        encoder->global_quality = FF_QP2LAMBDA * std::clamp(jpegQuality, 2, 31);
+    }
+
+    int ret = avcodec_open2(encoder.get(), codec, nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo abrir el codificador de imagen: " + avErrorToString(ret));
+    }
+
+    FramePtr image;
+    if (frame->format != format) {
+        image = allocVideoFrame(frame->width, frame->height, format);
+        SwsContextPtr converter(sws_getContext(frame->width, frame->height,
+                                               static_cast<AVPixelFormat>(frame->format),
+                                               frame->width, frame->height, format,
+                                               SWS_BILINEAR, nullptr, nullptr, nullptr));
+        if (!converter) {
+            throw std::runtime_error("No se pudo crear el conversor de imagen");
+        }
+        sws_scale(converter.get(), frame->data, frame->linesize, 0, frame->height,
+                  image->data, image->linesize);
+    } else {
+        image.reset(av_frame_alloc());
+        if (!image || av_frame_ref(image.get(), frame) < 0) {
+            throw std::runtime_error("No se pudo referenciar el frame");
+        }
+    }
+    image->pts = 0;
+    image->quality = encoder->global_quality;
+
+    ret = avcodec_send_frame(encoder.get(), image.get());
+    if (ret >= 0) {
+        ret = avcodec_send_frame(encoder.get(), nullptr);
+    }
+    if (ret < 0) {
+        throw std::runtime_error("Error al codificar la imagen: " + avErrorToString(ret));
+    }
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("No se pudo escribir " + path);
+        }
+
+        PacketPtr packet(av_packet_alloc());
+        while ((ret = avcodec_receive_packet(encoder.get(), packet.get())) >= 0) {
+            file.write(reinterpret_cast<const char*>(packet->data), packet->size);
+            av_packet_unref(packet.get());
+        }
+        if (ret != AVERROR_EOF) {
+            file.close();
+            std::remove(temporaryPath.c_str());
+            throw std::runtime_error("Error al codificar la imagen: " + avErrorToString(ret));
+        }
+    }
+    std::filesystem::rename(temporaryPath, path);
+}
+
+} // namespace StreamVio
@@ -0,0 +1,335 @@
+// StreamVio/core/src/transcoder/transcode_metrics.cpp
+#include "transcoder/transcode_metrics.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "utils/json_writer.h"
+
+namespace StreamVio {
+
+namespace {
+
+const char* const kStageNames[kTranscodeStageCount] = {
+    "demux", "decode", "scale", "encode", "audio", "mux"
+};
+
+size_t bucketFor(int64_t ns) {
+    uint64_t micros = ns > 0 ? (static_cast<uint64_t>(ns) + 999) / 1000 : 0;
+    if (micros <= 1) {
+        return 0;
+    }
+    // Cubeta b: (2^(b-1), 2^b] µs
+    size_t bucket = 64 - __builtin_clzll(micros - 1);
+    return bucket < LatencyHistogram::kBuckets ? bucket : LatencyHistogram::kBuckets - 1;
+}
+
+// Las etiquetas de Prometheus escapan \, " y saltos de línea
+std::string promLabel(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c;
+        }
+    }
+    return out;
+}
+
+std::string promNumber(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+void promHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void promSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += promNumber(value);
+    out += '\n';
+}
+
+} // namespace
+
+const char* toString(TranscodeStage stage) {
+    return kStageNames[static_cast<size_t>(stage)];
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    counts[bucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snapshot;
+    // Las cubetas se leen de una en una: con el trabajo en marcha el total
+    // puede desviarse en unas pocas muestras, por eso se recalcula
+    for (size_t i = 0; i < kBuckets; ++i) {
+        snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sumNs = sumNs.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int64_t LatencyHistogram::Snapshot::percentileNs(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(count));
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return upperBoundNs(i);
+        }
+    }
+    return upperBoundNs(kBuckets - 1);
+}
+
+TranscodeMetrics::TranscodeMetrics(TranscodeMetrics* aggregate)
+    : aggregate(aggregate), started(std::chrono::steady_clock::now()) {}
+
+void TranscodeMetrics::recordStage(TranscodeStage stage, int64_t ns) {
+    Stage& entry = stages[static_cast<size_t>(stage)];
+    entry.busyNs.fetch_add(ns, std::memory_order_relaxed);
+    entry.latency.record(ns);
+    if (aggregate) {
+        aggregate->recordStage(stage, ns);
+    }
+}
+
+void TranscodeMetrics::addFrames(uint64_t count) {
+    frames.fetch_add(count, std::memory_order_relaxed);
+    if (aggregate) {
+        aggregate->addFrames(count);
+    }
+}
+
+void TranscodeMetrics::addBytesIn(uint64_t bytes) {
+    bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+    if (aggregate) {
+        aggregate->addBytesIn(bytes);
+    }
+}
+
+void TranscodeMetrics::addBytesOut(uint64_t bytes) {
+    bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+    if (aggregate) {
+        aggregate->addBytesOut(bytes);
+    }
+}
+
+void TranscodeMetrics::setMediaTime(int64_t us) {
+    mediaTimeUs.store(us, std::memory_order_relaxed);
+}
+
+TranscodeMetricsSnapshot TranscodeMetrics::snapshot() const {
+    TranscodeMetricsSnapshot snapshot;
+    snapshot.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    snapshot.frames = frames.load(std::memory_order_relaxed);
+    snapshot.bytesIn = bytesIn.load(std::memory_order_relaxed);
+    snapshot.bytesOut = bytesOut.load(std::memory_order_relaxed);
+    snapshot.mediaTimeUs = mediaTimeUs.load(std::memory_order_relaxed);
+    if (snapshot.elapsedSeconds > 0) {
+        snapshot.fps = snapshot.frames / snapshot.elapsedSeconds;
+        snapshot.speed = snapshot.mediaTimeUs / 1e6 / snapshot.elapsedSeconds;
+    }
+    snapshot.stages.reserve(kTranscodeStageCount);
+    for (size_t i = 0; i < kTranscodeStageCount; ++i) {
+        StageMetrics stage;
+        stage.name = kStageNames[i];
+        stage.busySeconds = stages[i].busyNs.load(std::memory_order_relaxed) / 1e9;
+        stage.latency = stages[i].latency.snapshot();
+        snapshot.stages.push_back(std::move(stage));
+    }
+    return snapshot;
+}
+
+std::string pipelineStatsToJson(const std::vector<PipelineQueueStats>& queues) {
+    std::string json = "[";
+    for (const auto& queue : queues) {
+        if (json.size() > 1) {
+            json += ',';
+        }
+        JsonWriter entry;
+        entry.field("name", queue.name)
+            .field("capacity", static_cast<int64_t>(queue.capacity))
+            .field("depth", static_cast<int64_t>(queue.depth))
+            .field("maxDepth", static_cast<int64_t>(queue.maxDepth))
+            .field("producerWaits", static_cast<int64_t>(queue.producerWaits))
+            .field("consumerWaits", static_cast<int64_t>(queue.consumerWaits));
+        json += entry.str();
+    }
+    return json + "]";
+}
+
+std::string transcodeMetricsToJson(const TranscodeMetricsSnapshot& snapshot) {
+    std::string stages = "{";
+    for (const auto& stage : snapshot.stages) {
+        // Las etapas que no intervienen (p. ej. scale en un remux) se omiten
+        if (stage.latency.count == 0) {
+            continue;
+        }
+        if (stages.size() > 1) {
+            stages += ',';
+        }
+        JsonWriter entry;
+        entry.field("items", static_cast<int64_t>(stage.latency.count))
+            .field("busySeconds", stage.busySeconds)
+            // Fracción del tiempo real que la etapa estuvo trabajando: la
+            // más cercana a 1 es el cuello de botella
+            .field("utilization", snapshot.elapsedSeconds > 0 ? stage.busySeconds / snapshot.elapsedSeconds : 0.0)
+            .field("p50Us", stage.latency.percentileNs(0.5) / 1000)
+            .field("p99Us", stage.latency.percentileNs(0.99) / 1000);
+        stages += '"' + jsonEscape(stage.name) + "\":" + entry.str();
+    }
+    stages += '}';
+
+    JsonWriter json;
+    json.field("elapsedSeconds", snapshot.elapsedSeconds)
+        .field("frames", static_cast<int64_t>(snapshot.frames))
+        .field("fps", snapshot.fps)
+        .field("speed", snapshot.speed)
+        .field("bytesIn", static_cast<int64_t>(snapshot.bytesIn))
+        .field("bytesOut", static_cast<int64_t>(snapshot.bytesOut))
+        .field("mediaTimeMs", snapshot.mediaTimeUs / 1000)
+        .raw("stages", stages)
+        .raw("queues", pipelineStatsToJson(snapshot.queues));
+    return json.str();
+}
+
+std::string transcodeMetricsToPrometheus(
+    const TranscodeMetricsSnapshot& totals,
+    const std::vector<std::pair<std::string, TranscodeMetricsSnapshot>>& jobs) {
+    std::string out;
+
+    promHeader(out, "streamvio_transcode_frames_total", "counter", "Frames de video codificados o copiados");
+    promSample(out, "streamvio_transcode_frames_total", "", static_cast<double>(totals.frames));
+    promHeader(out, "streamvio_transcode_bytes_in_total", "counter", "Bytes de paquetes demuxados");
+    promSample(out, "streamvio_transcode_bytes_in_total", "", static_cast<double>(totals.bytesIn));
+    promHeader(out, "streamvio_transcode_bytes_out_total", "counter", "Bytes de paquetes escritos");
+    promSample(out, "streamvio_transcode_bytes_out_total", "", static_cast<double>(totals.bytesOut));
+
+    promHeader(out, "streamvio_transcode_stage_busy_seconds_total", "counter",
+               "Tiempo de trabajo acumulado por etapa");
+    for (const auto& stage : totals.stages) {
+        promSample(out, "streamvio_transcode_stage_busy_seconds_total",
+                   "stage=\"" + stage.name + "\"", stage.busySeconds);
+    }
+
+    promHeader(out, "streamvio_transcode_stage_latency_seconds", "histogram",
+               "Latencia por paquete o frame de cada etapa");
+    for (const auto& stage : totals.stages) {
+        std::string labels = "stage=\"" + stage.name + "\"";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i + 1 < LatencyHistogram::kBuckets; ++i) {
+            cumulative += stage.latency.counts[i];
+            promSample(out, "streamvio_transcode_stage_latency_seconds_bucket",
+                       labels + ",le=\"" + promNumber(LatencyHistogram::upperBoundNs(i) / 1e9) + "\"",
+                       static_cast<double>(cumulative));
+        }
+        promSample(out, "streamvio_transcode_stage_latency_seconds_bucket", labels + ",le=\"+Inf\"",
+                   static_cast<double>(stage.latency.count));
+        promSample(out, "streamvio_transcode_stage_latency_seconds_sum", labels, stage.latency.sumNs / 1e9);
+        promSample(out, "streamvio_transcode_stage_latency_seconds_count", labels,
+                   static_cast<double>(stage.latency.count));
+    }
+
+    promHeader(out, "streamvio_transcode_jobs", "gauge", "Transcodificaciones en curso");
+    promSample(out, "streamvio_transcode_jobs", "", static_cast<double>(jobs.size()));
+    if (jobs.empty()) {
+        return out;
+    }
+
+    promHeader(out, "streamvio_transcode_job_fps", "gauge", "Frames por segundo del trabajo");
+    for (const auto& job : jobs) {
+        promSample(out, "streamvio_transcode_job_fps", "job=\"" + promLabel(job.first) + "\"", job.second.fps);
+    }
+    promHeader(out, "streamvio_transcode_job_speed", "gauge", "Segundos de contenido por segundo real");
+    for (const auto& job : jobs) {
+        promSample(out, "streamvio_transcode_job_speed", "job=\"" + promLabel(job.first) + "\"", job.second.speed);
+    }
+    promHeader(out, "streamvio_transcode_job_stage_utilization", "gauge",
+               "Fracción del tiempo real que cada etapa estuvo trabajando");
+    for (const auto& job : jobs) {
+        if (job.second.elapsedSeconds <= 0) {
+            continue;
+        }
+        for (const auto& stage : job.second.stages) {
+            promSample(out, "streamvio_transcode_job_stage_utilization",
+                       "job=\"" + promLabel(job.first) + "\",stage=\"" + stage.name + "\"",
+                       stage.busySeconds / job.second.elapsedSeconds);
+        }
+    }
+    promHeader(out, "streamvio_transcode_queue_depth", "gauge", "Elementos en vuelo en cada enlace del pipeline");
+    for (const auto& job : jobs) {
+        for (const auto& queue : job.second.queues) {
+            promSample(out, "streamvio_transcode_queue_depth",
+                       "job=\"" + promLabel(job.first) + "\",queue=\"" + promLabel(queue.name) + "\"",
+                       static_cast<double>(queue.depth));
+        }
+    }
+    promHeader(out, "streamvio_transcode_queue_capacity", "gauge", "Tamaño del pool de cada enlace del pipeline");
+    for (const auto& job : jobs) {
+        for (const auto& queue : job.second.queues) {
+            promSample(out, "streamvio_transcode_queue_capacity",
+                       "job=\"" + promLabel(job.first) + "\",queue=\"" + promLabel(queue.name) + "\"",
+                       static_cast<double>(queue.capacity));
+        }
+    }
+    promHeader(out, "streamvio_transcode_queue_producer_waits", "gauge",
+               "Veces que el productor esperó por hueco (contrapresión)");
+    for (const auto& job : jobs) {
+        for (const auto& queue : job.second.queues) {
+            promSample(out, "streamvio_transcode_queue_producer_waits",
+                       "job=\"" + promLabel(job.first) + "\",queue=\"" + promLabel(queue.name) + "\"",
+                       static_cast<double>(queue.producerWaits));
+        }
+    }
+    return out;
+}
+
+void writeMetricsFile(const std::string& path, const std::string& text) {
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            throw std::runtime_error("No se pudieron escribir las métricas en " + temporaryPath);
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporaryPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporaryPath, ec);
+        throw std::runtime_error("No se pudieron escribir las métricas en " + path);
+    }
+}
+
+} // namespace StreamVio
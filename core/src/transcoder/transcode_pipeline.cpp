@@ -0,0 +1,354 @@
+// StreamVio/core/src/transcoder/transcode_pipeline.cpp
+#include "transcoder/transcode_pipeline.h"
+
+#include <stdexcept>
+
+#include "transcoder/video_encoder.h"
+
+namespace StreamVio {
+
+namespace {
+
+// Señala que una etapa sale porque otra ha fallado
+struct PipelineAborted {};
+
+PacketPtr newPacket() {
+    return PacketPtr(av_packet_alloc());
+}
+
+FramePtr newFrame() {
+    return FramePtr(av_frame_alloc());
+}
+
+template <typename Pool, typename Queue>
+PipelineQueueStats linkStats(const char* name, const Pool& pool, const Queue& queue) {
+    PipelineQueueStats stats;
+    stats.name = name;
+    stats.capacity = pool.size();
+    stats.depth = pool.inUse();
+    stats.maxDepth = queue.maxDepth();
+    stats.producerWaits = pool.exhaustedWaits();
+    stats.consumerWaits = queue.emptyWaits();
+    return stats;
+}
+
+} // namespace
+
+TranscodePipeline::TranscodePipeline(AVFormatContext* output,
+                                     AVCodecContext* decoder,
+                                     AVCodecContext* encoder,
+                                     int videoOutIndex,
+                                     const Config& config)
+    : output(output), decoder(decoder), encoder(encoder), videoOutIndex(videoOutIndex),
+      metrics(config.metrics),
+      packetPool(config.packetQueue, newPacket),
+      packets(config.packetQueue),
+      decodedPool(config.frameQueue, newFrame),
+      decodedFrames(config.frameQueue),
+      scaledPool(config.frameQueue, [encoder]() {
+          return allocVideoFrame(encoder->width, encoder->height, encoder->pix_fmt);
+      }),
+      scaledFrames(config.frameQueue),
+      encodedPool(config.muxQueue, newPacket),
+      encodedPackets(config.muxQueue, &muxBell),
+      auxPool(config.muxQueue, newPacket),
+      auxPackets(config.muxQueue, &muxBell),
+      decoderScratch(av_frame_alloc()),
+      encoderScratch(av_packet_alloc()) {
+    if (!decoderScratch || !encoderScratch) {
+        throw std::bad_alloc();
+    }
+}
+
+TranscodePipeline::~TranscodePipeline() {
+    abort();
+    joinThreads();
+}
+
+void TranscodePipeline::start() {
+    threads.emplace_back(&TranscodePipeline::runStage, this, &TranscodePipeline::decodeStage);
+    threads.emplace_back(&TranscodePipeline::runStage, this, &TranscodePipeline::scaleStage);
+    threads.emplace_back(&TranscodePipeline::runStage, this, &TranscodePipeline::encodeStage);
+    threads.emplace_back(&TranscodePipeline::runStage, this, &TranscodePipeline::muxStage);
+}
+
+void TranscodePipeline::pushVideoPacket(AVPacket* packet) {
+    AVPacket* item = packetPool.acquire();
+    if (!item) {
+        throwIfFailed();
+        throw std::runtime_error("El pipeline se ha detenido");
+    }
+    av_packet_move_ref(item, packet);
+    // Nunca se llena: la cola tiene al menos tantos huecos como el pool
+    if (!packets.push(item)) {
+        av_packet_unref(item);
+        packetPool.release(item);
+        throwIfFailed();
+    }
+}
+
+void TranscodePipeline::pushMuxPacket(AVPacket* packet, AVRational sourceTimeBase, int outputIndex) {
+    AVPacket* item = auxPool.acquire();
+    if (!item) {
+        throwIfFailed();
+        throw std::runtime_error("El pipeline se ha detenido");
+    }
+    av_packet_move_ref(item, packet);
+    av_packet_rescale_ts(item, sourceTimeBase, output->streams[outputIndex]->time_base);
+    item->stream_index = outputIndex;
+    item->pos = -1;
+    if (!auxPackets.push(item)) {
+        av_packet_unref(item);
+        auxPool.release(item);
+        throwIfFailed();
+    }
+}
+
+void TranscodePipeline::finish() {
+    packets.close();
+    auxPackets.close();
+    joinThreads();
+    throwIfFailed();
+}
+
+std::vector<PipelineQueueStats> TranscodePipeline::stats() const {
+    return {
+        linkStats("demux->decode", packetPool, packets),
+        linkStats("decode->scale", decodedPool, decodedFrames),
+        linkStats("scale->encode", scaledPool, scaledFrames),
+        linkStats("encode->mux", encodedPool, encodedPackets),
+        linkStats("demux->mux", auxPool, auxPackets),
+    };
+}
+
+void TranscodePipeline::runStage(void (TranscodePipeline::*stage)()) {
+    try {
+        (this->*stage)();
+    } catch (const PipelineAborted&) {
+        // Otra etapa falló y ya registró el error
+    } catch (const std::exception& e) {
+        fail(e.what());
+    }
+}
+
+void TranscodePipeline::decodeStage() {
+    AVPacket* packet = nullptr;
+    while (!aborted && packets.pop(packet)) {
+        int64_t start = metrics ? monotonicNs() : 0;
+        int ret = avcodec_send_packet(decoder, packet);
+        int64_t busy = metrics ? monotonicNs() - start : 0;
+        av_packet_unref(packet);
+        packetPool.release(packet);
+        // Los paquetes dañados se descartan, como en la ruta secuencial
+        if (ret >= 0) {
+            busy += receiveDecodedFrames();
+        }
+        if (metrics) {
+            metrics->recordStage(TranscodeStage::Decode, busy);
+        }
+    }
+    if (aborted) {
+        return;
+    }
+
+    avcodec_send_packet(decoder, nullptr);
+    int64_t busy = receiveDecodedFrames();
+    if (metrics) {
+        metrics->recordStage(TranscodeStage::Decode, busy);
+    }
+    decodedFrames.close();
+}
+
+int64_t TranscodePipeline::receiveDecodedFrames() {
+    int64_t busy = 0;
+    while (true) {
+        // Se recibe en un frame propio y solo se toma uno del pool cuando
+        // hay imagen: así únicamente el hilo de escalado devuelve frames a
+        // decodedPool, cuya lista libre es SPSC
+        int64_t start = metrics ? monotonicNs() : 0;
+        int ret = avcodec_receive_frame(decoder, decoderScratch.get());
+        if (metrics) {
+            busy += monotonicNs() - start;
+        }
+        if (ret < 0) {
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+                return busy;
+            }
+            throw std::runtime_error("Error al decodificar video: " + avErrorToString(ret));
+        }
+
+        AVFrame* frame = decodedPool.acquire();
+        if (!frame) {
+            av_frame_unref(decoderScratch.get());
+            throw PipelineAborted();
+        }
+        av_frame_move_ref(frame, decoderScratch.get());
+        frame->pts = frame->best_effort_timestamp;
+        decodedFrames.push(frame);
+    }
+}
+
+void TranscodePipeline::scaleStage() {
+    AVFrame* frame = nullptr;
+    while (!aborted && decodedFrames.pop(frame)) {
+        AVFrame* scaled = scaledPool.acquire();
+        if (!scaled) {
+            av_frame_unref(frame);
+            decodedPool.release(frame);
+            throw PipelineAborted();
+        }
+
+        StageTimer timer(metrics, TranscodeStage::Scale);
+        scaler.reset(sws_getCachedContext(scaler.release(), frame->width, frame->height,
+                                          static_cast<AVPixelFormat>(frame->format),
+                                          scaled->width, scaled->height,
+                                          static_cast<AVPixelFormat>(scaled->format),
+                                          SWS_BICUBIC, nullptr, nullptr, nullptr));
+        if (!scaler) {
+            throw std::runtime_error("No se pudo crear el escalador");
+        }
+        // Solo copia si el codificador aún conserva una referencia al buffer
+        int ret = av_frame_make_writable(scaled);
+        if (ret < 0) {
+            throw std::runtime_error("No se pudo reutilizar el frame escalado: " + avErrorToString(ret));
+        }
+        sws_scale(scaler.get(), frame->data, frame->linesize, 0, frame->height,
+                  scaled->data, scaled->linesize);
+        scaled->pts = frame->pts;
+
+        av_frame_unref(frame);
+        decodedPool.release(frame);
+        scaledFrames.push(scaled);
+    }
+    scaledFrames.close();
+}
+
+void TranscodePipeline::encodeStage() {
+    AVRational outputTimeBase = output->streams[videoOutIndex]->time_base;
+    // Tiempo bloqueado esperando hueco hacia el muxer, que no es del codificador
+    int64_t waited = 0;
+    auto forward = [&](AVPacket* encoded) {
+        int64_t start = metrics ? monotonicNs() : 0;
+        AVPacket* item = encodedPool.acquire();
+        if (metrics) {
+            waited += monotonicNs() - start;
+        }
+        if (!item) {
+            throw PipelineAborted();
+        }
+        av_packet_move_ref(item, encoded);
+        av_packet_rescale_ts(item, encoder->time_base, outputTimeBase);
+        item->stream_index = videoOutIndex;
+        item->pos = -1;
+        encodedPackets.push(item);
+    };
+
+    AVFrame* frame = nullptr;
+    while (!aborted && scaledFrames.pop(frame)) {
+        int64_t start = metrics ? monotonicNs() : 0;
+        waited = 0;
+        try {
+            encodeVideoFrame(encoder, frame, encoderScratch.get(), forward);
+        } catch (...) {
+            scaledPool.release(frame);
+            throw;
+        }
+        scaledPool.release(frame);
+        if (metrics) {
+            metrics->recordStage(TranscodeStage::Encode, monotonicNs() - start - waited);
+            metrics->addFrames(1);
+        }
+    }
+    if (aborted) {
+        return;
+    }
+
+    encodeVideoFrame(encoder, nullptr, encoderScratch.get(), forward);
+    encodedPackets.close();
+}
+
+void TranscodePipeline::muxStage() {
+    auto write = [&](AVPacket* packet) {
+        // av_interleaved_write_frame se queda con los datos y deja el paquete vacío
+        int size = packet->size;
+        StageTimer timer(metrics, TranscodeStage::Mux);
+        int ret = av_interleaved_write_frame(output, packet);
+        if (ret < 0) {
+            throw std::runtime_error("Error al escribir la salida: " + avErrorToString(ret));
+        }
+        if (metrics) {
+            metrics->addBytesOut(static_cast<uint64_t>(size));
+        }
+    };
+    auto allDrained = [&]() {
+        return encodedPackets.drained() && auxPackets.drained();
+    };
+
+    while (!aborted) {
+        bool progressed = false;
+        AVPacket* packet = nullptr;
+        while (encodedPackets.tryPop(packet)) {
+            write(packet);
+            encodedPool.release(packet);
+            progressed = true;
+        }
+        while (auxPackets.tryPop(packet)) {
+            write(packet);
+            auxPool.release(packet);
+            progressed = true;
+        }
+
+        if (allDrained()) {
+            break;
+        }
+        if (!progressed) {
+            muxBell.wait([&]() {
+                return aborted || !encodedPackets.empty() || !auxPackets.empty() || allDrained();
+            });
+        }
+    }
+}
+
+void TranscodePipeline::fail(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error.empty()) {
+            error = message;
+        }
+    }
+    abort();
+}
+
+void TranscodePipeline::abort() {
+    aborted = true;
+    // Cerrar todo despierta a cualquier etapa bloqueada en una cola o un pool
+    packetPool.close();
+    packets.close();
+    decodedPool.close();
+    decodedFrames.close();
+    scaledPool.close();
+    scaledFrames.close();
+    encodedPool.close();
+    encodedPackets.close();
+    auxPool.close();
+    auxPackets.close();
+    muxBell.ring();
+}
+
+void TranscodePipeline::throwIfFailed() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+void TranscodePipeline::joinThreads() {
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads.clear();
+}
+
+} // namespace StreamVio
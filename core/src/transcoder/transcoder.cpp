@@ -1,78 +1,200 @@
 // StreamVio/core/src/transcoder/transcoder.cpp
 #include "transcoder/transcoder.h"
+#include "analyzer/media_prober.h"
+#include "transcoder/chunked_transcoder.h"
+#include "transcoder/file_transcoder.h"
+#include "utils/ffmpeg_utils.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
+#include <system_error>
+
+#include <sys/stat.h>
 
 namespace StreamVio {
 
+namespace {
+
+bool statIndexFile(const std::string& path, uint64_t& inode, int64_t& mtimeNs) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    inode = static_cast<uint64_t>(st.st_ino);
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+} // namespace
+
 Transcoder::Transcoder() : initialized(false) {
-    std::cout << "Transcoder constructor called" << std::endl;
 }
 
 Transcoder::~Transcoder() {
-    std::cout << "Transcoder destructor called" << std::endl;
 }
 
 bool Transcoder::initialize() {
+    initializeFFmpeg();
     initialized = true;
     return true;
 }
 
-MediaInfo Transcoder::getMediaInfo(const std::string& inputPath) {
-    MediaInfo info;
-    info.path = inputPath;
-    info.format = "mp4";
-    info.duration = 60000;
-    info.width = 1280;
-    info.height = 720;
-    info.videoCodec = "h264";
-    info.videoBitrate = 1500;
-    info.audioCodec = "aac";
-    info.audioBitrate = 128;
-    info.audioChannels = 2;
-    info.audioSampleRate = 44100;
-    return info;
+MediaInfo Transcoder::getMediaInfo(const std::string& inputPath,
+                                   const ProbeOptions& probeOptions) {
+    return probeMedia(inputPath, probeOptions);
+}
+
+size_t Transcoder::probeMany(std::istream& input,
+                             std::ostream& output,
+                             size_t threads,
+                             const ProbeOptions& probeOptions) {
+    return StreamVio::probeMany(input, output, threads, probeOptions);
 }
 
 bool Transcoder::startTranscode(const std::string& inputPath, 
                                const std::string& outputPath,
                                const TranscodeOptions& options,
-                               std::function<void(int)> progressCallback) {
+                               std::function<void(int)> progressCallback,
+                               std::shared_ptr<JobControl> control) {
     // Verificar si el archivo de entrada existe
     std::ifstream file(inputPath);
     if (!file.good()) {
         std::cerr << "Input file not found: " << inputPath << std::endl;
+        if (control) {
+            control->setError("No se encuentra el archivo de entrada: " + inputPath);
+        }
         return false;
     }
     
     // Inicializar el progreso
-    progressMap[outputPath] = 0;
+    control = beginJob(outputPath, std::move(control));
+    if (!control) {
+        std::cerr << "Ya hay una transcodificación en curso hacia " << outputPath << std::endl;
+        return false;
+    }
+    
+    auto reportProgress = [&](int progress) {
+        setProgress(outputPath, progress);
+        if (progressCallback) {
+            progressCallback(progress);
+        }
+    };
     
-    // Simular progreso rápido para pruebas
-    if (progressCallback) {
-        progressCallback(0);  // Inicio
-        progressCallback(50); // Medio
-        progressCallback(100); // Completo
+    // Si los codecs de origen ya cumplen lo pedido, transcodeFile copia
+    // los paquetes (remux) sin decodificar
+    try {
+        auto metrics = std::make_shared<TranscodeMetrics>(&totalMetrics);
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            jobMetrics[outputPath] = metrics;
+        }
+        if (options.chunkSeconds > 0) {
+            transcodeFileChunked(inputPath, outputPath, options, reportProgress, control.get(), metrics.get());
+        } else {
+            transcodeFile(inputPath, outputPath, options, reportProgress, control.get(),
+                          [&](const std::vector<PipelineQueueStats>& stats) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                pipelineStats[outputPath] = stats;
+            }, metrics.get());
+        }
+    } catch (const JobCancelled&) {
+        // No dejar un archivo de salida a medias (los trozos ya codificados
+        // se conservan para reanudar)
+        std::error_code ec;
+        std::filesystem::remove(outputPath, ec);
+        control->setError("Cancelado");
+        endJob(outputPath, false);
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error al transcodificar " << inputPath << ": " << e.what() << std::endl;
+        control->setError(e.what());
+        endJob(outputPath, false);
+        return false;
     }
     
     // Marcar como completado
-    progressMap[outputPath] = 100;
+    endJob(outputPath, true);
+    return true;
+}
+
+bool Transcoder::createHlsStream(const std::string& inputPath,
+                                 const std::string& outputDir,
+                                 const HlsLadderOptions& options,
+                                 std::function<void(int)> progressCallback,
+                                 std::shared_ptr<JobControl> control) {
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+    if (ec) {
+        std::cerr << "No se pudo crear el directorio " << outputDir << ": " << ec.message() << std::endl;
+        if (control) {
+            control->setError(ec.message());
+        }
+        return false;
+    }
+    
+    std::string progressKey = outputDir + "/master.m3u8";
+    control = beginJob(progressKey, std::move(control));
+    if (!control) {
+        std::cerr << "Ya hay un HLS en curso en " << outputDir << std::endl;
+        return false;
+    }
     
-    // Crear un archivo de salida vacío para simular la transcodificación
-    std::ofstream outFile(outputPath);
-    outFile << "StreamVio simulated output file" << std::endl;
-    outFile.close();
+    try {
+        encodeHlsLadder(inputPath, outputDir, options, [&](int progress) {
+            setProgress(progressKey, progress);
+            if (progressCallback) {
+                progressCallback(progress);
+            }
+        }, control.get());
+    } catch (const JobCancelled&) {
+        control->setError("Cancelado");
+        endJob(progressKey, false);
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error al generar HLS: " << e.what() << std::endl;
+        control->setError(e.what());
+        endJob(progressKey, false);
+        return false;
+    }
+    endJob(progressKey, true);
+    return true;
+}
+
+bool Transcoder::serveHlsOnDemand(const std::string& inputPath,
+                                  const std::string& outputDir,
+                                  const JitHlsOptions& options,
+                                  std::istream& requests,
+                                  std::ostream& events) {
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+    if (ec) {
+        std::cerr << "No se pudo crear el directorio " << outputDir << ": " << ec.message() << std::endl;
+        return false;
+    }
     
+    try {
+        serveJitHls(inputPath, outputDir, options, requests, events);
+    } catch (const std::exception& e) {
+        std::cerr << "Error en HLS bajo demanda: " << e.what() << std::endl;
+        return false;
+    }
     return true;
 }
 
 bool Transcoder::cancelTranscode(const std::string& outputPath) {
-    // Marcar como completo (lo que efectivamente termina la simulación)
-    progressMap[outputPath] = 100;
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto it = activeJobs.find(outputPath);
+    if (it == activeJobs.end()) {
+        return false;
+    }
+    // El trabajo se detiene en su siguiente punto de control
+    it->second->cancel();
     return true;
 }
 
 int Transcoder::getTranscodeProgress(const std::string& outputPath) {
+    std::lock_guard<std::mutex> lock(stateMutex);
     auto it = progressMap.find(outputPath);
     if (it != progressMap.end()) {
         return it->second;
@@ -80,24 +202,231 @@ int Transcoder::getTranscodeProgress(const std::string& outputPath) {
     return -1; // No encontrado
 }
 
+std::vector<PipelineQueueStats> Transcoder::getPipelineStats(const std::string& outputPath) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto it = pipelineStats.find(outputPath);
+    if (it != pipelineStats.end()) {
+        return it->second;
+    }
+    return {};
+}
+
+bool Transcoder::getTranscodeMetrics(const std::string& outputPath, TranscodeMetricsSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    auto it = jobMetrics.find(outputPath);
+    if (it == jobMetrics.end()) {
+        return false;
+    }
+    snapshot = it->second->snapshot();
+    auto stats = pipelineStats.find(outputPath);
+    if (stats != pipelineStats.end()) {
+        snapshot.queues = stats->second;
+    }
+    return true;
+}
+
+std::string Transcoder::prometheusMetrics() {
+    std::vector<std::pair<std::string, TranscodeMetricsSnapshot>> jobs;
+    {
+        // Los gauges por trabajo son solo de los que están en curso: los
+        // terminados ya cuentan en los totales y no deben acumular series
+        std::lock_guard<std::mutex> lock(stateMutex);
+        for (const auto& job : activeJobs) {
+            auto it = jobMetrics.find(job.first);
+            if (it == jobMetrics.end()) {
+                continue;
+            }
+            TranscodeMetricsSnapshot snapshot = it->second->snapshot();
+            auto stats = pipelineStats.find(job.first);
+            if (stats != pipelineStats.end()) {
+                snapshot.queues = stats->second;
+            }
+            jobs.emplace_back(job.first, std::move(snapshot));
+        }
+    }
+    return transcodeMetricsToPrometheus(totalMetrics.snapshot(), jobs);
+}
+
+std::shared_ptr<JobControl> Transcoder::beginJob(const std::string& key,
+                                                 std::shared_ptr<JobControl> control) {
+    if (!control) {
+        control = std::make_shared<JobControl>();
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (!activeJobs.emplace(key, control).second) {
+        control->setError("Ya hay un trabajo en curso para " + key);
+        return nullptr;
+    }
+    // Si la misma salida se había completado antes, su estado ya no cuenta
+    // como terminado: no debe caducar mientras el trabajo nuevo está en curso
+    finishedJobs.erase(std::remove(finishedJobs.begin(), finishedJobs.end(), key), finishedJobs.end());
+    progressMap[key] = 0;
+    pipelineStats.erase(key);
+    jobMetrics.erase(key);
+    return control;
+}
+
+void Transcoder::setProgress(const std::string& key, int progress) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    progressMap[key] = progress;
+}
+
+void Transcoder::endJob(const std::string& key, bool succeeded) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    activeJobs.erase(key);
+    if (!succeeded) {
+        forgetJob(key);
+        return;
+    }
+
+    // El estado final se conserva para quien consulte después, pero solo
+    // el de los últimos trabajos: un daemon atiende trabajos sin fin
+    progressMap[key] = 100;
+    finishedJobs.push_back(key);
+    while (finishedJobs.size() > kFinishedJobRetention) {
+        std::string expired = std::move(finishedJobs.front());
+        finishedJobs.pop_front();
+        forgetJob(expired);
+    }
+}
+
+void Transcoder::forgetJob(const std::string& key) {
+    progressMap.erase(key);
+    pipelineStats.erase(key);
+    jobMetrics.erase(key);
+}
+
 bool Transcoder::generateThumbnail(const std::string& inputPath, 
                                  const std::string& outputPath,
                                  int timeOffsetMs,
                                  int width,
                                  int height) {
-    // Verificar si el archivo de entrada existe
-    std::ifstream file(inputPath);
-    if (!file.good()) {
-        std::cerr << "Input file not found: " << inputPath << std::endl;
+    try {
+        generatePoster(inputPath, outputPath, timeOffsetMs, width, height);
+    } catch (const std::exception& e) {
+        std::cerr << "Error al generar la miniatura: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Transcoder::generateTrickplay(const std::string& inputPath,
+                                   const std::string& outputDir,
+                                   const TrickplayOptions& options,
+                                   std::shared_ptr<JobControl> control) {
+    control = beginJob(outputDir, std::move(control));
+    if (!control) {
+        std::cerr << "Ya hay un trickplay en curso en " << outputDir << std::endl;
         return false;
     }
     
-    // Crear un archivo de imagen vacío para simular la miniatura
-    std::ofstream outFile(outputPath);
-    outFile << "StreamVio simulated thumbnail file" << std::endl;
-    outFile.close();
-    
+    try {
+        StreamVio::generateTrickplay(inputPath, outputDir, options, control.get());
+    } catch (const JobCancelled&) {
+        control->setError("Cancelado");
+        endJob(outputDir, false);
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error al generar trickplay: " << e.what() << std::endl;
+        control->setError(e.what());
+        endJob(outputDir, false);
+        return false;
+    }
+    endJob(outputDir, true);
+    return true;
+}
+
+size_t Transcoder::generateTrickplayMany(std::istream& input,
+                                         std::ostream& output,
+                                         size_t threads,
+                                         const TrickplayOptions& options) {
+    return StreamVio::generateTrickplayMany(input, output, threads, options);
+}
+
+bool Transcoder::buildKeyframeIndex(const std::string& inputPath) {
+    try {
+        StreamVio::buildKeyframeIndex(inputPath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error al indexar " << inputPath << ": " << e.what() << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex);
+    keyframeIndexes.remove_if([&](const CachedKeyframeIndex& cached) { return cached.inputPath == inputPath; });
+    return true;
+}
+
+bool Transcoder::findKeyframe(const std::string& inputPath, int64_t timeMs, KeyframeInfo& keyframe) {
+    std::shared_ptr<const KeyframeIndex> index = keyframeIndexFor(inputPath);
+    const KeyframeIndexStream* stream = index ? index->primaryStream() : nullptr;
+    if (!stream) {
+        return false;
+    }
+    const KeyframeIndexEntry* entry = index->keyframeAtOrBefore(*stream, index->msToPts(*stream, timeMs));
+    if (!entry) {
+        return false;
+    }
+    keyframe.timeMs = index->ptsToMs(*stream, entry->pts);
+    keyframe.position = entry->position;
+    keyframe.size = entry->size;
     return true;
 }
 
-} // namespace StreamVio
\ No newline at end of file
+bool Transcoder::getByteRange(const std::string& inputPath, int64_t startMs, int64_t endMs, ByteRange& range) {
+    std::shared_ptr<const KeyframeIndex> index = keyframeIndexFor(inputPath);
+    const KeyframeIndexStream* stream = index ? index->primaryStream() : nullptr;
+    if (!stream || endMs < startMs) {
+        return false;
+    }
+    return index->byteRange(*stream, index->msToPts(*stream, startMs), index->msToPts(*stream, endMs), range);
+}
+
+std::shared_ptr<const KeyframeIndex> Transcoder::keyframeIndexFor(const std::string& inputPath) {
+    std::string indexPath = keyframeIndexPath(inputPath);
+    uint64_t inode = 0;
+    int64_t mtimeNs = 0;
+    bool indexExists = statIndexFile(indexPath, inode, mtimeNs);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        auto it = std::find_if(keyframeIndexes.begin(), keyframeIndexes.end(),
+                               [&](const CachedKeyframeIndex& cached) { return cached.inputPath == inputPath; });
+        if (it != keyframeIndexes.end()) {
+            // Vale mientras el origen no cambie y el .svidx sea el mismo que se mapeó
+            if (indexExists && it->indexInode == inode && it->indexMtimeNs == mtimeNs &&
+                it->index->matchesSource(inputPath)) {
+                keyframeIndexes.splice(keyframeIndexes.begin(), keyframeIndexes, it);
+                return it->index;
+            }
+            keyframeIndexes.erase(it);
+        }
+    }
+
+    // Abrir o generar el índice fuera del mutex: generarlo recorre el archivo
+    std::shared_ptr<const KeyframeIndex> index = KeyframeIndex::open(indexPath, inputPath);
+    if (!index) {
+        try {
+            StreamVio::buildKeyframeIndex(inputPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error al indexar " << inputPath << ": " << e.what() << std::endl;
+            return nullptr;
+        }
+        index = KeyframeIndex::open(indexPath, inputPath);
+        if (!index) {
+            return nullptr;
+        }
+    }
+    // La identidad del archivo que se acaba de mapear, no la de antes de abrirlo
+    if (!statIndexFile(indexPath, inode, mtimeNs)) {
+        return index;
+    }
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    // Otro hilo puede haberlo abierto a la vez
+    keyframeIndexes.remove_if([&](const CachedKeyframeIndex& cached) { return cached.inputPath == inputPath; });
+    keyframeIndexes.push_front(CachedKeyframeIndex{inputPath, index, inode, mtimeNs});
+    while (keyframeIndexes.size() > kKeyframeIndexCacheSize) {
+        keyframeIndexes.pop_back();
+    }
+    return index;
+}
+
+} // namespace StreamVio
@@ -0,0 +1,63 @@
+// StreamVio/core/src/transcoder/video_encoder.cpp
+#include "transcoder/video_encoder.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+namespace StreamVio {
+
+CodecContextPtr openVideoEncoder(const VideoEncoderConfig& config) {
+    const AVCodec* codec = avcodec_find_encoder_by_name(config.codecName.c_str());
+    if (!codec && (config.codecName == "libx264" || config.codecName == "h264")) {
+        codec = avcodec_find_encoder(AV_CODEC_ID_H264);
+    }
+    if (!codec) {
+        throw std::runtime_error("Codificador de video no disponible: " + config.codecName);
+    }
+
+    CodecContextPtr ctx(avcodec_alloc_context3(codec));
+    if (!ctx) {
+        throw std::runtime_error("No se pudo reservar el contexto del codificador de video");
+    }
+
+    ctx->width = config.width;
+    ctx->height = config.height;
+    ctx->pix_fmt = config.pixelFormat;
+    ctx->time_base = config.timeBase;
+    ctx->framerate = config.frameRate;
+    ctx->sample_aspect_ratio = config.sampleAspectRatio;
+    ctx->thread_count = config.threads;
+    if (config.bitrateKbps > 0) {
+        ctx->bit_rate = static_cast<int64_t>(config.bitrateKbps) * 1000;
+    }
+    if (config.maxBitrateKbps > 0) {
+        ctx->rc_max_rate = static_cast<int64_t>(config.maxBitrateKbps) * 1000;
+    }
+    if (config.bufsizeKbps > 0) {
+        ctx->rc_buffer_size = config.bufsizeKbps * 1000;
+    }
+    if (config.gopSize > 0) {
+        ctx->gop_size = config.gopSize;
+        ctx->keyint_min = config.gopSize;
+    }
+    if (config.globalHeader) {
+        ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+
+    // Opciones privadas: se ignoran si el codificador no las soporta
+    if (!config.preset.empty()) {
+        av_opt_set(ctx->priv_data, "preset", config.preset.c_str(), 0);
+    }
+    if (!config.profile.empty()) {
+        av_opt_set(ctx->priv_data, "profile", config.profile.c_str(), 0);
+    }
+
+    int ret = avcodec_open2(ctx.get(), codec, nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo abrir el codificador de video: " + avErrorToString(ret));
+    }
+    return ctx;
+}
+
+} // namespace StreamVio
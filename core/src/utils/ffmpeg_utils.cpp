@@ -0,0 +1,104 @@
+// StreamVio/core/src/utils/ffmpeg_utils.cpp
+#include "utils/ffmpeg_utils.h"
+
+#include <mutex>
+#include <stdexcept>
+
+extern "C" {
+#include <libavutil/error.h>
+#include <libavutil/log.h>
+}
+
+namespace StreamVio {
+
+std::string avErrorToString(int errorCode) {
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+    av_strerror(errorCode, buffer, sizeof(buffer));
+    return std::string(buffer);
+}
+
+void initializeFFmpeg() {
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        // Solo errores: stdout/stderr se usan para la salida de los comandos
+        av_log_set_level(AV_LOG_ERROR);
+    });
+}
+
+InputFormatPtr openInput(const std::string& path, AVDictionary** options) {
+    AVFormatContext* rawCtx = nullptr;
+    int ret = avformat_open_input(&rawCtx, path.c_str(), nullptr, options);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo abrir " + path + ": " + avErrorToString(ret));
+    }
+    return InputFormatPtr(rawCtx);
+}
+
+CodecContextPtr openDecoder(const AVStream* stream, int threads) {
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec) {
+        throw std::runtime_error(std::string("Decodificador no disponible: ") +
+                                 avcodec_get_name(stream->codecpar->codec_id));
+    }
+
+    CodecContextPtr ctx(avcodec_alloc_context3(codec));
+    if (!ctx) {
+        throw std::runtime_error("No se pudo reservar el contexto del decodificador");
+    }
+
+    int ret = avcodec_parameters_to_context(ctx.get(), stream->codecpar);
+    if (ret < 0) {
+        throw std::runtime_error("Parámetros de codec inválidos: " + avErrorToString(ret));
+    }
+    ctx->pkt_timebase = stream->time_base;
+    ctx->thread_count = threads;
+
+    ret = avcodec_open2(ctx.get(), codec, nullptr);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo abrir el decodificador: " + avErrorToString(ret));
+    }
+    return ctx;
+}
+
+OutputFormatPtr createOutput(const std::string& path, const std::string& formatName) {
+    AVFormatContext* rawCtx = nullptr;
+    int ret = avformat_alloc_output_context2(&rawCtx, nullptr,
+                                             formatName.empty() ? nullptr : formatName.c_str(),
+                                             path.c_str());
+    if (ret < 0 || !rawCtx) {
+        throw std::runtime_error("No se pudo crear la salida " + path + ": " + avErrorToString(ret));
+    }
+    return OutputFormatPtr(rawCtx);
+}
+
+void writeOutputHeader(AVFormatContext* ctx, const std::string& path, AVDictionary** options) {
+    int ret = 0;
+    if (!(ctx->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&ctx->pb, path.c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            throw std::runtime_error("No se pudo abrir " + path + " para escritura: " + avErrorToString(ret));
+        }
+    }
+
+    ret = avformat_write_header(ctx, options);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo escribir la cabecera de " + path + ": " + avErrorToString(ret));
+    }
+}
+
+FramePtr allocVideoFrame(int width, int height, AVPixelFormat format) {
+    FramePtr frame(av_frame_alloc());
+    if (!frame) {
+        throw std::runtime_error("No se pudo reservar el frame");
+    }
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+    int ret = av_frame_get_buffer(frame.get(), 0);
+    if (ret < 0) {
+        throw std::runtime_error("No se pudo reservar el buffer del frame: " + avErrorToString(ret));
+    }
+    return frame;
+}
+
+} // namespace StreamVio
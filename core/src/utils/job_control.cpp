@@ -0,0 +1,50 @@
+// StreamVio/core/src/utils/job_control.cpp
+#include "utils/job_control.h"
+
+namespace StreamVio {
+
+void JobControl::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+    }
+    stateChanged.notify_all();
+}
+
+void JobControl::pause() {
+    std::lock_guard<std::mutex> lock(mutex);
+    paused = true;
+}
+
+void JobControl::resume() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        paused = false;
+    }
+    stateChanged.notify_all();
+}
+
+void JobControl::checkpoint() {
+    // Camino rápido sin bloqueo: se llama una vez por paquete
+    if (!paused.load(std::memory_order_relaxed) && !cancelled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    stateChanged.wait(lock, [this] { return !paused || cancelled; });
+    if (cancelled) {
+        throw JobCancelled();
+    }
+}
+
+void JobControl::setError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    errorMessage = message;
+}
+
+std::string JobControl::error() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorMessage;
+}
+
+} // namespace StreamVio
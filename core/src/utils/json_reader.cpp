@@ -0,0 +1,191 @@
+// StreamVio/core/src/utils/json_reader.cpp
+#include "utils/json_reader.h"
+
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+
+namespace StreamVio {
+
+namespace {
+
+class FlatJsonParser {
+public:
+    explicit FlatJsonParser(const std::string& text) : text(text) {}
+
+    std::map<std::string, std::string> parse() {
+        std::map<std::string, std::string> result;
+        skipSpace();
+        expect('{');
+        skipSpace();
+        if (peek() == '}') {
+            pos++;
+        } else {
+            while (true) {
+                skipSpace();
+                std::string key = parseString();
+                skipSpace();
+                expect(':');
+                skipSpace();
+                result[key] = parseValue();
+                skipSpace();
+                if (peek() == ',') {
+                    pos++;
+                    continue;
+                }
+                expect('}');
+                break;
+            }
+        }
+        skipSpace();
+        if (pos != text.size()) {
+            fail("contenido tras el objeto");
+        }
+        return result;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& reason) const {
+        throw std::runtime_error("JSON inválido en la posición " + std::to_string(pos) + ": " + reason);
+    }
+
+    char peek() const {
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail(std::string("se esperaba '") + c + "'");
+        }
+        pos++;
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+    }
+
+    std::string parseValue() {
+        char c = peek();
+        if (c == '"') {
+            return parseString();
+        }
+        if (c == '{' || c == '[') {
+            fail("no se admiten valores anidados");
+        }
+
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+               !std::isspace(static_cast<unsigned char>(text[pos]))) {
+            pos++;
+        }
+        std::string literal = text.substr(start, pos - start);
+        if (literal.empty()) {
+            fail("valor vacío");
+        }
+        if (literal != "true" && literal != "false" && literal != "null" &&
+            literal.find_first_not_of("+-0123456789.eE") != std::string::npos) {
+            fail("valor no reconocido: " + literal);
+        }
+        return literal;
+    }
+
+    uint32_t parseHex4() {
+        if (pos + 4 > text.size()) {
+            fail("escape \\u incompleto");
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                fail("escape \\u inválido");
+            }
+        }
+        return value;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t codepoint) {
+        if (codepoint < 0x80) {
+            out += static_cast<char>(codepoint);
+        } else if (codepoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if (codepoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (true) {
+            if (pos >= text.size()) {
+                fail("cadena sin terminar");
+            }
+            char c = text[pos++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            char escape = peek();
+            pos++;
+            switch (escape) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    uint32_t codepoint = parseHex4();
+                    // Pares sustitutos UTF-16
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF &&
+                        text.compare(pos, 2, "\\u") == 0) {
+                        pos += 2;
+                        uint32_t low = parseHex4();
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            fail("par sustituto inválido");
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    fail("escape no reconocido");
+            }
+        }
+    }
+
+    const std::string& text;
+    size_t pos = 0;
+};
+
+} // namespace
+
+std::map<std::string, std::string> parseFlatJsonObject(const std::string& json) {
+    return FlatJsonParser(json).parse();
+}
+
+} // namespace StreamVio
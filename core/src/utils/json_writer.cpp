@@ -0,0 +1,102 @@
+// StreamVio/core/src/utils/json_writer.cpp
+#include "utils/json_writer.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace StreamVio {
+
+std::string jsonEscape(const std::string& value) {
+    std::string out;
+    out.reserve(value.size() + 8);
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out;
+}
+
+void JsonWriter::appendKey(const std::string& key) {
+    if (!body.empty()) {
+        body += ',';
+    }
+    body += '"';
+    body += jsonEscape(key);
+    body += "\":";
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, const std::string& value) {
+    appendKey(key);
+    body += '"';
+    body += jsonEscape(value);
+    body += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, const char* value) {
+    return field(key, std::string(value ? value : ""));
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, int64_t value) {
+    appendKey(key);
+    body += std::to_string(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, int value) {
+    return field(key, static_cast<int64_t>(value));
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, double value) {
+    appendKey(key);
+    // JSON no admite NaN ni infinito
+    if (!std::isfinite(value)) {
+        body += "null";
+        return *this;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    body += buffer;
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, bool value) {
+    appendKey(key);
+    body += value ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const std::string& key, const std::map<std::string, std::string>& value) {
+    JsonWriter nested;
+    for (const auto& pair : value) {
+        nested.field(pair.first, pair.second);
+    }
+    return raw(key, nested.str());
+}
+
+JsonWriter& JsonWriter::raw(const std::string& key, const std::string& json) {
+    appendKey(key);
+    body += json;
+    return *this;
+}
+
+std::string JsonWriter::str() const {
+    return "{" + body + "}";
+}
+
+} // namespace StreamVio
@@ -0,0 +1,90 @@
+// StreamVio/core/src/utils/thread_pool.cpp
+#include "utils/thread_pool.h"
+
+#include <exception>
+#include <iostream>
+
+namespace StreamVio {
+
+size_t ThreadPool::defaultThreadCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 2;
+}
+
+ThreadPool::ThreadPool(size_t threads, size_t maxQueued)
+    : maxQueued(maxQueued) {
+    if (threads == 0) {
+        threads = defaultThreadCount();
+    }
+    if (this->maxQueued == 0) {
+        this->maxQueued = threads * 4;
+    }
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    spaceAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    spaceAvailable.wait(lock, [this]() { return stopping || tasks.size() < maxQueued; });
+    if (stopping) {
+        return;
+    }
+    tasks.push_back(std::move(task));
+    lock.unlock();
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return tasks.empty() && activeTasks == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping y sin trabajo pendiente
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            ++activeTasks;
+        }
+        spaceAvailable.notify_one();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Error en tarea del pool: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Error desconocido en tarea del pool" << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeTasks;
+            if (tasks.empty() && activeTasks == 0) {
+                idle.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace StreamVio
@@ -0,0 +1,110 @@
+// StreamVio/core/tests/http_parsing_test.cpp
+#include "server/http_parsing.h"
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+TEST(percentDecodeDecodesEscapes) {
+    std::string out;
+    CHECK(percentDecode("/pel%C3%ADculas/a%20b.mp4", out, false));
+    CHECK_EQ(out, std::string("/pel\xC3\xAD" "culas/a b.mp4"));
+    CHECK(percentDecode("%2e%2E", out, false));
+    CHECK_EQ(out, std::string(".."));
+}
+
+TEST(percentDecodePlusOnlyInQueries) {
+    std::string out;
+    CHECK(percentDecode("a+b", out, false));
+    CHECK_EQ(out, std::string("a+b"));
+    CHECK(percentDecode("a+b", out, true));
+    CHECK_EQ(out, std::string("a b"));
+}
+
+TEST(percentDecodeRejectsMalformedAndNul) {
+    std::string out;
+    CHECK(!percentDecode("abc%", out, false));
+    CHECK(!percentDecode("abc%4", out, false));
+    CHECK(!percentDecode("%zz", out, false));
+    CHECK(!percentDecode("a%00b", out, false));
+}
+
+TEST(trimRemovesSpacesAndTabs) {
+    CHECK_EQ(trim("  \tvalor \t"), std::string("valor"));
+    CHECK_EQ(trim(" \t "), std::string());
+    CHECK_EQ(trim("a b"), std::string("a b"));
+}
+
+TEST(parseRangeClosedAndOpen) {
+    int64_t start = -1;
+    int64_t end = -1;
+    CHECK(parseRange("bytes=0-99", 1000, start, end) == RangeResult::Satisfiable);
+    CHECK_EQ(start, 0);
+    CHECK_EQ(end, 99);
+
+    CHECK(parseRange(" bytes= 500 - ", 1000, start, end) == RangeResult::Satisfiable);
+    CHECK_EQ(start, 500);
+    CHECK_EQ(end, 999);
+
+    // El final se recorta al tamaño del archivo
+    CHECK(parseRange("bytes=900-5000", 1000, start, end) == RangeResult::Satisfiable);
+    CHECK_EQ(start, 900);
+    CHECK_EQ(end, 999);
+}
+
+TEST(parseRangeSuffix) {
+    int64_t start = -1;
+    int64_t end = -1;
+    CHECK(parseRange("bytes=-100", 1000, start, end) == RangeResult::Satisfiable);
+    CHECK_EQ(start, 900);
+    CHECK_EQ(end, 999);
+
+    CHECK(parseRange("bytes=-5000", 1000, start, end) == RangeResult::Satisfiable);
+    CHECK_EQ(start, 0);
+    CHECK_EQ(end, 999);
+
+    CHECK(parseRange("bytes=-0", 1000, start, end) == RangeResult::Unsatisfiable);
+    CHECK(parseRange("bytes=-10", 0, start, end) == RangeResult::Unsatisfiable);
+}
+
+TEST(parseRangeUnsatisfiable) {
+    int64_t start = -1;
+    int64_t end = -1;
+    CHECK(parseRange("bytes=1000-", 1000, start, end) == RangeResult::Unsatisfiable);
+    CHECK(parseRange("bytes=0-", 0, start, end) == RangeResult::Unsatisfiable);
+}
+
+TEST(parseRangeIgnoresUnsupported) {
+    int64_t start = -1;
+    int64_t end = -1;
+    CHECK(parseRange("", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("items=0-1", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=0-1,5-9", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=5", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=9-5", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=a-5", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=-", 1000, start, end) == RangeResult::None);
+    CHECK(parseRange("bytes=+1-5", 1000, start, end) == RangeResult::None);
+    // Más de 18 cifras no cabe con seguridad en un int64_t
+    CHECK(parseRange("bytes=0-1234567890123456789", 1000, start, end) == RangeResult::None);
+}
+
+TEST(isSafeRelativePathAcceptsPlainPaths) {
+    CHECK(isSafeRelativePath("video.mp4"));
+    CHECK(isSafeRelativePath("serie/temporada 1/episodio.mkv"));
+    CHECK(isSafeRelativePath("..oculto/a.ts"));
+    CHECK(isSafeRelativePath("a/.b"));
+}
+
+TEST(isSafeRelativePathRejectsTraversal) {
+    CHECK(!isSafeRelativePath(""));
+    CHECK(!isSafeRelativePath(".."));
+    CHECK(!isSafeRelativePath("../etc/passwd"));
+    CHECK(!isSafeRelativePath("a/../../b"));
+    CHECK(!isSafeRelativePath("a/./b"));
+    CHECK(!isSafeRelativePath("/absoluta"));
+    CHECK(!isSafeRelativePath("a//b"));
+    CHECK(!isSafeRelativePath("a/"));
+}
+
+STREAMVIO_TEST_MAIN()
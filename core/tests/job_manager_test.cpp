@@ -0,0 +1,190 @@
+// StreamVio/core/tests/job_manager_test.cpp
+#include "daemon/job_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+namespace {
+
+bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+JobState stateOf(const JobManager& manager, int64_t id) {
+    auto status = manager.status(id);
+    if (!status) {
+        throw std::runtime_error("Trabajo desconocido: " + std::to_string(id));
+    }
+    return status->state;
+}
+
+// Trabajo que pasa por checkpoint() hasta que se le deja terminar
+struct GatedJob {
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    std::atomic<int> checkpoints{0};
+
+    JobManager::JobFunction function() {
+        return [this](const std::shared_ptr<JobControl>& control, std::function<void(int)> progress) {
+            started = true;
+            while (!release) {
+                control->checkpoint();
+                checkpoints++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            progress(50);
+            return true;
+        };
+    }
+};
+
+} // namespace
+
+TEST(clampsCoresToBudget) {
+    JobManager manager(4);
+    CHECK_EQ(manager.coreBudget(), 4);
+    CHECK_EQ(manager.clampCores(0), 1);
+    CHECK_EQ(manager.clampCores(3), 3);
+    CHECK_EQ(manager.clampCores(16), 4);
+}
+
+TEST(parsesPriorities) {
+    JobPriority priority = JobPriority::Background;
+    CHECK(parseJobPriority("interactive", priority));
+    CHECK(priority == JobPriority::Interactive);
+    CHECK(parseJobPriority("", priority));
+    CHECK(priority == JobPriority::Normal);
+    CHECK(!parseJobPriority("urgente", priority));
+    CHECK_EQ(std::string(toString(JobPriority::Background)), std::string("background"));
+    CHECK_EQ(std::string(toString(JobState::Paused)), std::string("paused"));
+}
+
+TEST(interactiveJobPreemptsBackgroundJob) {
+    JobManager manager(2);
+    GatedJob background;
+    int64_t backgroundId = manager.submit("hls", "/lib/a", JobPriority::Background, 2, background.function());
+    CHECK(waitFor([&]() { return background.started.load(); }));
+    CHECK(stateOf(manager, backgroundId) == JobState::Running);
+
+    GatedJob interactive;
+    int64_t interactiveId = manager.submit("transcode", "/tmp/b", JobPriority::Interactive, 2,
+                                           interactive.function());
+    // El de fondo cede sus núcleos al instante, sin esperar a que termine
+    CHECK(stateOf(manager, backgroundId) == JobState::Paused);
+    CHECK(stateOf(manager, interactiveId) == JobState::Running);
+    CHECK_EQ(manager.coresInUse(), 2);
+    CHECK(waitFor([&]() { return interactive.started.load(); }));
+
+    // En pausa el trabajo queda bloqueado en checkpoint()
+    int before = background.checkpoints;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(background.checkpoints - before <= 1);
+
+    interactive.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, interactiveId) == JobState::Completed; }));
+    CHECK(waitFor([&]() { return stateOf(manager, backgroundId) == JobState::Running; }));
+    int resumed = background.checkpoints;
+    CHECK(waitFor([&]() { return background.checkpoints > resumed; }));
+
+    background.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, backgroundId) == JobState::Completed; }));
+    CHECK_EQ(manager.status(backgroundId)->progress, 100);
+    CHECK(waitFor([&]() { return manager.coresInUse() == 0; }));
+}
+
+TEST(samePriorityWaitsInsteadOfPreempting) {
+    JobManager manager(2);
+    GatedJob first;
+    GatedJob second;
+    int64_t firstId = manager.submit("transcode", "/tmp/a", JobPriority::Normal, 2, first.function());
+    int64_t secondId = manager.submit("transcode", "/tmp/b", JobPriority::Normal, 1, second.function());
+    CHECK(stateOf(manager, firstId) == JobState::Running);
+    CHECK(stateOf(manager, secondId) == JobState::Queued);
+
+    first.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, secondId) == JobState::Running; }));
+    second.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, secondId) == JobState::Completed; }));
+}
+
+TEST(pausedJobResumesBeforeNewerJobOfSamePriority) {
+    JobManager manager(1);
+    GatedJob paused;
+    int64_t pausedId = manager.submit("hls", "/lib/a", JobPriority::Background, 1, paused.function());
+    CHECK(waitFor([&]() { return paused.started.load(); }));
+
+    GatedJob urgent;
+    int64_t urgentId = manager.submit("transcode", "/tmp/b", JobPriority::Interactive, 1, urgent.function());
+    GatedJob queued;
+    int64_t queuedId = manager.submit("hls", "/lib/c", JobPriority::Background, 1, queued.function());
+    CHECK(stateOf(manager, pausedId) == JobState::Paused);
+    CHECK(stateOf(manager, queuedId) == JobState::Queued);
+
+    urgent.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, urgentId) == JobState::Completed; }));
+    CHECK(waitFor([&]() { return stateOf(manager, pausedId) == JobState::Running; }));
+    CHECK(stateOf(manager, queuedId) == JobState::Queued);
+
+    paused.release = true;
+    queued.release = true;
+    CHECK(waitFor([&]() { return stateOf(manager, queuedId) == JobState::Completed; }));
+}
+
+TEST(cancelsQueuedPausedAndRunningJobs) {
+    JobManager manager(1);
+    GatedJob running;
+    int64_t runningId = manager.submit("hls", "/lib/a", JobPriority::Background, 1, running.function());
+    CHECK(waitFor([&]() { return running.started.load(); }));
+    GatedJob urgent;
+    int64_t urgentId = manager.submit("transcode", "/tmp/b", JobPriority::Interactive, 1, urgent.function());
+    GatedJob queued;
+    int64_t queuedId = manager.submit("transcode", "/tmp/c", JobPriority::Normal, 1, queued.function());
+    CHECK(stateOf(manager, runningId) == JobState::Paused);
+
+    CHECK(manager.cancel(queuedId));
+    CHECK(stateOf(manager, queuedId) == JobState::Cancelled);
+    CHECK(!manager.cancel(queuedId));
+
+    // El pausado se despierta para salir
+    CHECK(manager.cancel(runningId));
+    CHECK(waitFor([&]() { return stateOf(manager, runningId) == JobState::Cancelled; }));
+
+    CHECK(manager.cancel(urgentId));
+    CHECK(waitFor([&]() { return stateOf(manager, urgentId) == JobState::Cancelled; }));
+    CHECK(waitFor([&]() { return manager.coresInUse() == 0; }));
+    CHECK(!queued.started);
+    CHECK(!manager.cancel(12345));
+}
+
+TEST(reportsFailureReason) {
+    JobManager manager(1);
+    int64_t thrown = manager.submit("probe", "/a", JobPriority::Normal, 1,
+        [](const std::shared_ptr<JobControl>&, std::function<void(int)>) -> bool {
+            throw std::runtime_error("entrada dañada");
+        });
+    int64_t returned = manager.submit("probe", "/b", JobPriority::Normal, 1,
+        [](const std::shared_ptr<JobControl>& control, std::function<void(int)>) {
+            control->setError("sin video");
+            return false;
+        });
+    CHECK(waitFor([&]() { return stateOf(manager, returned) == JobState::Failed; }));
+    CHECK(waitFor([&]() { return stateOf(manager, thrown) == JobState::Failed; }));
+    CHECK_EQ(manager.status(thrown)->error, std::string("entrada dañada"));
+    CHECK_EQ(manager.status(returned)->error, std::string("sin video"));
+}
+
+STREAMVIO_TEST_MAIN()
@@ -0,0 +1,68 @@
+// StreamVio/core/tests/json_reader_test.cpp
+#include "utils/json_reader.h"
+
+#include <string>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+TEST(parsesStringsAndLiterals) {
+    auto object = parseFlatJsonObject(
+        R"({"op": "transcode", "cores": 4, "ratio": -1.5e3, "ok": true, "no": false, "nada": null})");
+    CHECK_EQ(object.size(), size_t(6));
+    CHECK_EQ(object["op"], std::string("transcode"));
+    CHECK_EQ(object["cores"], std::string("4"));
+    CHECK_EQ(object["ratio"], std::string("-1.5e3"));
+    CHECK_EQ(object["ok"], std::string("true"));
+    CHECK_EQ(object["no"], std::string("false"));
+    CHECK_EQ(object["nada"], std::string("null"));
+}
+
+TEST(parsesEmptyObjectWithSpaces) {
+    CHECK(parseFlatJsonObject("  { }  ").empty());
+    CHECK(parseFlatJsonObject("{}").empty());
+}
+
+TEST(decodesEscapes) {
+    auto object = parseFlatJsonObject(R"({"ruta":"C:\\v\\a \"b\".mkv","salto":"a\nb\tc\/d"})");
+    CHECK_EQ(object["ruta"], std::string("C:\\v\\a \"b\".mkv"));
+    CHECK_EQ(object["salto"], std::string("a\nb\tc/d"));
+}
+
+TEST(decodesUnicodeEscapes) {
+    auto object = parseFlatJsonObject(R"({"a":"\u00f1","b":"\u20ac","c":"\ud83c\udfac"})");
+    CHECK_EQ(object["a"], std::string("\xC3\xB1"));
+    CHECK_EQ(object["b"], std::string("\xE2\x82\xAC"));
+    CHECK_EQ(object["c"], std::string("\xF0\x9F\x8E\xAC"));
+}
+
+TEST(lastDuplicateKeyWins) {
+    auto object = parseFlatJsonObject(R"({"id":"1","id":"2"})");
+    CHECK_EQ(object["id"], std::string("2"));
+}
+
+TEST(rejectsInvalidDocuments) {
+    const char* documents[] = {
+        "",
+        "[]",
+        "{",
+        R"({"a":1,})",
+        R"({"a" 1})",
+        R"({a:1})",
+        R"({"a":})",
+        R"({"a":"sin cerrar})",
+        R"({"a":{"b":1}})",
+        R"({"a":[1,2]})",
+        R"({"a":undefined})",
+        R"({"a":1} basura)",
+        R"({"a":"\x"})",
+        R"({"a":"\u12"})",
+        R"({"a":"\ud83c\u0041"})",
+    };
+    for (const char* document : documents) {
+        CHECK_THROWS(parseFlatJsonObject(document));
+    }
+}
+
+STREAMVIO_TEST_MAIN()
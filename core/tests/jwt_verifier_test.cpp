@@ -0,0 +1,140 @@
+// StreamVio/core/tests/jwt_verifier_test.cpp
+#include "server/jwt_verifier.h"
+
+#include <map>
+#include <string>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+namespace {
+
+// Tokens HS256 firmados con kSecret fuera de StreamVio (mismo formato que
+// jsonwebtoken.sign en el servidor Node), para no validar la firma con la
+// misma implementación que la comprueba
+const char* const kSecret = "secreto-de-prueba";
+
+// {"id":7,"username":"ana","iat":1700000000,"exp":1700003600}
+const char* const kValid =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6NywidXNlcm5hbWUiOiJhbmEiLCJpYXQiOjE3MDAwMDAwMDAsImV4cCI6MTcwMDAwMzYwMH0."
+    "tO6lKetP1PQY9Ik4HWwM-vRnZtFkGGxBK0EH5Mj16xc";
+// El mismo payload firmado con "otro-secreto"
+const char* const kWrongSecret =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6NywidXNlcm5hbWUiOiJhbmEiLCJpYXQiOjE3MDAwMDAwMDAsImV4cCI6MTcwMDAwMzYwMH0."
+    "5qqYzAPk1rb3LVpMtP0yworiYpCD8HI1JsjCSa_C4Rw";
+// kValid con "id":1 en el payload y la firma original
+const char* const kTampered =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6MSwidXNlcm5hbWUiOiJhbmEiLCJpYXQiOjE3MDAwMDAwMDAsImV4cCI6MTcwMDAwMzYwMH0."
+    "tO6lKetP1PQY9Ik4HWwM-vRnZtFkGGxBK0EH5Mj16xc";
+// {"id":7,"nbf":1700000100}
+const char* const kNotBefore =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6NywibmJmIjoxNzAwMDAwMTAwfQ."
+    "c33r9CLszeje929GOMfp965a-jWqlyM4Hg0vIDR91O0";
+// {"alg":"HS512"} con firma HS256 válida
+const char* const kOtherAlgorithm =
+    "eyJhbGciOiJIUzUxMiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6N30."
+    "lSk7ZRrN0wAB8h-BxRZSeXkMj76ZJpt6dwunXfZLHv4";
+// {"alg":"none"} sin firma
+const char* const kNoneAlgorithm = "eyJhbGciOiJub25lIiwidHlwIjoiSldUIn0.eyJpZCI6N30.";
+// {"id":7,"exp":"mañana"}
+const char* const kBadExpiry =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6NywiZXhwIjoibWHDsWFuYSJ9."
+    "_XjV_jiV6qQIpL_yNnEADNa4CyRIEEDZrQnkJTDNfnU";
+// {"id":7,"roles":["admin"]}: payload que no es un objeto plano
+const char* const kNestedPayload =
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9."
+    "eyJpZCI6Nywicm9sZXMiOlsiYWRtaW4iXX0."
+    "hH5CpssI-0rxVtEZkYucXKC_mWGhSKP94UbQRfKvsYw";
+
+const int64_t kIssuedAt = 1700000000;
+const int64_t kExpiry = 1700003600;
+
+bool verify(const std::string& token, int64_t now, std::map<std::string, std::string>& claims,
+            std::string& error) {
+    return JwtVerifier(kSecret).verify(token, now, claims, error);
+}
+
+} // namespace
+
+TEST(acceptsValidToken) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(verify(kValid, kIssuedAt + 60, claims, error));
+    CHECK(error.empty());
+    CHECK_EQ(claims["id"], std::string("7"));
+    CHECK_EQ(claims["username"], std::string("ana"));
+}
+
+TEST(rejectsExpiredToken) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(verify(kValid, kExpiry - 1, claims, error));
+    CHECK(!verify(kValid, kExpiry, claims, error));
+    CHECK_EQ(error, std::string("TOKEN_EXPIRED"));
+    CHECK(claims.empty());
+}
+
+TEST(rejectsWrongSignature) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(!verify(kWrongSecret, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+    CHECK(claims.empty());
+
+    CHECK(!verify(kTampered, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+
+    CHECK(!JwtVerifier("").verify(kValid, kIssuedAt, claims, error));
+}
+
+TEST(rejectsOtherAlgorithms) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(!verify(kOtherAlgorithm, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+    CHECK(!verify(kNoneAlgorithm, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+}
+
+TEST(honoursNotBefore) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(!verify(kNotBefore, 1700000099, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+    CHECK(verify(kNotBefore, 1700000100, claims, error));
+}
+
+TEST(rejectsMalformedClaims) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    CHECK(!verify(kBadExpiry, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+    CHECK(!verify(kNestedPayload, kIssuedAt, claims, error));
+    CHECK_EQ(error, std::string("INVALID_TOKEN"));
+}
+
+TEST(rejectsMalformedTokens) {
+    std::map<std::string, std::string> claims;
+    std::string error;
+    const char* tokens[] = {
+        "",
+        "abc",
+        "a.b",
+        "a.b.c.d",
+        "eyJhbGciOiJIUzI1NiJ9.eyJpZCI6N30.firma+con/base64=estandar",
+        "!!!.eyJpZCI6N30.tO6lKetP1PQY9Ik4HWwM-vRnZtFkGGxBK0EH5Mj16xc",
+    };
+    for (const char* token : tokens) {
+        CHECK(!verify(token, kIssuedAt, claims, error));
+        CHECK_EQ(error, std::string("INVALID_TOKEN"));
+    }
+}
+
+STREAMVIO_TEST_MAIN()
@@ -0,0 +1,212 @@
+// StreamVio/core/tests/keyframe_index_test.cpp
+#include "analyzer/keyframe_index.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int32_t kVideoType = 0;   // AVMEDIA_TYPE_VIDEO
+const int32_t kAudioType = 1;   // AVMEDIA_TYPE_AUDIO
+
+// Directorio temporal propio de cada prueba, con un "origen" de 10000 bytes
+class Fixture {
+public:
+    Fixture() {
+        char pattern[] = "/tmp/streamvio_kfidx_XXXXXX";
+        directory = ::mkdtemp(pattern);
+        source = directory + "/video.ts";
+        std::ofstream(source, std::ios::binary) << std::string(10000, 'x');
+        index = source + ".svidx";
+    }
+    ~Fixture() {
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    // Índice con un stream de video (base 1/90000, inicio 1 s) con
+    // keyframes cada 2 s y un stream de audio (base 1/48000)
+    std::string build(uint32_t version = kKeyframeIndexVersion) const {
+        struct stat st;
+        ::stat(source.c_str(), &st);
+
+        std::vector<KeyframeIndexStream> streams(2);
+        streams[0] = {0, kVideoType, 1, 90000, 0, 4};
+        streams[1] = {1, kAudioType, 1, 48000, 4, 2};
+
+        std::vector<KeyframeIndexEntry> entries = {
+            {90000, 0, 1000, 0},
+            {270000, 2000, 1000, 0},
+            {450000, 4000, 1000, 0},
+            {630000, 6000, 1000, 0},
+            {48000, 100, 400, 0},
+            {96000, 2100, 400, 0},
+        };
+
+        KeyframeIndexHeader header{};
+        std::memcpy(header.magic, "SVKFIDX", 8);
+        header.version = version;
+        header.streamCount = static_cast<uint32_t>(streams.size());
+        header.sourceSize = static_cast<uint64_t>(st.st_size);
+        header.sourceMtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+        header.totalSize = sizeof(header) + streams.size() * sizeof(KeyframeIndexStream) +
+                           entries.size() * sizeof(KeyframeIndexEntry);
+        header.startTimeUs = 1000000;
+        header.durationUs = 8000000;
+
+        std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+        data.append(reinterpret_cast<const char*>(streams.data()), streams.size() * sizeof(KeyframeIndexStream));
+        data.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(KeyframeIndexEntry));
+        return data;
+    }
+
+    void write(const std::string& data) const {
+        std::ofstream(index, std::ios::binary | std::ios::trunc) << data;
+    }
+
+    std::string directory;
+    std::string source;
+    std::string index;
+};
+
+} // namespace
+
+TEST(opensValidIndex) {
+    Fixture fixture;
+    fixture.write(fixture.build());
+    auto index = KeyframeIndex::open(fixture.index, fixture.source);
+    CHECK(index != nullptr);
+    CHECK_EQ(index->header().streamCount, 2u);
+    CHECK(index->matchesSource(fixture.source));
+
+    const KeyframeIndexStream* video = index->findStream(0);
+    CHECK(video != nullptr);
+    CHECK_EQ(video->entryCount, 4u);
+    CHECK(index->primaryStream() == video);
+    CHECK(index->findStream(1) != nullptr);
+    CHECK(index->findStream(5) == nullptr);
+    CHECK_EQ(index->entries(*index->findStream(1))[0].pts, 48000);
+}
+
+TEST(findsKeyframesAroundPts) {
+    Fixture fixture;
+    fixture.write(fixture.build());
+    auto index = KeyframeIndex::open(fixture.index, fixture.source);
+    CHECK(index != nullptr);
+    const KeyframeIndexStream& video = *index->findStream(0);
+
+    CHECK(index->keyframeAtOrBefore(video, 89999) == nullptr);
+    CHECK_EQ(index->keyframeAtOrBefore(video, 90000)->pts, 90000);
+    CHECK_EQ(index->keyframeAtOrBefore(video, 400000)->pts, 270000);
+    CHECK_EQ(index->keyframeAtOrBefore(video, 10000000)->pts, 630000);
+
+    CHECK_EQ(index->keyframeAtOrAfter(video, 0)->pts, 90000);
+    CHECK_EQ(index->keyframeAtOrAfter(video, 270000)->pts, 270000);
+    CHECK_EQ(index->keyframeAtOrAfter(video, 270001)->pts, 450000);
+    CHECK(index->keyframeAtOrAfter(video, 630001) == nullptr);
+}
+
+TEST(computesByteRanges) {
+    Fixture fixture;
+    fixture.write(fixture.build());
+    auto index = KeyframeIndex::open(fixture.index, fixture.source);
+    CHECK(index != nullptr);
+    const KeyframeIndexStream& video = *index->findStream(0);
+
+    ByteRange range;
+    CHECK(index->byteRange(video, 300000, 450000, range));
+    CHECK_EQ(range.offset, 2000);
+    CHECK_EQ(range.length, 2000);
+
+    // Sin keyframe posterior se lee hasta el final del origen
+    CHECK(index->byteRange(video, 700000, 800000, range));
+    CHECK_EQ(range.offset, 6000);
+    CHECK_EQ(range.length, 4000);
+
+    // Antes del primer keyframe se empieza por él
+    CHECK(index->byteRange(video, 0, 100000, range));
+    CHECK_EQ(range.offset, 0);
+    CHECK_EQ(range.length, 2000);
+}
+
+TEST(convertsBetweenMsAndPts) {
+    Fixture fixture;
+    fixture.write(fixture.build());
+    auto index = KeyframeIndex::open(fixture.index, fixture.source);
+    CHECK(index != nullptr);
+    const KeyframeIndexStream& video = *index->findStream(0);
+
+    // El inicio del contenedor (1 s) es el instante 0
+    CHECK_EQ(index->msToPts(video, 0), 90000);
+    CHECK_EQ(index->msToPts(video, 2000), 270000);
+    CHECK_EQ(index->ptsToMs(video, 450000), 4000);
+}
+
+TEST(rejectsDamagedIndexes) {
+    Fixture fixture;
+    std::string valid = fixture.build();
+
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+
+    fixture.write(valid.substr(0, valid.size() - 1));
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+
+    fixture.write(valid.substr(0, 10));
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+
+    std::string badMagic = valid;
+    badMagic[0] = 'X';
+    fixture.write(badMagic);
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+
+    fixture.write(fixture.build(kKeyframeIndexVersion + 1));
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+
+    // Un stream que apunta fuera del array de entradas
+    std::string badStream = valid;
+    KeyframeIndexStream stream;
+    std::memcpy(&stream, badStream.data() + sizeof(KeyframeIndexHeader), sizeof(stream));
+    stream.entryCount = 100;
+    std::memcpy(&badStream[sizeof(KeyframeIndexHeader)], &stream, sizeof(stream));
+    fixture.write(badStream);
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+}
+
+TEST(rejectsIndexOfChangedSource) {
+    Fixture fixture;
+    fixture.write(fixture.build());
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) != nullptr);
+
+    std::ofstream(fixture.source, std::ios::binary | std::ios::app) << "más";
+    CHECK(KeyframeIndex::open(fixture.index, fixture.source) == nullptr);
+    CHECK(KeyframeIndex::open(fixture.index, fixture.directory + "/no_existe.ts") == nullptr);
+}
+
+TEST(indexPathHonoursIndexDir) {
+    ::unsetenv("STREAMVIO_INDEX_DIR");
+    CHECK_EQ(keyframeIndexPath("/media/a.mkv"), std::string("/media/a.mkv.svidx"));
+
+    ::setenv("STREAMVIO_INDEX_DIR", "/var/cache/indices", 1);
+    std::string first = keyframeIndexPath("/media/a.mkv");
+    std::string second = keyframeIndexPath("/media/b.mkv");
+    ::unsetenv("STREAMVIO_INDEX_DIR");
+
+    CHECK_EQ(fs::path(first).parent_path().string(), std::string("/var/cache/indices"));
+    CHECK_EQ(fs::path(first).extension().string(), std::string(".svidx"));
+    CHECK(first != second);
+}
+
+STREAMVIO_TEST_MAIN()
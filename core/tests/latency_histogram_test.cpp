@@ -0,0 +1,135 @@
+// StreamVio/core/tests/latency_histogram_test.cpp
+#include "transcoder/transcode_metrics.h"
+
+#include <thread>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+namespace {
+
+// Cubeta en la que cae una única muestra
+size_t bucketOf(int64_t ns) {
+    LatencyHistogram histogram;
+    histogram.record(ns);
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+        if (snapshot.counts[i] == 1) {
+            return i;
+        }
+    }
+    return LatencyHistogram::kBuckets;
+}
+
+} // namespace
+
+TEST(upperBoundsArePowersOfTwoMicroseconds) {
+    CHECK_EQ(LatencyHistogram::upperBoundNs(0), 1000);
+    CHECK_EQ(LatencyHistogram::upperBoundNs(1), 2000);
+    CHECK_EQ(LatencyHistogram::upperBoundNs(10), 1024000);
+    CHECK_EQ(LatencyHistogram::upperBoundNs(LatencyHistogram::kBuckets - 1), int64_t(1000) << 23);
+}
+
+TEST(bucketsIncludeTheirUpperBound) {
+    CHECK_EQ(bucketOf(0), size_t(0));
+    CHECK_EQ(bucketOf(-5), size_t(0));
+    CHECK_EQ(bucketOf(1), size_t(0));
+    CHECK_EQ(bucketOf(1000), size_t(0));
+    CHECK_EQ(bucketOf(1001), size_t(1));
+    CHECK_EQ(bucketOf(2000), size_t(1));
+    CHECK_EQ(bucketOf(2001), size_t(2));
+    CHECK_EQ(bucketOf(4000), size_t(2));
+    CHECK_EQ(bucketOf(4001), size_t(3));
+    CHECK_EQ(bucketOf(1024000), size_t(10));
+    CHECK_EQ(bucketOf(1024001), size_t(11));
+}
+
+TEST(lastBucketCollectsEverythingLarger) {
+    size_t last = LatencyHistogram::kBuckets - 1;
+    CHECK_EQ(bucketOf(LatencyHistogram::upperBoundNs(last)), last);
+    CHECK_EQ(bucketOf(LatencyHistogram::upperBoundNs(last) + 1), last);
+    CHECK_EQ(bucketOf(int64_t(3600) * 1000000000), last);
+}
+
+TEST(snapshotCountsAndSums) {
+    LatencyHistogram histogram;
+    histogram.record(500);
+    histogram.record(1500);
+    histogram.record(1500);
+    histogram.record(3000);
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    CHECK_EQ(snapshot.count, uint64_t(4));
+    CHECK_EQ(snapshot.sumNs, int64_t(6500));
+    CHECK_EQ(snapshot.counts[0], uint64_t(1));
+    CHECK_EQ(snapshot.counts[1], uint64_t(2));
+    CHECK_EQ(snapshot.counts[2], uint64_t(1));
+}
+
+TEST(percentilesReturnBucketBounds) {
+    LatencyHistogram::Snapshot empty;
+    CHECK_EQ(empty.percentileNs(0.5), 0);
+
+    LatencyHistogram histogram;
+    for (int i = 0; i < 90; ++i) {
+        histogram.record(800);          // Cubeta 0
+    }
+    for (int i = 0; i < 9; ++i) {
+        histogram.record(3000);         // Cubeta 2
+    }
+    histogram.record(100000000);        // 100 ms: cubeta 17
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+
+    CHECK_EQ(snapshot.percentileNs(0.0), 1000);
+    CHECK_EQ(snapshot.percentileNs(0.5), 1000);
+    CHECK_EQ(snapshot.percentileNs(0.9), 1000);
+    CHECK_EQ(snapshot.percentileNs(0.95), 4000);
+    CHECK_EQ(snapshot.percentileNs(0.99), 4000);
+    CHECK_EQ(snapshot.percentileNs(1.0), LatencyHistogram::upperBoundNs(17));
+}
+
+TEST(recordsFromSeveralThreads) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram]() {
+            for (int i = 0; i < 10000; ++i) {
+                histogram.record(1500);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    CHECK_EQ(snapshot.count, uint64_t(40000));
+    CHECK_EQ(snapshot.counts[1], uint64_t(40000));
+    CHECK_EQ(snapshot.sumNs, int64_t(40000) * 1500);
+}
+
+TEST(metricsForwardToAggregate) {
+    TranscodeMetrics totals;
+    TranscodeMetrics job(&totals);
+    job.recordStage(TranscodeStage::Encode, 3000);
+    job.addFrames(2);
+    job.addBytesOut(100);
+    job.setMediaTime(5000000);
+
+    TranscodeMetricsSnapshot jobSnapshot = job.snapshot();
+    TranscodeMetricsSnapshot totalSnapshot = totals.snapshot();
+    CHECK_EQ(jobSnapshot.frames, uint64_t(2));
+    CHECK_EQ(totalSnapshot.frames, uint64_t(2));
+    CHECK_EQ(totalSnapshot.bytesOut, uint64_t(100));
+    CHECK_EQ(jobSnapshot.mediaTimeUs, int64_t(5000000));
+    // La posición es solo del trabajo
+    CHECK_EQ(totalSnapshot.mediaTimeUs, int64_t(0));
+
+    size_t encode = static_cast<size_t>(TranscodeStage::Encode);
+    CHECK_EQ(jobSnapshot.stages.size(), kTranscodeStageCount);
+    CHECK_EQ(jobSnapshot.stages[encode].name, std::string("encode"));
+    CHECK_EQ(jobSnapshot.stages[encode].latency.count, uint64_t(1));
+    CHECK_EQ(totalSnapshot.stages[encode].latency.count, uint64_t(1));
+}
+
+STREAMVIO_TEST_MAIN()
@@ -0,0 +1,137 @@
+// StreamVio/core/tests/library_index_test.cpp
+#include "scanner/library_scanner.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class Fixture {
+public:
+    Fixture() {
+        char pattern[] = "/tmp/streamvio_libidx_XXXXXX";
+        directory = ::mkdtemp(pattern);
+        index = directory + "/scan.idx";
+    }
+    ~Fixture() {
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    std::string read() const {
+        std::ifstream file(index, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+    void write(const std::string& data) const {
+        std::ofstream(index, std::ios::binary | std::ios::trunc) << data;
+    }
+
+    std::string directory;
+    std::string index;
+};
+
+std::vector<LibraryIndexEntry> sampleEntries() {
+    std::vector<LibraryIndexEntry> entries(3);
+    entries[0] = {"Películas/Amélie (2001).mkv", 2049, 131075, 4700000000LL, 1700000000123456789LL, 0x0123456789abcdefULL};
+    entries[1] = {"Series/Serie/T01/E01.mp4", 2049, 131076, 350000000, 1690000000000000000LL, 0};
+    entries[2] = {"musica.flac", 0, 0, 0, 0, 0xffffffffffffffffULL};
+    return entries;
+}
+
+bool sameEntries(const std::vector<LibraryIndexEntry>& a, const std::vector<LibraryIndexEntry>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].path != b[i].path || a[i].device != b[i].device || a[i].inode != b[i].inode ||
+            a[i].size != b[i].size || a[i].mtimeNs != b[i].mtimeNs || a[i].partialHash != b[i].partialHash) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(roundTripsEntries) {
+    Fixture fixture;
+    auto entries = sampleEntries();
+    saveLibraryIndex(fixture.index, "/srv/biblioteca", entries);
+    CHECK(!fs::exists(fixture.index + ".tmp"));
+
+    std::vector<LibraryIndexEntry> loaded;
+    CHECK(loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+    CHECK(sameEntries(loaded, entries));
+}
+
+TEST(roundTripsEmptyIndex) {
+    Fixture fixture;
+    saveLibraryIndex(fixture.index, "/srv/biblioteca", {});
+    std::vector<LibraryIndexEntry> loaded = sampleEntries();
+    CHECK(loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+    CHECK(loaded.empty());
+}
+
+TEST(rejectsMissingOrOtherRoot) {
+    Fixture fixture;
+    std::vector<LibraryIndexEntry> loaded;
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+
+    saveLibraryIndex(fixture.index, "/srv/biblioteca", sampleEntries());
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/otra", loaded));
+    CHECK(loaded.empty());
+}
+
+TEST(rejectsDamagedIndex) {
+    Fixture fixture;
+    saveLibraryIndex(fixture.index, "/srv/biblioteca", sampleEntries());
+    std::string valid = fixture.read();
+    std::vector<LibraryIndexEntry> loaded;
+
+    // Truncado a media entrada
+    fixture.write(valid.substr(0, valid.size() - 5));
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+    CHECK(loaded.empty());
+
+    // Bytes de más tras la última entrada
+    fixture.write(valid + "x");
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+
+    std::string badMagic = valid;
+    badMagic[0] ^= 0x20;
+    fixture.write(badMagic);
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+
+    // Versión distinta (justo tras la firma de 8 bytes)
+    std::string badVersion = valid;
+    badVersion[8] = static_cast<char>(kLibraryIndexVersion + 1);
+    fixture.write(badVersion);
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+
+    // Un recuento enorme no debe reservar memoria sin límite
+    std::string hugeCount = valid;
+    for (size_t i = 16; i < 24; ++i) {
+        hugeCount[i] = static_cast<char>(0xff);
+    }
+    fixture.write(hugeCount);
+    CHECK(!loadLibraryIndex(fixture.index, "/srv/biblioteca", loaded));
+}
+
+TEST(saveFailsOnUnwritableDirectory) {
+    Fixture fixture;
+    CHECK_THROWS(saveLibraryIndex(fixture.directory + "/no/existe/scan.idx", "/srv", sampleEntries()));
+}
+
+STREAMVIO_TEST_MAIN()
@@ -0,0 +1,141 @@
+// StreamVio/core/tests/spsc_queue_test.cpp
+#include "utils/spsc_queue.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "test_support.h"
+
+using namespace StreamVio;
+
+TEST(capacityRoundsUpToPowerOfTwo) {
+    CHECK_EQ(SpscQueue<int>(1).capacity(), size_t(1));
+    CHECK_EQ(SpscQueue<int>(5).capacity(), size_t(8));
+    CHECK_EQ(SpscQueue<int>(64).capacity(), size_t(64));
+}
+
+TEST(tryPushAndTryPopKeepOrder) {
+    SpscQueue<int> queue(4);
+    int value = 0;
+    CHECK(!queue.tryPop(value));
+    CHECK(queue.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.tryPush(i));
+    }
+    CHECK(queue.full());
+    CHECK(!queue.tryPush(99));
+    CHECK_EQ(queue.depth(), size_t(4));
+    CHECK_EQ(queue.maxDepth(), size_t(4));
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.tryPop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(queue.empty());
+}
+
+TEST(wrapsAroundTheRing) {
+    SpscQueue<int> queue(4);
+    int value = 0;
+    for (int round = 0; round < 10; ++round) {
+        CHECK(queue.tryPush(round * 2));
+        CHECK(queue.tryPush(round * 2 + 1));
+        CHECK(queue.tryPop(value));
+        CHECK_EQ(value, round * 2);
+        CHECK(queue.tryPop(value));
+        CHECK_EQ(value, round * 2 + 1);
+    }
+    CHECK_EQ(queue.maxDepth(), size_t(2));
+}
+
+TEST(closeDrainsPendingItems) {
+    SpscQueue<int> queue(4);
+    CHECK(queue.push(1));
+    CHECK(queue.push(2));
+    queue.close();
+    CHECK(queue.isClosed());
+    CHECK(!queue.drained());
+
+    int value = 0;
+    CHECK(queue.pop(value));
+    CHECK_EQ(value, 1);
+    CHECK(queue.pop(value));
+    CHECK_EQ(value, 2);
+    CHECK(queue.drained());
+    CHECK(!queue.pop(value));
+}
+
+TEST(closeWakesBlockedProducer) {
+    SpscQueue<int> queue(1);
+    CHECK(queue.push(1));
+    bool pushed = true;
+    std::thread producer([&]() { pushed = queue.push(2); });
+    queue.close();
+    producer.join();
+    CHECK(!pushed);
+}
+
+TEST(closeWakesBlockedConsumer) {
+    SpscQueue<int> queue(4);
+    bool popped = true;
+    std::thread consumer([&]() {
+        int value = 0;
+        popped = queue.pop(value);
+    });
+    queue.close();
+    consumer.join();
+    CHECK(!popped);
+}
+
+TEST(transfersEverythingBetweenThreads) {
+    const uint64_t kItems = 200000;
+    SpscQueue<uint64_t> queue(8);
+    std::thread producer([&]() {
+        for (uint64_t i = 1; i <= kItems; ++i) {
+            queue.push(i);
+        }
+        queue.close();
+    });
+
+    uint64_t expected = 1;
+    uint64_t sum = 0;
+    bool ordered = true;
+    uint64_t value = 0;
+    while (queue.pop(value)) {
+        ordered = ordered && value == expected;
+        ++expected;
+        sum += value;
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK_EQ(expected - 1, kItems);
+    CHECK_EQ(sum, kItems * (kItems + 1) / 2);
+    CHECK(queue.maxDepth() <= queue.capacity());
+}
+
+TEST(sharedDoorbellWaitsOnSeveralQueues) {
+    Doorbell bell;
+    SpscQueue<int> video(4, &bell);
+    SpscQueue<int> audio(4, &bell);
+    std::thread producer([&]() {
+        audio.push(7);
+        video.push(3);
+    });
+
+    int total = 0;
+    int received = 0;
+    while (received < 2) {
+        bell.wait([&]() { return !video.empty() || !audio.empty(); });
+        int value = 0;
+        while (video.tryPop(value) || audio.tryPop(value)) {
+            total += value;
+            ++received;
+        }
+    }
+    producer.join();
+    CHECK_EQ(total, 10);
+}
+
+STREAMVIO_TEST_MAIN()
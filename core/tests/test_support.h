@@ -0,0 +1,101 @@
+// StreamVio/core/tests/test_support.h
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Mínimo necesario para las pruebas unitarias sin dependencias externas.
+// Cada archivo de pruebas es un ejecutable que registra sus casos con
+// TEST(nombre) y termina con STREAMVIO_TEST_MAIN(). Un CHECK que falla
+// aborta el caso en curso y el proceso sale con código 1 al final.
+
+namespace StreamVio {
+namespace Test {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+struct CheckFailed {
+    std::string message;
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { registry().push_back({name, run}); }
+};
+
+[[noreturn]] inline void fail(const char* file, int line, const std::string& what) {
+    std::ostringstream message;
+    message << file << ":" << line << ": " << what;
+    throw CheckFailed{message.str()};
+}
+
+inline int runAll() {
+    int failures = 0;
+    for (const TestCase& test : registry()) {
+        try {
+            test.run();
+            std::cout << "[ OK ] " << test.name << std::endl;
+        } catch (const CheckFailed& failure) {
+            std::cout << "[FAIL] " << test.name << ": " << failure.message << std::endl;
+            failures++;
+        } catch (const std::exception& e) {
+            std::cout << "[FAIL] " << test.name << ": excepción inesperada: " << e.what() << std::endl;
+            failures++;
+        }
+    }
+    std::cout << registry().size() - failures << "/" << registry().size() << " pruebas correctas" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace Test
+} // namespace StreamVio
+
+#define TEST(name)                                                             \
+    static void name();                                                        \
+    static ::StreamVio::Test::Registrar name##Registrar(#name, &name);          \
+    static void name()
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        if (!(condition)) {                                                    \
+            ::StreamVio::Test::fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                             \
+    do {                                                                       \
+        const auto& checkActual = (actual);                                    \
+        const auto& checkExpected = (expected);                                \
+        if (!(checkActual == checkExpected)) {                                 \
+            std::ostringstream checkMessage;                                   \
+            checkMessage << #actual " == " #expected " (" << checkActual       \
+                         << " != " << checkExpected << ")";                    \
+            ::StreamVio::Test::fail(__FILE__, __LINE__, checkMessage.str());   \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_THROWS(statement)                                                \
+    do {                                                                       \
+        bool checkThrew = false;                                               \
+        try {                                                                  \
+            statement;                                                         \
+        } catch (const std::exception&) {                                      \
+            checkThrew = true;                                                 \
+        }                                                                      \
+        if (!checkThrew) {                                                     \
+            ::StreamVio::Test::fail(__FILE__, __LINE__, "no lanzó: " #statement); \
+        }                                                                      \
+    } while (0)
+
+#define STREAMVIO_TEST_MAIN()                                                  \
+    int main() { return ::StreamVio::Test::runAll(); }